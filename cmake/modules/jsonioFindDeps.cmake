@@ -20,3 +20,11 @@ if(USE_SPDLOG_PRECOMPILED)
        find_package(fmt CONFIG REQUIRED)
    endif()
 endif()
+
+# Optional libraries to read and write compressed files
+find_package(ZLIB)
+find_path(ZSTD_INCLUDE_DIR zstd.h)
+find_library(ZSTD_LIBRARY NAMES zstd zstd_static)
+if(ZSTD_INCLUDE_DIR AND ZSTD_LIBRARY)
+    set(ZSTD_FOUND TRUE)
+endif()
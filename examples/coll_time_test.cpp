@@ -9,6 +9,7 @@
 #include "jsonio/dbvertexdoc.h"
 #include "jsonio/dbquerybase.h"
 #include "jsonio/io_settings.h"
+#include "jsonio/dbdrivermemory.h"
 using namespace jsonio;
 
 
@@ -47,6 +48,7 @@ void printTimeSec( const std::string&  title, const time_point_t& start, const t
 int different_query_types( DataBase& connect );
 int substances_query_types( DataBase& connect );
 int substances_vertex( DataBase& connect );
+int memory_edges_queries( DataBase& connect );
 
 
 int main(int argc, char* argv[])
@@ -56,11 +58,21 @@ int main(int argc, char* argv[])
     if( argc > 1)
         documentsInCollection = std::stoi(argv[1]);
 
-    if( argc > 2)
+    // "memory" - test document layer overheads with in-memory driver ( without network and server )
+    bool use_memory = ( argc > 2 && std::string(argv[2]) == "memory" );
+    if( argc > 2 && !use_memory )
         JsonioSettings::settingsFileName = argv[2];
 
     try{
 
+        if( use_memory )
+        {
+            DataBase db( std::make_shared<MemoryDBClient>() );
+            different_query_types( db );
+            memory_edges_queries( db );
+            return 0;
+        }
+
         // Connect to Arangodb ( load settings from "jsonio-config.json" config file )
         DataBase db;
 
@@ -342,3 +354,56 @@ Elapsed time in seconds: 224ms
 
 
 */
+
+// Test edges queries ( the chain of vertexes )
+int memory_edges_queries( DataBase& connect )
+{
+    std::vector<std::string> recjsonValues;
+    SetReaded_f setfnc = [&recjsonValues]( const std::string& jsondata )
+    {
+        recjsonValues.push_back(jsondata);
+    };
+
+    auto start = std::chrono::high_resolution_clock::now();
+
+    auto vertexes = connect.collection( "vertexes", "vertex" );
+    auto edges = connect.collection( "edges", "edge" );
+    std::vector<std::string> vertexKeys;
+    for( int ii=0; ii<documentsInCollection; ii++ )
+    {
+        auto jsFree = JsonFree::object();
+        jsFree["_label"] = "element";
+        jsFree["index"] = ii;
+        vertexKeys.push_back( vertexes->createDocument( jsFree ) );
+    }
+    for( int ii=1; ii<documentsInCollection; ii++ )
+    {
+        auto jsFree = JsonFree::object();
+        jsFree["_label"] = "link";
+        jsFree["_from"] = vertexKeys[ii-1];
+        jsFree["_to"] = vertexKeys[ii];
+        edges->createDocument( jsFree );
+    }
+    auto end1 = std::chrono::high_resolution_clock::now();
+    printTime( "Insert vertexes and edges", start, end1 );
+
+    // Select edges of each vertex
+    recjsonValues.clear();
+    for( const auto& key: vertexKeys )
+    {
+        DBQueryBase edgesquery( "{ \"startVertex\": \"" + key + "\", \"edgeCollections\": \"edges\" }",
+                                DBQueryBase::qEdgesAll );
+        edges->selectQuery( edgesquery, setfnc );
+    }
+    auto end2 = std::chrono::high_resolution_clock::now();
+    printTime( "Select all edges of vertexes ( " + std::to_string(recjsonValues.size()) + " )", end1, end2 );
+
+    // Delete edges of each vertex
+    for( const auto& key: vertexKeys )
+        connect.theDriver()->delete_edges( "edges", key );
+    auto end3 = std::chrono::high_resolution_clock::now();
+    printTime( "Delete edges of vertexes", end2, end3 );
+
+    printTime( "All time", start, end3 );
+    return 0;
+}
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include "jsonio/jsonfree.h"
+
+namespace jsonio {
+
+/// Counters of the documents cache usage.
+struct DocumentsCacheStatistics
+{
+    /// Maximum number of cached documents
+    std::size_t max_size = 0;
+    /// Current number of cached documents
+    std::size_t size = 0;
+    /// Number of documents found into cache
+    std::size_t hits = 0;
+    /// Number of documents not found into cache
+    std::size_t misses = 0;
+    /// Number of documents removed to free space
+    std::size_t evictions = 0;
+    /// Number of documents removed after update or delete
+    std::size_t invalidations = 0;
+    /// Number of cached documents with outdated _rev
+    std::size_t outdated = 0;
+};
+
+/// \class DocumentsCache thread-safe LRU cache of parsed documents keyed by _id.
+/// The least recently used document is removed when the cache is full.
+class DocumentsCache
+{
+
+public:
+
+    /// Constructor
+    /// \param max_size - maximum number of cached documents
+    explicit DocumentsCache( std::size_t max_size ):
+        max_size_(max_size)
+    {}
+
+    /// Maximum number of cached documents
+    std::size_t max_size() const
+    {
+        return max_size_;
+    }
+
+    /// Current number of cached documents
+    std::size_t size() const;
+
+    /// Get the copy of cached document and mark it as recently used.
+    /// \return false if no document with key into cache
+    bool get( const std::string& key, JsonFree& document );
+
+    /// Get the _rev of cached document.
+    /// \return empty string if no document with key into cache
+    std::string revision( const std::string& key ) const;
+
+    /// Add or replace document into cache
+    void put( const std::string& key, const JsonBase& document );
+
+    /// Add document read from the server, if no documents were invalidated after the reading started.
+    /// \param read_generation - generation() taken before the document was read
+    /// \return false if the document could be outdated and was not added
+    bool put( const std::string& key, const JsonBase& document, std::uint64_t read_generation );
+
+    /// Number of invalidations done ( changes before the document read is finished )
+    std::uint64_t generation() const;
+
+    /// Remove document from cache ( after update or delete )
+    void invalidate( const std::string& key );
+
+    /// Remove outdated document from cache
+    void outdated( const std::string& key );
+
+    /// Remove all documents
+    void clear();
+
+    /// Get usage counters
+    DocumentsCacheStatistics statistics() const;
+
+protected:
+
+    struct CacheEntry
+    {
+        std::string key;
+        std::string revision;
+        JsonFree document;
+    };
+
+    /// Maximum number of cached documents
+    std::size_t max_size_;
+
+    /// Documents list, recently used first
+    std::list<CacheEntry> lru_list;
+    /// Index _id -> documents list position
+    std::unordered_map<std::string, std::list<CacheEntry>::iterator> lru_index;
+
+    /// Usage counters
+    DocumentsCacheStatistics counters;
+    /// Incremented by each invalidation
+    std::uint64_t invalidations_generation = 0;
+
+    mutable std::mutex cache_mutex;
+
+    /// Remove document from cache (cache_mutex must be locked)
+    bool erase( const std::string& key );
+    /// Add or replace entry (cache_mutex must be locked)
+    void insert( CacheEntry&& entry );
+    /// Make entry from document
+    static CacheEntry make_entry( const std::string& key, const JsonBase& document );
+};
+
+} // namespace jsonio
@@ -1,6 +1,12 @@
 #pragma once
 
+#include <atomic>
+#include <condition_variable>
+#include <future>
 #include "jsonio/dbconnect.h"
+#include "jsonio/dbcache.h"
+#include "jsonio/dbkeysindex.h"
+#include "jsonio/dbcursor.h"
 
 namespace jsonio {
 
@@ -31,7 +37,7 @@ public:
     ///  Destructor
     virtual ~DBCollection()
     {
-        // wait loading finish
+        // stop loading
         close();
     }
 
@@ -39,9 +45,32 @@ public:
     void load();
     /// Close the collection and free internal data
     void close();
-    /// Refresh list of documents keys
+    /// Refresh list of documents keys and rerun queries of all linked documents.
+    /// Changes done through the collection are applied to the documents incrementally,
+    /// so the reload is only needed when the database driver is replaced.
     void reload();
 
+    /// Number of documents keys loaded in one locked step
+    static std::size_t load_batch_size;
+
+    /// Test the documents keys are loading now
+    bool isLoading() const
+    {
+        return loader_running;
+    }
+
+    /// Number of documents keys loaded by the current ( or last ) loading
+    std::size_t loadedCount() const
+    {
+        return loaded_keys;
+    }
+
+    /// Wait until loading documents keys is finished ( operations with documents wait for it )
+    void waitLoaded() const;
+
+    /// Stop loading documents keys ( the keys already loaded are kept )
+    void cancelLoading();
+
     //--- Selectors
 
     /// Get the unique name of collection
@@ -63,6 +92,26 @@ public:
         return key_record_map.size();
     }
 
+    /// Enable or disable the LRU cache of read documents.
+    /// Cached documents are removed by updateDocument and deleteDocument of this collection.
+    /// \param max_size - maximum number of cached documents ( 0 - disable cache )
+    /// \param validate_revision - compare the _rev of cached document with the server before use
+    void setDocumentsCache( std::size_t max_size, bool validate_revision = false );
+
+    /// Get the documents cache usage counters
+    DocumentsCacheStatistics cacheStatistics() const;
+
+    /// Function to receive changes of documents done through the collection
+    /// ( key of document and new data, nullptr if the document was deleted )
+    using DocumentChanged_f = std::function<void( const std::string& key, const JsonBase* data_object )>;
+
+    /// Register the function receiving changes of documents
+    /// \return id of the listener to remove it
+    std::size_t addChangesListener( DocumentChanged_f listener );
+
+    /// Remove the function receiving changes of documents
+    void removeChangesListener( std::size_t listener_id );
+
     //--- Manipulation records
 
     /// Build list of key fields for query
@@ -105,6 +154,33 @@ public:
     /// \param key      - key of document
     bool deleteDocument( const std::string& key );
 
+    //--- Asynchronous manipulation records
+    //    The requests are executed by the bounded executor of the DataBase,
+    //    the data object is shared with the request until it is finished.
+
+    /// Asynchronous createDocument
+    /// \param data_object - object with data ( _id is set when the request is finished )
+    /// \return future with the new key of document
+    std::future<std::string> createDocumentAsync( std::shared_ptr<JsonBase> data_object );
+
+    /// Asynchronous readDocument
+    ///  \param data_object - object to receive data
+    ///  \param key      - key of document
+    std::future<bool> readDocumentAsync( std::shared_ptr<JsonBase> data_object, const std::string& key );
+
+    /// Asynchronous updateDocument
+    ///  \param data_object - object with data
+    std::future<std::string> updateDocumentAsync( std::shared_ptr<const JsonBase> data_object );
+
+    /// Asynchronous saveDocument
+    ///  \param data_object - object with data
+    ///  \param key      - key of document
+    std::future<std::string> saveDocumentAsync( std::shared_ptr<JsonBase> data_object, const std::string& key );
+
+    /// Asynchronous deleteDocument
+    /// \param key      - key of document
+    std::future<bool> deleteDocumentAsync( const std::string& key );
+
     //--- Manipulation list of records (tables)
 
     /// Fetches all documents from a collection that match the specified condition.
@@ -115,6 +191,18 @@ public:
         db_driver()->select_query( name(), query, setfnc );
     }
 
+    /// Open the cursor to read documents from a collection that match the specified condition.
+    ///  \param query -    selection condition
+    ///  \param batch_size - number of documents read in one batch
+    ///  \param max_batches - number of batches buffered before the query waits for the consumer
+    std::unique_ptr<DBQueryCursor> selectQueryCursor( const DBQueryBase& query, std::size_t batch_size,
+                                                      std::size_t max_batches = 2 )
+    {
+        return std::make_unique<DBQueryCursor>( [this, query]( SetReaded_f setfnc ) {
+            db_driver()->cursor_query( name(), query, setfnc );
+        }, batch_size, max_batches );
+    }
+
     /// Looks up the documents in the specified collection using the array of keys provided.
     ///  \param rkeys -      array of keys
     ///  \param setfnc -   callback function fetching document data
@@ -142,11 +230,7 @@ public:
 
     /// Delete all edges linked to vertex record.
     ///  \param vertexid - vertex record id
-    void deleteEdges( const std::string& vertexid )
-    {
-        db_driver()->delete_edges( name(), vertexid );
-        reload();
-    }
+    void deleteEdges( const std::string& vertexid );
 
     /// Removes all documents from the collection whose keys are contained in the keys array.
     ///  \param collname - collection name
@@ -155,7 +239,7 @@ public:
     {
         auto ids = ids_from_keys(  rkeys );
         db_driver()->remove_by_ids( name(), ids );
-        reload();
+        remove_keys( rkeys );
     }
 
     ///  Provides 'distinct' operation over collection
@@ -180,19 +264,46 @@ protected:
 
     /// Documents are linked to collection
     std::set<DBDocumentBase*> documents_list;
+    /// Functions receiving changes of documents ( guarded by documents_mutex )
+    std::map<std::size_t, DocumentChanged_f> changes_listeners;
+    std::size_t last_listener_id = 0;
 
     /// List all documents keys into collection (internal loaded data)
     keysmap_t key_record_map;
+    /// Sorted index of ids from key_record_map ( guarded by keysmap_mutex )
+    KeysIndex ids_index;
 
     mutable std::shared_mutex keysmap_mutex;
     mutable std::shared_mutex documents_mutex;
 
+    /// Thread loading documents keys
+    std::thread loader_thread;
+    /// Request to stop loading documents keys
+    std::atomic<bool> loader_cancel = false;
+    /// Loading documents keys is in progress
+    std::atomic<bool> loader_running = false;
+    /// Number of loaded documents keys
+    std::atomic<std::size_t> loaded_keys = 0;
+    mutable std::mutex loader_mutex;
+    mutable std::condition_variable loader_finished;
+
+    /// LRU cache of read documents ( guarded by keysmap_mutex )
+    std::unique_ptr<DocumentsCache> documents_cache;
+    /// Validate cached documents by _rev
+    bool validate_cache_revision = false;
+
     /// Access to a specific database vendor implementation
     AbstractDBDriver* db_driver() const
     {
         return db_connect.theDriver();
     }
 
+    /// Executor of asynchronous requests
+    ThreadPool& executor() const
+    {
+        return db_connect.executor();
+    }
+
     /// Load all keys from one collection
     virtual void loadCollectionFile( const std::set<std::string>& query_fields );
     /// Close collection file
@@ -202,9 +313,15 @@ protected:
     void clear_keysmap()
     {
         std::lock_guard<std::shared_mutex> g(keysmap_mutex);
+        ids_index.clear();
         key_record_map.clear();
+        if( documents_cache )
+            documents_cache->clear();
     }
 
+    /// Read the current _rev of document from the server
+    std::string server_revision( const std::string& id ) const;
+
     /// Close collection
     void closeCollection()
     {
@@ -215,11 +332,26 @@ protected:
     /// Load collection
     void loadCollection();
 
+    /// Cancel loading documents keys and join the loader thread
+    void stop_loading();
+
     /// Generate new unique _key from key template
     std::string key_from_template( const std::string& key_template ) const;
 
-    /// Add key from json structure to key_record_map
-    void add_record_to_map( const std::string& jsondata, const std::string& keydata );
+    /// Add key to key_record_map and ids index (keysmap_mutex must be locked)
+    bool insert_key( const std::string& key, std::string&& second );
+
+    /// Remove key from key_record_map and ids index (keysmap_mutex must be locked)
+    void erase_key( const std::string& key );
+
+    /// Remove keys of deleted documents and delete lines from linked documents
+    void remove_keys( const std::vector<std::string>& rkeys );
+
+    /// Extract documents key from json data returned by keys query
+    std::string key_from_json( const std::string& jsondata );
+
+    /// Add loaded keys to key_record_map
+    void add_records_to_map( std::vector<std::pair<std::string, std::string>>& keys_batch );
 
     /// Convert record keys to ids
     std::vector<std::string> ids_from_keys( const std::vector<std::string>& rkeys ) const;
@@ -4,6 +4,7 @@
 #include <thread>
 #include <shared_mutex>
 #include "jsonio/dbdriverbase.h"
+#include "jsonio/thread_pool.h"
 #include "jsonio/schema.h"
 
 // https://en.cppreference.com/w/cpp/thread/shared_mutex
@@ -115,6 +116,13 @@ public:
 
     static void update_from_schema( const schemas_t& schema_data );
 
+    /// Default number of threads executing asynchronous requests ( "jsonio.AsyncThreads" into settings )
+    static std::size_t default_async_threads;
+    /// Default limit of waiting asynchronous requests ( "jsonio.AsyncQueueSize" into settings )
+    static std::size_t default_async_queue_size;
+    /// Default size of the documents cache of collections ( "jsonio.DocumentsCacheSize" into settings, 0 - disabled )
+    static std::size_t default_documents_cache_size;
+
     /// Constructor use define database vendor.
     DataBase(const std::string &db_url, const std::string &db_user,
              const std::string &user_passwd, const std::string &db_name);
@@ -122,7 +130,7 @@ public:
     /// Constructor use specific database vendor.
     DataBase(std::shared_ptr<AbstractDBDriver> db_driver):
         current_driver(nullptr), collections_list(),
-        driver_mutex(), collections_mutex()
+        driver_mutex(), collections_mutex(), async_executor(nullptr), executor_mutex()
     {
         updateDriver( db_driver );
     }
@@ -168,6 +176,9 @@ public:
         return add_collection( colname, type );
     }
 
+    /// Bounded executor for asynchronous requests ( created at first use ).
+    ThreadPool& executor() const;
+
 protected:
 
     /// Current Database Driver
@@ -179,6 +190,11 @@ protected:
     mutable std::shared_mutex driver_mutex;
     mutable std::shared_mutex collections_mutex;
 
+    /// Executor of asynchronous requests to collections
+    /// (declared last to finish the requests before collections are released)
+    mutable std::unique_ptr<ThreadPool> async_executor;
+    mutable std::mutex executor_mutex;
+
     /// Load the collection with the given colname or create new if no such collection exists.
     /// \param type - type of collection ( "undef", "schema", "vertex", "edge" )
     /// \param colname - name of collection
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include "jsonio/dbdriverbase.h"
+#include "jsonio/dbquerybase.h"
+
+namespace jsonio {
+
+/// \class DBQueryCursor pull-style reader of query results.
+/// The query is executed by a separate thread that fills a bounded buffer of documents.
+/// When the buffer is full the query thread waits until the consumer takes the next batch,
+/// so huge result sets are processed in bounded memory at the rate the consumer controls.
+class DBQueryCursor
+{
+
+public:
+
+    /// Function executing the query, it sends each document to the callback
+    using producer_t = std::function<void( SetReaded_f )>;
+
+    /// Constructor, starts the query
+    /// \param producer - function executing the query
+    /// \param batch_size - maximum number of documents returned by nextBatch()
+    /// \param max_batches - maximum number of batches buffered before the query waits
+    DBQueryCursor( producer_t producer, std::size_t batch_size, std::size_t max_batches = 2 );
+
+    /// Destructor, stops the query
+    ~DBQueryCursor();
+
+    DBQueryCursor( const DBQueryCursor& ) = delete;
+    DBQueryCursor& operator=( const DBQueryCursor& ) = delete;
+
+    /// Maximum number of documents returned by nextBatch()
+    std::size_t batchSize() const
+    {
+        return batch_size;
+    }
+
+    /// Get the next document.
+    /// Rethrows the exception of the query after all buffered documents are read.
+    /// \return false if no more documents
+    bool next( std::string& jsondata );
+
+    /// Get up to batchSize() next documents.
+    /// \return empty list if no more documents
+    values_t nextBatch();
+
+    /// Test all documents are read
+    bool atEnd();
+
+    /// Number of documents already read by the consumer
+    std::size_t fetched() const
+    {
+        return fetched_count;
+    }
+
+    /// Stop the query, the buffered documents are dropped
+    void cancel();
+
+protected:
+
+    std::size_t batch_size;
+    std::size_t max_buffered;
+
+    std::deque<std::string> buffer;
+    std::size_t fetched_count = 0;
+    bool finished = false;
+    bool cancelled = false;
+    std::exception_ptr query_error;
+
+    std::mutex buffer_mutex;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+
+    std::thread query_thread;
+
+    /// Wait for documents into buffer or the query end (buffer_mutex must be locked)
+    bool wait_data( std::unique_lock<std::mutex>& lock );
+};
+
+} // namespace jsonio
@@ -1,9 +1,12 @@
 #pragma once
 
+#include <deque>
+#include <thread>
 #include <memory>
 #include "jsonio/exceptions.h"
 #include "jsonio/dbcollection.h"
 #include "jsonio/dbquerybase.h"
+#include "jsonio/jsonparser.h"
 
 
 namespace jsonio {
@@ -28,7 +31,8 @@ class DBDocumentBase
     /// Do it before write document to database
     virtual void before_save_update( std::string&  ) {}
     /// Do it after write document to database
-    virtual void after_save_update( const std::string&  ) {}
+    /// \param saved_data - the written data ( the current data or its copy saved by asynchronous request )
+    virtual void after_save_update( const std::string&, const JsonBase&  ) {}
 
 public:
 
@@ -37,9 +41,14 @@ public:
     ///  Constructor used loaded collection
     DBDocumentBase( DBCollection* collection  );
 
-    ///  Destructor
+    ///  Destructor.
+    ///  The asynchronous requests and the query refresh use virtual functions of the document, so the destructor
+    ///  of the most derived document must call waitAsyncRequests() and stop_query_refresh();
+    ///  the calls here only keep the members alive for documents which do not do it.
     virtual ~DBDocumentBase()
     {
+        waitAsyncRequests();
+        stop_query_refresh();
         collection_from->eraseDocument(this);
         std::lock_guard<std::shared_mutex> g(query_result_mutex);
     }
@@ -134,7 +143,7 @@ public:
         setOid( rid ); // add key _id to structure
         before_save_update( rid );
         rid = collection_from->createDocument( this );
-        after_save_update( rid );
+        after_save_update( rid, current_data() );
         return rid;
     }
 
@@ -155,7 +164,7 @@ public:
         setOid( rid ); // add key _id to structure
         before_save_update( rid );
         rid = collection_from->saveDocument( this, rid );
-        after_save_update( rid );
+        after_save_update( rid, current_data() );
         return rid;
     }
 
@@ -177,6 +186,37 @@ public:
         after_remove( key );
     }
 
+    //--- Asynchronous manipulation documents
+    //    The key is generated and the current data is copied when the request is submitted,
+    //    so the current data could be changed at once for the next request.
+    //    The requests of one document are executed by the DataBase executor in the order they were submitted,
+    //    requests of different documents and collections are executed in parallel.
+
+    /// Asynchronous createDocument
+    /// \param key      - key of document
+    /// \return future with the new key of document
+    std::future<std::string> createDocumentAsync( const std::string& key = "" );
+
+    /// Asynchronous readDocument, the current data is not changed
+    ///  \param key      - key of document
+    /// \return future with the json string of document ( to load by recFromJson )
+    std::future<std::string> readDocumentAsync( const std::string& key );
+
+    /// Asynchronous updateDocument
+    ///  \param key      - key of document
+    std::future<std::string> updateDocumentAsync( const std::string& key );
+
+    /// Asynchronous deleteDocument
+    /// \param key      - key of document
+    std::future<void> deleteDocumentAsync( const std::string& key );
+
+    /// Wait until all asynchronous requests of the document are finished.
+    void waitAsyncRequests()
+    {
+        std::unique_lock<std::mutex> g(async_mutex);
+        async_idle.wait( g, [this]{ return !async_running; } );
+    }
+
     // The document-handle API
 
     /// Generate new document-handle (_id) or other pointer of location
@@ -244,6 +284,16 @@ public:
     ///  \return list of json strings with query result
     values_t selectQuery( const DBQueryBase& query ) const;
 
+    /// Open the cursor to read documents that match the specified condition by batches.
+    ///  \param query -    selection condition
+    ///  \param batch_size - number of documents read in one batch
+    ///  \param max_batches - number of batches buffered before the query waits for the consumer
+    std::unique_ptr<DBQueryCursor> selectQueryCursor( const DBQueryBase& query, std::size_t batch_size,
+                                                      std::size_t max_batches = 2 ) const
+    {
+        return collection_from->selectQueryCursor( query, batch_size, max_batches );
+    }
+
     /// Looks up the documents in the specified collection using the array of keys provided.
     ///  \param rkeys -      array of keys
     ///  \param setfnc -   callback function fetching document data
@@ -340,7 +390,9 @@ public:
     /// Set&execute query for document
     virtual void setQuery( const DBQueryDef& querydef );
 
-    /// Run current query, rebuild internal table of values
+    /// Run current query, rebuild internal table of values.
+    /// The query is executed by the refresh thread of the document, the calls while
+    /// the query is running are coalesced into one more execution.
     void updateQuery();
 
     const DBQueryResult& currentQueryResult() const
@@ -352,6 +404,17 @@ public:
         return *query_result;
     }
 
+    /// Build hash indexes of the query result table for fields
+    /// to select lines by values of the fields without full scan.
+    void setQueryIndexes( const std::set<std::string>& fieldnames )
+    {
+        std::lock_guard<std::shared_mutex> g(query_result_mutex);
+
+        JSONIO_THROW_IF( query_result.get() == nullptr, "DBDocument", 11,
+                         "'setQueryIndexes' could be execute only into selection mode." );
+        query_result->setIndexedFields( fieldnames );
+    }
+
     /// Identify key from current data.
     /// The current data is compared with the internally loaded values,
     /// and if all values are the same, the selected key is returned,
@@ -375,36 +438,113 @@ protected:
 
     mutable std::shared_mutex query_result_mutex;
 
+    /// Asynchronous requests waiting for the running request of the document
+    std::deque<std::function<void()>> async_queue;
+    /// The queue of requests is executed by a worker of the executor
+    bool async_running = false;
+    std::mutex async_mutex;
+    std::condition_variable async_idle;
+
+    /// Thread executing the query again when the result table is stale
+    std::thread refresh_thread;
+    /// The result table is stale, the refresh thread must execute the query again
+    bool refresh_pending = false;
+    bool refresh_running = false;
+    /// The document is being destroyed, no new refresh
+    bool refresh_stopped = false;
+    std::mutex refresh_mutex;
+
+    /// Add request to the queue of the document.
+    /// The first request starts a task of the executor, which runs the queued requests one by one,
+    /// so waiting requests do not occupy workers.
+    template <class F>
+    auto submit_in_order( F&& func ) -> std::future<std::invoke_result_t<std::decay_t<F>>>
+    {
+        using result_t = std::invoke_result_t<std::decay_t<F>>;
+        auto task = std::make_shared<std::packaged_task<result_t()>>( std::forward<F>(func) );
+        auto result = task->get_future();
+        {
+            std::lock_guard<std::mutex> g(async_mutex);
+            async_queue.emplace_back( [task]() { (*task)(); } );
+            if( async_running )
+                return result;
+            async_running = true;
+        }
+        try {
+            collection_from->executor().submit( [this]() { run_async_queue(); } );
+        }
+        catch(...)
+        {
+            {
+                std::lock_guard<std::mutex> g(async_mutex);
+                async_queue.clear();
+                async_running = false;
+            }
+            async_idle.notify_all();
+            throw;
+        }
+        return result;
+    }
+
+    /// Execute the queued asynchronous requests ( into worker of executor )
+    void run_async_queue();
+
+    /// Execute the query while the result table is stale ( into refresh thread )
+    void run_query_refresh();
+
+    /// Disable new refreshes of the query and join the refresh thread
+    void stop_query_refresh();
+
+    /// Copy of the current data for asynchronous request
+    std::shared_ptr<JsonFree> current_data_copy() const;
+
     /// Prepare data to save to database
     virtual JsonBase& current_data() const = 0;
 
     /// Run current query, rebuild internal table of values
     virtual void update_query() = 0;
 
-    /// Add line to view table
-    void add_line( const std::string& key_str, const JsonBase& nodedata, bool isupdate )
+    /// Add line to view table if the document matches the query
+    /// ( execute the query again if the condition could not be tested for the document )
+    virtual void add_line( const std::string& key_str, const JsonBase& nodedata, bool isupdate )
     {
-        std::lock_guard<std::shared_mutex> g(query_result_mutex);
-        if( query_result.get() != nullptr )
-            query_result->add_line( key_str, nodedata, isupdate );
+        {
+            std::lock_guard<std::shared_mutex> g(query_result_mutex);
+            if( query_result.get() == nullptr || query_result->add_line( key_str, nodedata, isupdate ) )
+                return;
+        }
+        updateQuery();
     }
 
-    /// Update line into view table
-    void update_line( const std::string& key_str, const JsonBase& nodedata )
+    /// Update, add or delete line into view table by the query condition
+    /// ( execute the query again if the condition could not be tested for the document )
+    virtual void update_line( const std::string& key_str, const JsonBase& nodedata )
     {
-        std::lock_guard<std::shared_mutex> g(query_result_mutex);
-        if( query_result.get() != nullptr )
-            query_result->update_line( key_str, nodedata );
+        {
+            std::lock_guard<std::shared_mutex> g(query_result_mutex);
+            if( query_result.get() == nullptr || query_result->update_line( key_str, nodedata ) )
+                return;
+        }
+        updateQuery();
     }
 
     /// Delete line from view table
-    void delete_line( const std::string& key_str )
+    virtual void delete_line( const std::string& key_str )
     {
         std::lock_guard<std::shared_mutex> g(query_result_mutex);
         if( query_result.get() != nullptr )
             query_result->delete_line( key_str );
     }
 
+    /// Delete lines of removed documents from view table
+    virtual void delete_lines( const std::vector<std::string>& keys )
+    {
+        std::lock_guard<std::shared_mutex> g(query_result_mutex);
+        if( query_result.get() != nullptr )
+            for( const auto& key: keys )
+                query_result->delete_line( key );
+    }
+
     /// Build default query for collection ( by default all documents )
     virtual DBQueryBase make_default_query_template() const
     {
@@ -418,6 +558,17 @@ protected:
     }
 
 
+    /// Build projection to decode the fields and the key fields of collection from json string
+    JsonProjection make_line_projection( const std::vector<std::string>& fields ) const;
+
+    /// Decode values of fields and the key from json string without the full parse.
+    /// \param projection - projection of fields followed by the key fields ( make_line_projection )
+    /// \param fields_count - number of fields before the key fields
+    /// \param missing_value - value of the fields not into json data ( nullptr if the full parse is needed )
+    /// \return false if the full parse of json string is needed
+    bool project_line( const JsonProjection& projection, const std::string& jsondata, std::size_t fields_count,
+                       const std::string* missing_value, std::string& key, values_t& values ) const;
+
     virtual field_value_map_t extract_fields( const std::vector<std::string> queryFields, const JsonBase& domobj ) const;
     virtual field_value_map_t extract_fields( const std::vector<std::string> queryFields, const std::string& jsondata ) const;
 
@@ -2,6 +2,7 @@
 
 #include "jsonio/dbdriverbase.h"
 #include "jsonio/io_settings.h"
+#include "jsonio/shared_pool.h"
 
 namespace arangocpp {
 enum class CollectionTypes;
@@ -24,6 +25,11 @@ class ArangoDBClient: public AbstractDBDriver
 
 public:
 
+    /// Default number of connections into the pool and into the cursors pool ( "arangodb.DBPoolSize" into settings )
+    static std::size_t default_pool_size;
+    /// Maximum time a cursor query waits for a free connection of the cursors pool
+    static std::chrono::milliseconds cursor_connection_timeout;
+
     ///  Constructor
     ArangoDBClient();
 
@@ -51,6 +57,11 @@ public:
     /// Return ArangoDB server status.
     bool connected() const override;
 
+    /// Usage and wait-time counters of the connections pool.
+    SharedPoolStatistics pool_statistics() const;
+
+    /// Usage and wait-time counters of the cursors connections pool.
+    SharedPoolStatistics cursor_pool_statistics() const;
 
     // Collections API
 
@@ -104,6 +115,17 @@ public:
     ///  \param setfnc -   callback function fetching document data
     void select_query( const std::string& collname, const DBQueryBase& query, SetReaded_f setfnc ) override;
 
+    /// Fetches all documents from a collection that match the specified condition into the cursor.
+    /// The query holds a connection of the separate cursors pool while the cursor is open,
+    /// so slow cursors do not block the other requests.
+    /// No more than DBPoolSize cursors could be open at once: a thread reading more cursors in turn
+    /// would wait for itself, so the query fails if no connection is free during cursor_connection_timeout.
+    /// The server cursor could also expire ( by its ttl ) while a slow consumer does not read it.
+    ///  \param collname - collection name
+    ///  \param query -    selection condition
+    ///  \param setfnc -   callback function fetching document data
+    void cursor_query( const std::string& collname, const DBQueryBase& query, SetReaded_f setfnc ) override;
+
     /// Looks up the documents in the specified collection using the array of ids provided.
     ///  \param collname - collection name
     ///  \param ids -      array of _ids
@@ -142,12 +164,20 @@ protected:
     /// ArangoDB connection data
     std::shared_ptr<arangocpp::ArangoDBConnection> arando_connect = nullptr;
 
-    /// ArangoDB connection data
-    std::shared_ptr<arangocpp::ArangoDBCollectionAPI> arando_db = nullptr;
+    /// Pool of ArangoDB connections shared by collections, loader and query threads
+    std::shared_ptr<SharedPool<arangocpp::ArangoDBCollectionAPI>> arando_pool = nullptr;
+
+    /// Pool of ArangoDB connections used by the cursors queries only.
+    /// A cursor query holds the connection until the consumer reads all documents,
+    /// so open cursors wait only for each other, never for the requests of their consumers.
+    std::shared_ptr<SharedPool<arangocpp::ArangoDBCollectionAPI>> arando_cursor_pool = nullptr;
 
     /// Reset connections to ArangoDB server
     void reset_db_connection(const arangocpp::ArangoDBConnection& connect_data);
 
+    /// Get free connection from the pool ( wait if all connections are in use )
+    SharedPool<arangocpp::ArangoDBCollectionAPI>::ptr_type arando_db() const;
+
     bool is_comlex_fields( const std::set<std::string>& query_fields);
 
     arangocpp::CollectionTypes to_arrango_types(CollTypes ctype) const;
@@ -101,6 +101,18 @@ public:
     ///  \param setfnc -   callback function fetching document data
     virtual void select_query( const std::string& collname, const DBQueryBase& query, SetReaded_f setfnc ) = 0;
 
+    /// Fetches all documents from a collection that match the specified condition into the cursor.
+    /// The callback waits while the cursor buffer is full, so the query can hold its resources
+    /// as long as the consumer reads; the driver must not take them from the requests of the consumer
+    /// and should fail instead of waiting without limit for resources held by other open cursors.
+    ///  \param collname - collection name
+    ///  \param query -    selection condition
+    ///  \param setfnc -   callback function fetching document data
+    virtual void cursor_query( const std::string& collname, const DBQueryBase& query, SetReaded_f setfnc )
+    {
+        select_query( collname, query, setfnc );
+    }
+
     /// Looks up the documents in the specified collection using the array of ids provided.
     ///  \param collname - collection name
     ///  \param ids -      array of _ids
@@ -0,0 +1,289 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <shared_mutex>
+#include <string_view>
+#include <unordered_map>
+#include "jsonio/dbdriverlocal.h"
+
+namespace jsonio {
+
+class DBQueryMatcher;
+
+/// \class FileSegmentsStore documents of one collection stored into append-only segment files.
+/// Each put or delete of the document is appended as a record to the last segment file,
+/// segments are memory mapped to read documents without copying the file data.
+/// The primary index _id -> position of the actual document is rebuilt from the segments on open,
+/// a truncated record at the end of the last segment ( interrupted write ) is discarded.
+/// Segments are compacted when outdated records take more space than the actual ones.
+class FileSegmentsStore
+{
+
+public:
+
+    /// Maximum size of one segment file
+    static std::size_t segment_max_size;
+    /// Minimum size of outdated records to start compaction
+    static std::size_t compact_min_size;
+    /// Flush each record to disk ( fsync )
+    static bool sync_writes;
+
+    /// Open or create the collection files into directory
+    FileSegmentsStore( const std::string& directory, const std::string& collname );
+
+    /// Destructor, closes segment files
+    ~FileSegmentsStore();
+
+    FileSegmentsStore( const FileSegmentsStore& ) = delete;
+    FileSegmentsStore& operator=( const FileSegmentsStore& ) = delete;
+
+    /// Name of collection
+    const std::string& name() const
+    {
+        return collection_name;
+    }
+
+    /// Number of documents
+    std::size_t size() const;
+
+    /// Test the document exists
+    bool exists( const std::string& id ) const;
+
+    /// Get json string of the document
+    /// \return false if no document with id
+    bool get( const std::string& id, std::string& jsondata ) const;
+
+    /// Add the document
+    /// \return false if the document with id already exists
+    bool insert( const std::string& id, const std::string& jsondata );
+
+    /// Add or replace the document
+    void put( const std::string& id, const std::string& jsondata );
+
+    /// Remove the document
+    /// \return false if no document with id
+    bool remove( const std::string& id );
+
+    /// Remove documents
+    /// \return number of removed documents
+    std::size_t remove( const std::vector<std::string>& ids );
+
+    /// Get ids of all documents in order of the last change
+    std::vector<std::string> ids() const;
+
+    /// Read documents of ids list, the visitor gets the id and the raw json of each existing document.
+    /// The documents are locked for changes while reading.
+    void read( const std::vector<std::string>& ids,
+               const std::function<void( const std::string& id, std::string_view jsondata )>& visitor ) const;
+
+    /// Rewrite actual documents into new segments and remove old ones
+    void compact();
+
+    /// Flush written records to disk
+    void flush();
+
+protected:
+
+    /// Segment file
+    struct Segment
+    {
+        std::size_t number = 0;
+        std::string path = "";
+        int fd = -1;
+        /// Size of written records
+        std::size_t size = 0;
+        /// Mapped data ( could be greater than size to append records without remapping )
+        char* data = nullptr;
+        std::size_t capacity = 0;
+        /// Segment data if memory mapping not supported
+        std::string buffer = "";
+    };
+
+    /// Position of the document json into segments
+    struct Location
+    {
+        std::size_t segment = 0;
+        std::size_t offset = 0;
+        std::size_t size = 0;
+    };
+
+    std::string directory_path;
+    std::string collection_name;
+
+    std::vector<std::unique_ptr<Segment>> segments;
+    std::size_t last_segment_number = 0;
+    /// Primary index _id -> position of actual document
+    std::unordered_map<std::string, Location> primary_index;
+    /// Size of records of actual documents
+    std::size_t live_bytes = 0;
+    /// Size of records of replaced or deleted documents
+    std::size_t dead_bytes = 0;
+
+    mutable std::shared_mutex store_mutex;
+
+    /// Open existing segments and rebuild primary index
+    void open_segments();
+    /// Read records of segment into primary index
+    void scan_segment( std::size_t segment_ndx, bool is_last );
+    /// Append record to the last segment of list ( start new segment if full )
+    Location append_record( std::vector<std::unique_ptr<Segment>>& segments_list, char operation,
+                            const std::string& id, std::string_view jsondata );
+    /// Create new empty segment file
+    std::unique_ptr<Segment> new_segment( std::size_t number, std::size_t capacity );
+    /// Map the segment file data to memory
+    void map_segment( Segment& segment, std::size_t capacity );
+    /// Close and unmap segment file
+    void close_segment( Segment& segment );
+    /// Raw json of document at location
+    std::string_view document_data( const Location& location ) const;
+    /// Compact when outdated records take too much space ( store_mutex must be locked )
+    void compact_if_needed();
+    void compact_segments();
+};
+
+
+/// Implementation of Database Driver storing collections into local files.
+/// Each database is a directory with a collections list file and append-only segment files of collections.
+/// Queries are evaluated by DBQueryMatcher ( templates, edges and subset of AQL ).
+/// Used for tests, offline work and small deployments without ArangoDB server.
+class FileDBClient: public LocalDBDriver
+{
+
+public:
+
+    /// Default directory of local databases ( "jsonio.LocalDBDirectory" into settings )
+    static std::string default_directory;
+    /// Default name of local database ( "jsonio.LocalDBName" into settings )
+    static std::string default_database;
+
+    ///  Constructor, the database location is read from settings
+    FileDBClient();
+
+    ///  Constructor
+    /// \param db_directory - directory of local databases
+    /// \param db_name - name of database ( subdirectory )
+    FileDBClient( const std::string& db_directory, const std::string& db_name );
+
+    ///  Destructor
+    ~FileDBClient();
+
+    /// Path to the database files
+    const std::string& db_path() const
+    {
+        return database_path;
+    }
+
+    AbstractDBDriver *clone(const std::string& new_db_name) override;
+
+    /// Report message about the local database.
+    std::string status() const override;
+    /// Return true if the database directory is opened.
+    bool connected() const override;
+
+    /// Compact segments of all collections
+    void compact();
+
+    // Collections API
+
+    /// Create collection if no exist
+    /// \param colname - name of collection
+    /// \param type - type of collection ( "undef", "schema", "vertex", "edge" )
+    void create_collection(const std::string& collname, const std::string& ctype) override;
+
+    /// Returns all collections names of the given database.
+    /// \param ctype - types of collection to select.
+    std::set<std::string> get_collections_names( CollTypes ctype ) override;
+
+    // CRUD API
+
+    /// Returns the document described by the selector.
+    /// \param collname - collection name
+    /// \param it -  pair: key -> selector
+    /// \param jsonrec - object to receive data
+    bool read_record( const std::string& collname, keysmap_t::iterator& it, JsonBase& recdata ) override;
+
+    /// Update an existing document described by the selector.
+    /// \param collname - collection name
+    /// \param it -  pair: key -> selector
+    /// \param jsonrec - json object with data
+    std::string update_record( const std::string& collname, keysmap_t::iterator& it, const JsonBase& recdata ) override;
+
+    /// Removes a document described by the selector.
+    /// \param collname - collection name
+    /// \param it -  pair: key -> selector
+    bool delete_record(const std::string& collname, keysmap_t::iterator& it ) override;
+
+    // Query API
+
+    /// Fetches all documents from a collection that match the specified condition.
+    ///  \param collname - collection name
+    ///  \param query -    selection condition
+    ///  \param setfnc -   callback function fetching document data
+    void select_query( const std::string& collname, const DBQueryBase& query, SetReaded_f setfnc ) override;
+
+    /// Looks up the documents in the specified collection using the array of ids provided.
+    ///  \param collname - collection name
+    ///  \param ids -      array of _ids
+    ///  \param setfnc -   callback function fetching document data
+    void lookup_by_ids( const std::string& collname,  const std::vector<std::string>& ids,  SetReaded_f setfnc ) override;
+
+    /// Fetches all documents from a collection.
+    ///  \param collname -    collection name
+    ///  \param query_fields - list of fields to selection
+    ///  \param setfnc -     callback function fetching document data
+    void all_query( const std::string& collname, const std::set<std::string>& query_fields,  SetReadedKey_f setfnc ) override;
+
+    ///  Provides 'distinct' operation over collection
+    ///  \param collname - collection name
+    ///  \param fpath    - field path to collect distinct values from
+    ///  \param  values  - return values by specified fpath and collname
+    void fpath_collect( const std::string& collname, const std::string& fpath, std::vector<std::string>& values ) override;
+
+    /// Delete all edges linked to vertex record.
+    ///  \param collname - collection name
+    ///  \param vertexid - vertex record id
+    void delete_edges(const std::string& collname, const std::string& vertexid ) override;
+
+    /// Removes all documents from the collection whose keys are contained in the keys array.
+    ///  \param collname - collection name
+    ///  \param ids -      array of keys
+    void remove_by_ids( const std::string& collname,  const std::vector<std::string>& ids  ) override;
+
+protected:
+
+    /// Number of documents read under one lock while scanning collection
+    static std::size_t scan_batch_size;
+
+    std::string directory_path;
+    std::string database_name;
+    std::string database_path;
+
+    /// Collection name -> collection type
+    std::map<std::string, std::string> collection_types;
+    /// Collection name -> documents storage
+    std::map<std::string, std::shared_ptr<FileSegmentsStore>> collection_stores;
+    mutable std::shared_mutex collections_mutex;
+
+    /// Last generated _rev and _key
+    std::atomic<std::uint64_t> last_tick;
+
+    /// Open database directory and collections
+    void open_database();
+    /// Write the collections list file ( collections_mutex must be locked )
+    void save_collections_list();
+    /// Get storage of collection ( throw if collection not exist )
+    std::shared_ptr<FileSegmentsStore> collection_store( const std::string& collname ) const;
+    /// Generate a new unique number for _rev and _key
+    std::uint64_t new_tick() override;
+    /// Insert new document into the collection ( false if the document exists )
+    bool insert_record( const std::string& collname, const std::string& id, const JsonBase& recdata ) override;
+    /// Make json string of document with system fields _id, _key and new _rev
+    std::string make_document( const std::string& id, const JsonBase& recdata );
+
+    /// Read documents could match query and send parsed documents to visitor ( out of locks )
+    void scan_documents( const FileSegmentsStore& store, const DBQueryMatcher& matcher,
+                         const std::function<void( const JsonBase&, const std::string& )>& visitor ) const;
+};
+
+} // namespace jsonio
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+#include "jsonio/dbdriverbase.h"
+#include "jsonio/dbquerybase.h"
+
+namespace jsonio {
+
+class DBQueryMatcher;
+
+/// Base of Database Drivers keeping collections locally ( in memory or files ).
+/// Implements document-handles, keys generation and the data selection of queries
+/// the same way for all local storages; query conditions are evaluated by DBQueryMatcher.
+class LocalDBDriver: public AbstractDBDriver
+{
+
+public:
+
+    ///  Constructor
+    LocalDBDriver():AbstractDBDriver()
+    {}
+
+    std::string get_server_key( const std::string& second ) const override
+    {
+        return second;
+    }
+
+    void set_server_key( std::string& second, const std::string& key ) override
+    {
+        second = key;
+    }
+
+    /// Creates a new document in the collection from the given data.
+    /// The key is taken from _key or _id of data, or generated as unique number.
+    /// \param collname - collection name
+    /// \param jsonrec - json object with data
+    /// \return the document-handle.
+    std::string create_record( const std::string& collname, std::string& second, const JsonBase& recdata ) override;
+
+    /// Check the document-handle example in to contain only
+    /// characters allowed into ArangoDB keys ( to move data between drivers ).
+    /// \return  a document-handle that contain only only allowed characters.
+    std::string sanitization( const std::string& documentHandle ) override;
+
+protected:
+
+    /// Selection of the data returned by all_query()
+    struct AllQueryFields
+    {
+        /// Only _id of documents
+        bool only_id = false;
+        /// Whole documents ( no fields or fields with paths )
+        bool whole_document = false;
+        /// Fields of projection
+        fields2query_t map_fields = {};
+
+        explicit AllQueryFields( const std::set<std::string>& query_fields );
+
+        /// Test the document json is needed to make the result
+        bool need_data() const
+        {
+            return !only_id;
+        }
+
+        /// Json data to return for the document
+        /// \param document - parsed document ( nullptr - parse jsondata if projection is needed )
+        std::string result( const std::string& id, std::string_view jsondata, const JsonBase* document = nullptr ) const;
+    };
+
+    /// Generate a new unique number for _rev and _key
+    virtual std::uint64_t new_tick() = 0;
+
+    /// Insert new document into the collection
+    /// \return false if the document with id already exists
+    virtual bool insert_record( const std::string& collname, const std::string& id, const JsonBase& recdata ) = 0;
+
+    /// Get _id from _id or _key
+    static std::string document_id( const std::string& collname, const std::string& id_or_key );
+
+    /// Names of collections read by the query: the edge collections for edges queries,
+    /// the AQL FOR collection or the collection itself.
+    std::vector<std::string> query_collections( const std::string& collname, const DBQueryMatcher& matcher );
+};
+
+} // namespace jsonio
@@ -0,0 +1,175 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <shared_mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include "jsonio/dbdriverlocal.h"
+
+namespace jsonio {
+
+class JsonFree;
+class DBQueryMatcher;
+
+/// Implementation of Database Driver keeping collections in memory.
+/// Documents are stored parsed together with their json strings, so queries do not parse data.
+/// Hash indexes "field value -> documents" are kept for _from and _to of edge collections
+/// and for the string fields added by ensure_index(); they select candidates of template,
+/// edges and AQL equality queries, all other conditions are evaluated by DBQueryMatcher.
+/// Used to test and benchmark the document layer without ArangoDB server.
+class MemoryDBClient: public LocalDBDriver
+{
+
+public:
+
+    ///  Constructor
+    /// \param db_name - name of database ( only reported into status )
+    explicit MemoryDBClient( const std::string& db_name = "memory" );
+
+    ///  Destructor
+    ~MemoryDBClient();
+
+    /// Clone creates a new empty in-memory database.
+    AbstractDBDriver *clone(const std::string& new_db_name) override;
+
+    /// Report message about the database.
+    std::string status() const override;
+    /// Always connected.
+    bool connected() const override
+    {
+        return true;
+    }
+
+    /// Add hash index by string values of the field path
+    /// \param colname - name of collection
+    /// \param fieldpath - path of the field ( "properties.name" )
+    void ensure_index( const std::string& collname, const std::string& fieldpath );
+
+    /// Number of documents into collection
+    std::size_t documents_count( const std::string& collname ) const;
+
+    /// Remove all collections
+    void clear();
+
+    // Collections API
+
+    /// Create collection if no exist
+    /// \param colname - name of collection
+    /// \param type - type of collection ( "undef", "schema", "vertex", "edge" )
+    void create_collection(const std::string& collname, const std::string& ctype) override;
+
+    /// Returns all collections names of the given database.
+    /// \param ctype - types of collection to select.
+    std::set<std::string> get_collections_names( CollTypes ctype ) override;
+
+    // CRUD API
+
+    /// Returns the document described by the selector.
+    /// \param collname - collection name
+    /// \param it -  pair: key -> selector
+    /// \param jsonrec - object to receive data
+    bool read_record( const std::string& collname, keysmap_t::iterator& it, JsonBase& recdata ) override;
+
+    /// Update an existing document described by the selector.
+    /// \param collname - collection name
+    /// \param it -  pair: key -> selector
+    /// \param jsonrec - json object with data
+    std::string update_record( const std::string& collname, keysmap_t::iterator& it, const JsonBase& recdata ) override;
+
+    /// Removes a document described by the selector.
+    /// \param collname - collection name
+    /// \param it -  pair: key -> selector
+    bool delete_record(const std::string& collname, keysmap_t::iterator& it ) override;
+
+    // Query API
+
+    /// Fetches all documents from a collection that match the specified condition.
+    ///  \param collname - collection name
+    ///  \param query -    selection condition
+    ///  \param setfnc -   callback function fetching document data
+    void select_query( const std::string& collname, const DBQueryBase& query, SetReaded_f setfnc ) override;
+
+    /// Looks up the documents in the specified collection using the array of ids provided.
+    ///  \param collname - collection name
+    ///  \param ids -      array of _ids
+    ///  \param setfnc -   callback function fetching document data
+    void lookup_by_ids( const std::string& collname,  const std::vector<std::string>& ids,  SetReaded_f setfnc ) override;
+
+    /// Fetches all documents from a collection.
+    ///  \param collname -    collection name
+    ///  \param query_fields - list of fields to selection
+    ///  \param setfnc -     callback function fetching document data
+    void all_query( const std::string& collname, const std::set<std::string>& query_fields,  SetReadedKey_f setfnc ) override;
+
+    ///  Provides 'distinct' operation over collection
+    ///  \param collname - collection name
+    ///  \param fpath    - field path to collect distinct values from
+    ///  \param  values  - return values by specified fpath and collname
+    void fpath_collect( const std::string& collname, const std::string& fpath, std::vector<std::string>& values ) override;
+
+    /// Delete all edges linked to vertex record.
+    ///  \param collname - collection name
+    ///  \param vertexid - vertex record id
+    void delete_edges(const std::string& collname, const std::string& vertexid ) override;
+
+    /// Removes all documents from the collection whose keys are contained in the keys array.
+    ///  \param collname - collection name
+    ///  \param ids -      array of keys
+    void remove_by_ids( const std::string& collname,  const std::vector<std::string>& ids  ) override;
+
+protected:
+
+    /// Stored document ( never changed, replaced on update )
+    struct Document
+    {
+        std::string jsondata;
+        std::shared_ptr<const JsonFree> data;
+    };
+    using Document_ptr = std::shared_ptr<const Document>;
+    /// Hash index: field value -> ids of documents
+    using HashIndex = std::unordered_map<std::string, std::unordered_set<std::string>>;
+
+    /// Documents and indexes of one collection
+    struct Collection
+    {
+        std::string type;
+        std::unordered_map<std::string, Document_ptr> documents;
+        /// Field path -> hash index
+        std::map<std::string, HashIndex> indexes;
+        mutable std::shared_mutex mutex;
+    };
+
+    std::string database_name;
+    /// Collection name -> collection data
+    std::map<std::string, std::shared_ptr<Collection>> collections;
+    mutable std::shared_mutex collections_mutex;
+
+    /// Last generated _rev and _key
+    std::atomic<std::uint64_t> last_tick;
+
+    /// Get collection ( throw if collection not exist )
+    std::shared_ptr<Collection> get_collection( const std::string& collname ) const;
+    /// Generate a new unique number for _rev and _key
+    std::uint64_t new_tick() override
+    {
+        return ++last_tick;
+    }
+    /// Insert new document into the collection ( false if the document exists )
+    bool insert_record( const std::string& collname, const std::string& id, const JsonBase& recdata ) override;
+    /// Make document with system fields _id, _key and new _rev
+    Document_ptr make_document( const std::string& id, const JsonBase& recdata );
+
+    /// Add or replace document and update indexes ( collection mutex must be locked )
+    static void put_document( Collection& collection, const std::string& id, Document_ptr document );
+    /// Remove document and update indexes ( collection mutex must be locked )
+    static bool remove_document( Collection& collection, const std::string& id );
+    /// Add the document to index ( or remove if add is false )
+    static void update_index( HashIndex& index, const std::string& fieldpath,
+                              const std::string& id, const Document& document, bool add );
+
+    /// Select documents could match query using indexes ( all documents if no index suitable )
+    std::vector<Document_ptr> candidates( const Collection& collection, const DBQueryMatcher& matcher ) const;
+};
+
+} // namespace jsonio
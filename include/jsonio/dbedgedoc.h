@@ -33,7 +33,11 @@ public:
     }
 
     ///  Destructor
-    virtual ~DBEdgeDocument(){}
+    virtual ~DBEdgeDocument()
+    {
+        waitAsyncRequests();
+        stop_query_refresh();
+    }
 
 
     /// Define new edge document
@@ -44,7 +44,11 @@ public:
     {}
 
     ///  Destructor
-    virtual ~DBJsonDocument(){}
+    virtual ~DBJsonDocument()
+    {
+        waitAsyncRequests();
+        stop_query_refresh();
+    }
 
     /// Link to internal data
     const JsonFree& loaded_data() const override
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <mutex>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace jsonio {
+
+/// \class KeysIndex sorted index of documents ids used to generate new unique keys.
+/// The index does not own the strings, it refers to the values of the collection keys map,
+/// so the referenced string must be erased from the index before it is destroyed.
+/// Prefix queries take O(log n + k), the next free suffix of every key template is remembered.
+class KeysIndex
+{
+
+public:
+
+    /// Add id to index
+    void insert( std::string_view id );
+
+    /// Remove id from index
+    void erase( std::string_view id );
+
+    /// Remove all ids and suffix counters
+    void clear();
+
+    /// Number of indexed ids
+    std::size_t size() const
+    {
+        return ids.size();
+    }
+
+    /// Test the id is into index
+    bool contains( std::string_view id ) const
+    {
+        return ids.find( id ) != ids.end();
+    }
+
+    /// Test any id starts with id_head
+    bool has_prefix( std::string_view id_head ) const;
+
+    /// Get all ids started with id_head
+    std::vector<std::string> with_prefix( std::string_view id_head ) const;
+
+    /// Get the suffix to make an unique id from id_head.
+    /// \return empty string if no ids started with id_head, otherwise "_N"
+    /// with the first N not used after the previous generated suffix
+    std::string unique_suffix( const std::string& id_head ) const;
+
+protected:
+
+    /// Sorted ids ( referenced to the keys map values )
+    std::set<std::string_view> ids;
+
+    /// Next suffix to test for each key template
+    mutable std::unordered_map<std::string, std::size_t> next_suffix;
+    mutable std::mutex suffix_mutex;
+};
+
+} // namespace jsonio
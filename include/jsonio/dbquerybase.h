@@ -4,6 +4,8 @@
 #include <memory>
 #include <map>
 #include <set>
+#include <unordered_map>
+#include <unordered_set>
 #include "jsonio/service.h"
 
 namespace arangocpp {
@@ -14,6 +16,7 @@ namespace jsonio {
 
 class JsonBase;
 class JsonFree;
+class DBQueryMatcher;
 
 /// Map of query fields  <field name>-><field into json record>
 /// Used to generate return values for AQL
@@ -128,7 +131,7 @@ public:
         {
             std::string fld = *itr;
             // to ArangoDB indexes
-            auto fielkey = regexp_replace(*itr ,"\\.([0-9])", "[$1]");
+            auto fielkey = brackets_field_path( *itr );
             replace_all( fld, ".", '_');
             map_fields[fielkey] = fld;
         }
@@ -260,6 +263,8 @@ protected:
 };
 
 /// \class  DBQueryResult used to store query definition and result.
+/// The result table is stored by columns, the values of each column are dictionary encoded.
+/// Hash indexes can be built for chosen fields to select lines by values without full scan.
 class DBQueryResult final
 {
     friend class DBDocumentBase;
@@ -270,7 +275,10 @@ public:
 
     DBQueryResult( const DBQueryDef& aquery ):
         query_data(aquery)
-    { }
+    {
+        reset_columns();
+        reset_matcher();
+    }
     ~DBQueryResult() {}
 
 
@@ -288,6 +296,7 @@ public:
     {
         query_data = qrdef;
         clear();
+        reset_matcher();
     }
     void updateSchema( const std::string& shname )
     {
@@ -296,15 +305,30 @@ public:
 
     void clear()
     {
-        query_result_data.clear();
+        key_rows.clear();
+        row_keys.clear();
+        free_rows.clear();
+        reset_columns();
+    }
+
+    /// Set fields to build hash indexes ( fields must be into query fields list )
+    void setIndexedFields( const std::set<std::string>& fieldnames );
+
+    /// Get fields with hash indexes
+    const std::set<std::string>& indexedFields() const
+    {
+        return indexed_fields;
     }
 
-    /// Get query result table
-    const key_values_table_t& queryResult() const
+    /// Number of lines into query result table
+    std::size_t size() const
     {
-        return query_result_data;
+        return key_rows.size();
     }
 
+    /// Build query result table
+    key_values_table_t queryResult() const;
+
     ///  Get all keys list for current query
     std::size_t getKeysValues( std::vector<std::string>& aKeyList,
                                std::vector<values_t>& aValList ) const;
@@ -323,26 +347,94 @@ public:
     /// Extract first key from data
     std::string getFirstKey() const;
 
+    /// Number of different values of the field into the current lines
+    std::size_t fieldValuesCount( const std::string& fieldname ) const;
+
 protected:
 
+    /// Dictionary encoded column of the result table
+    struct ResultColumn
+    {
+        /// Different values of column
+        std::vector<std::string> dictionary = {};
+        /// Value -> code ( index into dictionary )
+        std::unordered_map<std::string, std::size_t> codes = {};
+        /// Number of lines using each code
+        std::vector<std::size_t> uses = {};
+        /// Codes released by the last line, reused by new values
+        std::vector<std::size_t> free_codes = {};
+        /// Codes of values by lines
+        std::vector<std::size_t> cells = {};
+        /// Hash index code -> lines
+        std::unordered_map<std::size_t, std::unordered_set<std::size_t>> index = {};
+        bool indexed = false;
+
+        /// Get code of value for one more line, add value to dictionary if not exist
+        std::size_t encode( const std::string& value );
+        /// Release code used by one line, free the value if no lines use it
+        void release( std::size_t code );
+        /// Get code of value, return false if value not into dictionary
+        bool find_code( const std::string& value, std::size_t& code ) const;
+        /// Build hash index for all used lines
+        void build_index( const std::vector<const std::string*>& row_keys );
+    };
+
     /// Description query
     DBQueryDef      query_data;
-    /// Table of values were gotten from query
-    key_values_table_t  query_result_data = {};
+    /// Fields to build hash indexes
+    std::set<std::string> indexed_fields = {};
+    /// Query fields translated to keys of the query fields map ( brackets_field_path )
+    std::vector<std::string> fields_query_keys = {};
+
+    /// Key of line -> line into columns
+    std::map<std::string, std::size_t> key_rows = {};
+    /// Line into columns -> key of line ( nullptr for deleted lines )
+    std::vector<const std::string*> row_keys = {};
+    /// Lines into columns free after delete
+    std::vector<std::size_t> free_rows = {};
+    /// Columns of values were gotten from query
+    std::vector<ResultColumn> columns = {};
+    /// Compiled query condition to test changed documents
+    /// ( nullptr - the condition could not be evaluated for a single document )
+    std::shared_ptr<DBQueryMatcher> line_matcher;
+
+    /// Recreate empty columns and field keys for query fields
+    void reset_columns();
+    /// Compile the query condition to test changed documents
+    void reset_matcher();
+    /// Test the changed document belongs to the query result
+    /// \return false if the condition could not be evaluated for the document
+    bool match_line( const std::string& key_str, const JsonBase& nodedata, bool& matched ) const;
+    /// Add or replace line into columns
+    void set_row( const std::string& key_str, const values_t& values );
+    /// Get values of line
+    values_t row_values( std::size_t row ) const;
+    /// Get lines with values codes equal to codes of selected columns ( sorted by keys )
+    /// \param column_codes - list of pairs <column>-><code>
+    /// \param only_first - stop on the first line found by full scan
+    std::vector<std::size_t> select_rows( const std::vector<std::pair<std::size_t, std::size_t>>& column_codes,
+                                          bool only_first = false ) const;
 
     /// Make line to view table
     void node_to_values(  const JsonBase& node, values_t& values ) const;
     /// Make line to view table when only selected fields
     void node_to_values_fields(const JsonBase &node, const fields2query_t &map_fields, values_t &values) const;
 
-    /// Add line to view table
-    void add_line( const std::string& key_str, const JsonBase& nodedata, bool isupdate );
-    /// Update line into view table
-    void update_line( const std::string& key_str, const JsonBase& nodedata );
+    /// Add line to view table if the document matches the query condition
+    /// ( delete the line of the updated document that no longer matches )
+    /// \return false if the condition could not be evaluated, the query must be executed again
+    bool add_line( const std::string& key_str, const JsonBase& nodedata, bool isupdate );
+    /// Update, add or delete line of the updated document by the query condition
+    /// \return false if the condition could not be evaluated, the query must be executed again
+    bool update_line( const std::string& key_str, const JsonBase& nodedata );
     /// Delete line from view table
     void delete_line( const std::string& key_str );
 
+    /// Add line of the document returned by the query to view table
+    void add_line_document( const std::string& key_str, const JsonBase& nodedata );
     void add_line_fields( const std::string& key_str, const JsonBase &nodedata, const fields2query_t &map_fields);
+    /// Add line with values of query fields to view table
+    void add_line_values( const std::string& key_str, const values_t& values );
 };
 
 } // namespace jsonio
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <memory>
+#include <string_view>
+#include "jsonio/dbdriverbase.h"
+#include "jsonio/dbquerybase.h"
+
+namespace jsonio {
+
+/// \class DBQueryMatcher evaluates the DBQueryBase conditions over documents stored locally.
+/// Used by embedded database drivers that have no query engine of their own.
+/// Supported queries:
+///  - qAll: all documents;
+///  - qTemplate: json template { "field.path": value, "object": { "field": value } };
+///  - qEdgesFrom, qEdgesTo, qEdgesAll: { "startVertex": id, "edgeCollections": "coll1,coll2" }
+///    or old style json template ( { "_type": "edge", "_from": id } );
+///  - qAQL subset:  FOR u IN coll [FILTER expr]... [SORT u.path [ASC|DESC],...] [LIMIT [offset,] count]
+///    [RETURN [DISTINCT] u | u.path | { "name": u.path, ... }].
+///    FILTER expressions are comparisons ( ==, !=, <, <=, >, >=, IN, NOT IN, LIKE ) of document paths,
+///    literals and bind parameters combined by &&, ||, ! ( AND, OR, NOT ) and brackets.
+/// If the query fields are defined and no RETURN, the result is { "<field name>": u.<field path>, ... }.
+class DBQueryMatcher
+{
+
+public:
+
+    /// Node of the compiled expression
+    struct Expression;
+
+    /// Function to receive the document data ( parsed document and json string )
+    using Visit_f = std::function<void( const JsonBase& document, const std::string& jsondata )>;
+    /// Function to read documents of collection, it calls the visitor for each document
+    using Scan_f = std::function<void( const Visit_f& visitor )>;
+
+    /// Constructor, compiles the query
+    explicit DBQueryMatcher( const DBQueryBase& query );
+    /// Destructor
+    ~DBQueryMatcher();
+
+    DBQueryMatcher( const DBQueryMatcher& ) = delete;
+    DBQueryMatcher& operator=( const DBQueryMatcher& ) = delete;
+
+    /// Type of the compiled query
+    DBQueryBase::QType type() const
+    {
+        return query_type;
+    }
+
+    /// Test for the edges traversal query
+    bool isEdgesQuery() const
+    {
+        return !start_vertex.empty();
+    }
+
+    /// Start vertex of edges traversal query
+    const std::string& startVertex() const
+    {
+        return start_vertex;
+    }
+
+    /// Edges traversal query selects edges with _from equal to start vertex
+    bool outEdges() const
+    {
+        return out_edges;
+    }
+
+    /// Edges traversal query selects edges with _to equal to start vertex
+    bool inEdges() const
+    {
+        return in_edges;
+    }
+
+    /// Conditions "field path == string value" all documents of result must satisfy
+    /// ( used by drivers to select candidate documents from indexes ).
+    const std::vector<std::pair<std::string, std::string>>& equalConditions() const
+    {
+        return equal_conditions;
+    }
+
+    /// Collections defined into query ( edges collections or AQL FOR collection )
+    const std::vector<std::string>& collections() const
+    {
+        return query_collections;
+    }
+
+    /// Test if the raw json string could contain the document matching the query.
+    /// The fast test used before parsing the document ( false - the document does not match ).
+    bool mayMatch( std::string_view jsondata ) const;
+
+    /// Test the document matches the query condition
+    bool match( const JsonBase& document ) const;
+
+    /// Test the query result is the set of matched documents ( no edges traversal, LIMIT
+    /// or RETURN of other values ), so match() of a changed document decides its line in the result.
+    bool selectsDocuments() const;
+
+    /// Generate the json string with data to return for the matched document
+    std::string result( const JsonBase& document, const std::string& jsondata ) const;
+
+    /// Select documents matching the query, apply SORT, LIMIT and DISTINCT and send results to callback
+    void select( const Scan_f& scan, SetReaded_f setfnc ) const;
+
+    /// Generate the json string with the selected fields of the document
+    static std::string project( const JsonBase& document, const fields2query_t& map_fields );
+
+    /// Compare two json values in the AQL order ( null < bool < number < string < array < object )
+    static int compare( const JsonBase* left, const JsonBase* right );
+
+protected:
+
+    DBQueryBase::QType query_type;
+    /// Parsed json values used into expressions ( templates, literals and bind parameters )
+    std::vector<std::shared_ptr<JsonFree>> value_holders;
+    /// Root of parsed FILTER expression ( nullptr - all documents )
+    std::shared_ptr<Expression> filter;
+    /// Raw strings that must be into document json to match
+    std::vector<std::string> required_strings;
+    /// Top level equality conditions with string values
+    std::vector<std::pair<std::string, std::string>> equal_conditions;
+
+    std::string start_vertex;
+    bool out_edges = false;
+    bool in_edges = false;
+    std::vector<std::string> query_collections;
+
+    /// Result fields ( empty - whole document )
+    fields2query_t query_fields;
+    /// Expression of RETURN value ( nullptr - whole document or query fields )
+    std::shared_ptr<Expression> return_value;
+    bool return_distinct = false;
+
+    /// SORT expressions and descending flags
+    std::vector<std::pair<std::shared_ptr<Expression>, bool>> sort_by;
+    std::size_t limit_offset = 0;
+    std::size_t limit_count = std::string::npos;
+
+    void compile_template( const std::string& template_json );
+    void compile_edges( const std::string& edges_json );
+    void compile_aql( const std::string& aql, const std::string& bind_vars );
+    void add_equal_condition( const std::string& fieldpath, const JsonBase& value );
+};
+
+} // namespace jsonio
@@ -39,7 +39,11 @@ public:
     {}
 
     ///  Destructor
-    virtual ~DBSchemaDocument(){}
+    virtual ~DBSchemaDocument()
+    {
+        waitAsyncRequests();
+        stop_query_refresh();
+    }
 
     /// Change current schema
     virtual void resetSchema( const std::string& aschema_name, bool change_queries );
@@ -20,13 +20,19 @@ class DBVertexDocument : public DBSchemaDocument
     /// Do it before remove document with key from collection.
     /// Remove all edges connected to vertex.
     void before_remove( const std::string&  ) override;
-    /// Do it after remove document with key from collection.
-    /// Delete from unique map.
-    void after_remove( const std::string&  ) override;
     /// Do it before write document to database
     void before_save_update( std::string&  ) override;
     /// Do it after write document to database
-    void after_save_update( const std::string&  ) override;
+    void after_save_update( const std::string&, const JsonBase& saved_data ) override;
+    /// Add line to view table ( only documents with the label of this vertex )
+    void add_line( const std::string& key_str, const JsonBase& nodedata, bool isupdate ) override;
+    /// Update line into view table ( delete the line if the document label changed )
+    void update_line( const std::string& key_str, const JsonBase& nodedata ) override;
+    /// Delete line from view table and unique map
+    /// ( called for all documents removed from the collection )
+    void delete_line( const std::string& key_str ) override;
+    /// Delete lines from view table and unique map
+    void delete_lines( const std::vector<std::string>& keys ) override;
 
 public:
 
@@ -77,7 +83,11 @@ public:
     }
 
     ///  Destructor
-    virtual ~DBVertexDocument(){}
+    virtual ~DBVertexDocument()
+    {
+        waitAsyncRequests();
+        stop_query_refresh();
+    }
 
     /// Change the mode of reading documents.
     /// If true, when reading a new record from DB, current schema can be changed.
@@ -177,6 +187,8 @@ protected:
     std::vector<std::string>  unique_fields_names ={};
     /// Table to save unique fields values
     unique_fields_map_t unique_fields_values ={};
+    /// Guards unique_fields_values changed by asynchronous requests
+    std::mutex unique_fields_mutex;
 
     /// Type constructor
     DBVertexDocument( const std::string& aschema_name, const DataBase& dbconnect,
@@ -197,6 +209,8 @@ protected:
     void update_collection( const std::string& aschemaName );
 
     unique_fields_map_t::iterator unique_line_by_id( const std::string& idschem );
+    /// Delete removed documents from unique map
+    void remove_unique_lines( const std::vector<std::string>& keys );
 
 };
 
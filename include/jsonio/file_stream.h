@@ -0,0 +1,234 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace jsonio {
+
+/// Compression formats of files
+enum class Compression {
+    None,    ///< Plain file
+    Gzip,    ///< gzip ( ".gz" extension, needs build with zlib )
+    Zstd     ///< Zstandard ( ".zst" extension, needs build with zstd )
+};
+
+/// Compression of the file defined by extension
+Compression compression_from_path( const std::string& file_path );
+
+/// Test the compression format is supported by build
+bool compression_supported( Compression compression );
+
+/// Statistics of the file stream
+struct StreamStatistics
+{
+    std::uint64_t file_bytes = 0;   ///< Bytes read from or written to file
+    std::uint64_t data_bytes = 0;   ///< Bytes of uncompressed data
+    double seconds = 0.;            ///< Time from open of stream
+
+    /// Compression ratio ( uncompressed size / file size )
+    double ratio() const
+    {
+        return ( file_bytes > 0 ? static_cast<double>( data_bytes )/static_cast<double>( file_bytes ) : 1. );
+    }
+    /// Throughput of uncompressed data, MB/s
+    double throughput() const
+    {
+        return ( seconds > 0. ? static_cast<double>( data_bytes )/seconds/1024./1024. : 0. );
+    }
+};
+
+/// Read-only view of the whole file.
+/// The file is mapped into memory, so its pages are shared with the page cache and not copied;
+/// if the mapping is not possible ( or switched off ) the file is read into a buffer.
+class MappedFile
+{
+
+public:
+
+    /// Map files into memory ( false - always read into buffer )
+    static bool use_mmap;
+
+    /// Constructor, maps or reads the file
+    /// \param sequential - hint the file will be read sequentially ( MADV_SEQUENTIAL )
+    explicit MappedFile( const std::string& file_path, bool sequential = true );
+    /// Destructor, unmaps the file
+    ~MappedFile();
+
+    MappedFile( const MappedFile& ) = delete;
+    MappedFile& operator=( const MappedFile& ) = delete;
+
+    /// Text of the file ( UTF-8 BOM is skipped )
+    std::string_view view() const
+    {
+        return text;
+    }
+
+    /// The file is mapped into memory
+    bool isMapped() const
+    {
+        return mapped_data != nullptr;
+    }
+
+protected:
+
+    void* mapped_data = nullptr;
+    std::size_t mapped_size = 0;
+    std::string buffer;
+    std::string_view text;
+
+    /// Map file into memory ( false if mapping is not possible )
+    bool map_file( const std::string& file_path, bool sequential );
+};
+
+/// Buffer of stream reading file, the gzip or zstd data is decompressed while reading
+class FileReadBuffer : public std::streambuf
+{
+
+public:
+
+    /// Constructor, opens the file
+    FileReadBuffer( const std::string& file_path, Compression compression, std::size_t buffer_size = 256*1024 );
+    /// Destructor, closes the file
+    ~FileReadBuffer();
+
+    FileReadBuffer( const FileReadBuffer& ) = delete;
+    FileReadBuffer& operator=( const FileReadBuffer& ) = delete;
+
+    /// Statistics of reading
+    StreamStatistics statistics() const;
+
+    /// Codec of file data
+    class Codec;
+
+protected:
+
+    std::string file_path;
+    std::FILE* file = nullptr;
+    std::unique_ptr<Codec> decoder;
+    std::vector<char> buffer;
+    std::uint64_t data_bytes = 0;
+    std::chrono::steady_clock::time_point start_time;
+
+    int_type underflow() override;
+};
+
+/// Buffer of stream writing file, the data is compressed by gzip or zstd while writing
+class FileWriteBuffer : public std::streambuf
+{
+
+public:
+
+    /// Constructor, opens the file
+    /// \param append - append data to the end of file ( compressed data is added as the next frame )
+    FileWriteBuffer( const std::string& file_path, Compression compression,
+                     bool append = false, std::size_t buffer_size = 256*1024 );
+    /// Destructor, closes the file ( errors are only logged )
+    ~FileWriteBuffer();
+
+    FileWriteBuffer( const FileWriteBuffer& ) = delete;
+    FileWriteBuffer& operator=( const FileWriteBuffer& ) = delete;
+
+    /// The last written bytes could be overwritten ( plain file )
+    bool seekable() const
+    {
+        return compression_type == Compression::None;
+    }
+
+    /// Write all buffered data, so the file could be decompressed up to this point
+    /// \param to_disk - synchronize file with disk
+    void flush( bool to_disk );
+
+    /// The last back_size written bytes will be overwritten by next writing ( only seekable )
+    void seekBack( std::size_t back_size );
+
+    /// Finish compressed data and close the file
+    void close();
+
+    /// Statistics of writing
+    StreamStatistics statistics() const;
+
+    /// Codec of file data
+    class Codec;
+
+protected:
+
+    std::string file_path;
+    Compression compression_type;
+    std::FILE* file = nullptr;
+    std::unique_ptr<Codec> encoder;
+    std::vector<char> buffer;
+    std::uint64_t data_bytes = 0;
+    std::chrono::steady_clock::time_point start_time;
+
+    int_type overflow( int_type ch ) override;
+    int sync() override;
+    /// Pass buffered data to encoder
+    void write_buffer( int mode );
+};
+
+/// Input stream of plain or compressed file
+class FileReadStream : public std::istream
+{
+
+public:
+
+    /// Constructor, the compression is defined by extension of file
+    explicit FileReadStream( const std::string& file_path ):
+        std::istream( nullptr ), read_buffer( file_path, compression_from_path( file_path ) )
+    {
+        rdbuf( &read_buffer );
+        // errors of reading and decompression are thrown to caller
+        exceptions( std::ios::badbit );
+    }
+
+    /// Statistics of reading
+    StreamStatistics statistics() const
+    {
+        return read_buffer.statistics();
+    }
+
+protected:
+
+    FileReadBuffer read_buffer;
+};
+
+/// Output stream of plain or compressed file
+class FileWriteStream : public std::ostream
+{
+
+public:
+
+    /// Constructor, the compression is defined by extension of file
+    explicit FileWriteStream( const std::string& file_path, bool append = false ):
+        std::ostream( nullptr ), write_buffer( file_path, compression_from_path( file_path ), append )
+    {
+        rdbuf( &write_buffer );
+        exceptions( std::ios::badbit );
+    }
+
+    /// Buffer of stream to flush, seek and close
+    FileWriteBuffer& buffer()
+    {
+        return write_buffer;
+    }
+
+    /// Statistics of writing
+    StreamStatistics statistics() const
+    {
+        return write_buffer.statistics();
+    }
+
+protected:
+
+    FileWriteBuffer write_buffer;
+};
+
+} // namespace jsonio
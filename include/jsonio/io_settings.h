@@ -1,14 +1,48 @@
 #pragma once
 
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <thread>
 #include <vector>
 #include "jsonio/schema.h"
 
+namespace spdlog::details {
+class thread_pool;
+}
+
 namespace jsonio {
 
 class JsonioSettings;
 /// Function to connect for a Preferences object
 extern JsonioSettings &ioSettings();
 
+/// Typed values of settings used on hot paths, resolved once from the settings tree.
+/// The snapshot is immutable: changes of settings create a new snapshot,
+/// the values not defined into settings are empty ( the caller default is used ).
+struct SettingsSnapshot
+{
+    /// Full settings as JSON string
+    std::string settings_json;
+
+    /// Current work directory
+    std::string user_dir;
+    /// Current home directory
+    std::string home_dir;
+
+    /// "jsonio.AsyncThreads"
+    std::optional<std::size_t> async_threads;
+    /// "jsonio.AsyncQueueSize"
+    std::optional<std::size_t> async_queue_size;
+    /// "jsonio.DocumentsCacheSize"
+    std::optional<std::size_t> documents_cache_size;
+    /// "jsonio.DocumentsCacheValidate"
+    bool documents_cache_validate = false;
+    /// "arangodb.DBPoolSize"
+    std::optional<std::size_t> db_pool_size;
+};
+
 
 /// Definition of json based section settings
 class SectionSettings final
@@ -19,12 +53,14 @@ public:
     /// Check if a section object contains a certain jsonpath.
     bool contains(const std::string& jsonpath ) const
     {
+        std::lock_guard<std::mutex> lock( changes_mutex() );
         return head_object->path_if_exists( jsonpath );
     }
 
     /// @brief Dump section to JSON string.
     std::string dump() const
     {
+        std::lock_guard<std::mutex> lock( changes_mutex() );
         return  head_object->dump( true );
     }
 
@@ -45,6 +81,7 @@ public:
     T value( const std::string& jsonpath, const T& defvalue  ) const
     {
         T avalue;
+        std::lock_guard<std::mutex> lock( changes_mutex() );
         head_object->get_value_via_path( jsonpath, avalue, defvalue );
         return avalue;
     }
@@ -60,12 +97,14 @@ public:
     template <class T>
     bool setValue( const std::string& jsonpath, const T& avalue  )
     {
-        if( head_object->set_value_via_path( jsonpath, avalue ) )
+        bool modified = false;
         {
-            sync();
-            return true;
+            std::lock_guard<std::mutex> lock( changes_mutex() );
+            modified = head_object->set_value_via_path( jsonpath, avalue );
         }
-        return false;
+        if( modified )
+            sync();
+        return modified;
     }
 
     bool setValue( const std::string& jsonpath, const char* avalue  )
@@ -92,8 +131,12 @@ protected:
         head_object = new_head_object;
     }
 
+    /// Settings changed, write them ( or schedule writing ) and invalidate the snapshot
     void sync() const;
 
+    /// Mutex locked while settings are modified or written
+    std::mutex& changes_mutex() const;
+
     friend class JsonioSettings;
 };
 
@@ -113,6 +156,9 @@ public:
     static std::string data_logger_directory;
     static size_t log_file_size;
     static size_t log_file_count;
+    /// Default size of queue and number of threads of asynchronous logging
+    static size_t log_async_queue_size;
+    static size_t log_async_threads;
 
     /// Constructor
     explicit JsonioSettings( const std::string& config_file_path );
@@ -121,6 +167,7 @@ public:
     /// Get section from settings
     SectionSettings section( const std::string& section_jsonpath )
     {
+        std::lock_guard<std::mutex> lock( sync_mutex );
         JsonFree& data = all_settings.add_object_via_path(section_jsonpath);
         return SectionSettings( *this, &data );
     }
@@ -155,15 +202,43 @@ public:
     /// @brief Dump settings to JSON string.
     std::string dump() const
     {
+        std::lock_guard<std::mutex> lock( sync_mutex );
         return  all_settings.dump( true );
     }
 
     /// Writes any unsaved changes to permanent storage
-    virtual void sync() const
+    /// ( the file is replaced by temporary file, so it is never left partially written )
+    virtual void sync() const;
+
+    /// Start batch of changes: the settings file is not written until endUpdate.
+    /// Batches could be nested, the file is written once by the outermost endUpdate.
+    void beginUpdate();
+
+    /// Finish batch of changes, write the settings file if it was changed into the outermost batch
+    void endUpdate();
+
+    /// Set delay of writing changed settings ( 0 - write at each change ).
+    /// With delay the settings file is written by background thread,
+    /// when no changes were done during the delay.
+    void setSyncDelay( std::chrono::milliseconds delay );
+
+    /// Delay of writing changed settings
+    std::chrono::milliseconds syncDelay() const
+    {
+        return sync_delay;
+    }
+
+    /// There are changes not written to settings file
+    bool hasPendingChanges() const
     {
-        config_file.save( all_settings );
+        std::lock_guard<std::mutex> lock( sync_mutex );
+        return sync_pending;
     }
 
+    /// Typed values of settings, the snapshot is rebuilt at first call after settings changed.
+    /// Keep the pointer while a consistent set of values is needed.
+    std::shared_ptr<const SettingsSnapshot> snapshot() const;
+
     // jsonio internal data links ------------------------------
 
     /// Current work directory
@@ -197,7 +272,7 @@ public:
     }
 
     /// Read schema description from json string
-    void addSchemaFormat( const std::string& format_type, const std::string& json_string );
+    void addSchemaFormat( const std::string& format_type, std::string_view json_string );
 
     /// Update/reread schema directory
     bool updateSchemaDir();
@@ -218,6 +293,15 @@ public:
     /// @param pattern     the pattern to set
     void set_pattern(const std::string &pattern);
 
+    /// Switch module loggers to asynchronous mode: messages are queued and written by the logging thread pool.
+    /// The loggers are not replaced ( only the writing of their sinks is switched ),
+    /// so the mode could be changed while other threads use them.
+    /// @param queue_size     max number of queued messages
+    /// @param threads_count  number of threads writing messages
+    /// @param overrun        drop the oldest messages if queue is full ( false - wait for free place )
+    void set_async_logging( bool async, size_t queue_size = log_async_queue_size,
+                            size_t threads_count = log_async_threads, bool overrun = false );
+
     void addSchemaFile(const std::string &file_path);
 private:
 
@@ -250,6 +334,39 @@ private:
     /// Current schema structure
     SchemasData schema;
 
+    /// Last built snapshot ( nullptr - settings changed )
+    mutable std::shared_ptr<const SettingsSnapshot> settings_snapshot;
+    mutable std::mutex snapshot_mutex;
+
+    /// Settings changed, the next snapshot() call rebuilds the snapshot
+    void invalidate_snapshot() const;
+    /// Resolve typed values from settings
+    std::shared_ptr<const SettingsSnapshot> build_snapshot() const;
+    /// Guards all_settings ( reads and changes ) and the state of writing
+    mutable std::mutex sync_mutex;
+    mutable std::condition_variable sync_condition;
+    /// Settings changed, but not written
+    mutable bool sync_pending = false;
+    /// Time to write delayed changes
+    mutable std::chrono::steady_clock::time_point sync_deadline;
+    std::chrono::milliseconds sync_delay{0};
+    /// Depth of nested beginUpdate
+    int update_depth = 0;
+    /// Background thread writing delayed changes
+    mutable std::thread sync_thread;
+    bool stop_sync_thread = false;
+
+    /// Settings changed: write them now or schedule writing
+    void settings_changed() const;
+    /// Write settings to file ( sync_mutex must be locked )
+    void write_settings() const;
+    /// Loop of background writing delayed changes
+    void sync_thread_loop() const;
+    /// Stop background thread
+    void stop_sync();
+
+    friend class SectionSettings;
+
     /// Read data from settings
     virtual void getDataFromPreferences();
 
@@ -261,6 +378,17 @@ private:
     std::set<std::shared_ptr<spdlog::logger>> module_loggers;
     std::set<std::string> linked_logger_names;
 
+    /// Thread pool of asynchronous logging ( nullptr - synchronous logging )
+    std::shared_ptr<spdlog::details::thread_pool> log_thread_pool;
+    /// Queue size and threads of the current async thread pool ( 0 - not created )
+    size_t async_queue_size = 0;
+    size_t async_threads_count = 0;
+    /// Drop the oldest messages if the queue of asynchronous logging is full
+    bool async_overrun = false;
+
+    /// Switch module loggers to synchronous or asynchronous mode defined by settings
+    void update_async_mode();
+
     /// Get the output level for module logger.
     /// @param module_name Name of the logger.
     spdlog::level::level_enum get_level(const std::string& module);
@@ -276,6 +404,30 @@ inline std::string common_section( const std::string& item )
     return   "common."+item;
 }
 
+/// Batch of settings changes into scope: the settings file is written once, when the batch is finished
+class SettingsUpdate
+{
+
+public:
+
+    /// Constructor, starts the batch
+    explicit SettingsUpdate( JsonioSettings& settings ):
+        io_settings( settings )
+    {
+        io_settings.beginUpdate();
+    }
+
+    /// Destructor, finishes the batch ( errors of writing are only logged )
+    ~SettingsUpdate();
+
+    SettingsUpdate( const SettingsUpdate& ) = delete;
+    SettingsUpdate& operator=( const SettingsUpdate& ) = delete;
+
+protected:
+
+    JsonioSettings& io_settings;
+};
+
 inline std::string jsonio_section( const std::string& item )
 {
     return   jsonio::JsonioSettings::jsonio_section_name+"."+item;
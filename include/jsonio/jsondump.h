@@ -76,6 +76,9 @@ std::string dump( const T& elems  )
     return genjson;
 }
 
+/// Write JSON text to stream without formatting spaces ( the text is not validated ).
+void minify( std::ostream& os, const std::string& jsonstr );
+
 ///  @brief Scan a string literal.
 ///  Back to dump escaped string.
 void undumpString( std::string& strvalue );
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <map>
+#include <string_view>
 #include "jsonio/jsonbase.h"
 
 namespace jsonio {
@@ -9,6 +11,7 @@ class JsonObjectBuilder;
 class JsonArrayBuilder;
 
 /// Class for read JsonBase structure from json string.
+/// The parser keeps a view of the text, the text must exist until the end of parsing.
 class JsonParser final
 {
 
@@ -17,13 +20,13 @@ class JsonParser final
 public:
 
     /// Constructor
-    explicit JsonParser( const std::string &jsondata ):jsontext()
+    explicit JsonParser( std::string_view jsondata ):jsontext()
     {
      set_string( jsondata );
     }
 
     /// Update string to parse.
-    void set_string( const std::string &jsondata )
+    void set_string( std::string_view jsondata )
     {
        jsontext = jsondata;
        cur_pos = 0;
@@ -36,7 +39,7 @@ public:
 protected:
 
     /// Internal string to parse
-    std::string jsontext;
+    std::string_view jsontext;
     std::size_t cur_pos{0};
     std::size_t end_pos{0};
 
@@ -55,4 +58,69 @@ protected:
 
 };
 
+
+/// Class for read values of selected fields from json string
+/// in one pass without building the JsonBase structure.
+/// Values are converted to strings the same way as JsonBase::get_value_via_path does for scalars.
+class JsonProjection final
+{
+
+public:
+
+    /// Value state after extraction
+    enum State
+    {
+        Missing = 0,    ///< No field into json data
+        Scalar = 1,     ///< The value is extracted
+        Structured = 2  ///< The field is object or array ( the full parse is needed )
+    };
+
+    /// Constructor
+    /// \param field_paths - list of field paths ( "a.b.0.c" or "a.b[0].c" )
+    explicit JsonProjection( const std::vector<std::string>& field_paths );
+
+    /// Number of fields
+    std::size_t size() const
+    {
+        return fields_count;
+    }
+
+    /// Extract values of the fields from json string.
+    /// \param values - values of fields ( empty for not scalar values )
+    /// \param states - state of each field
+    /// \return false if the json string could not be decoded by projection
+    bool extract( const std::string& jsondata, std::vector<std::string>& values, std::vector<State>& states ) const;
+
+protected:
+
+    /// Node of the fields paths tree
+    struct PathNode
+    {
+        /// Some field path ends here
+        bool is_field = false;
+        /// Next level names
+        std::map<std::string, std::size_t> children = {};
+    };
+
+    /// Fields paths tree, the first node is root
+    std::vector<PathNode> nodes;
+    /// Field paths could be mapped to the same node
+    std::vector<std::vector<std::size_t>> fields_by_node;
+    std::size_t fields_count = 0;
+
+    struct ExtractState
+    {
+        const std::string& text;
+        std::size_t pos;
+        std::vector<std::string>& values;
+        std::vector<State>& states;
+    };
+
+    bool extract_value( ExtractState& st, int node ) const;
+    bool skip_value( ExtractState& st ) const;
+    bool read_string( ExtractState& st, std::string* str ) const;
+    bool skip_space( ExtractState& st ) const;
+    void set_field( ExtractState& st, int node, State state, const std::string& value ) const;
+};
+
 } // namespace jsonio
@@ -4,6 +4,7 @@
 #include <memory>
 #include <functional>
 #include "jsonio/txt2file.h"
+#include "jsonio/file_stream.h"
 
 
 namespace jsonio {
@@ -316,7 +317,7 @@ using schema_files_t = std::map<std::string, std::string>;
 using schemas_t = std::map<std::string, std::shared_ptr<StructDef>>;
 using enums_t = std::map<std::string, std::shared_ptr<EnumDef>>;
 /// Factory method fetching schema definition from a json format strin
-using  SchemaReadFactory_f = std::function<void( const std::string& jsondata,
+using  SchemaReadFactory_f = std::function<void( std::string_view jsondata,
 schema_files_t& files, schemas_t& schemas,  enums_t& enums )>;
 
 
@@ -332,15 +333,15 @@ public:
         methods[schema_type] = method;
     }
 
-    /// Read schema description from json file file_path
+    /// Read schema description from json file file_path ( parsed straight from the mapped file )
     void addSchemaFile( const std::string& format_type, const std::string& file_path )
     {
-        auto json_data = read_ascii_file( file_path );
-        addSchemaFormat( format_type, json_data );
+        MappedFile file( file_path );
+        addSchemaFormat( format_type, file.view() );
     }
 
     /// Read schema description from json string
-    void addSchemaFormat( const std::string& format_type, const std::string& json_string )
+    void addSchemaFormat( const std::string& format_type, std::string_view json_string )
     {
         if(json_string.empty())
             return;
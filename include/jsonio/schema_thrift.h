@@ -144,7 +144,7 @@ public:
 
 /// Thrift schema definition
 /// Read thrift schema from json string
-void ThriftSchemaRead( const std::string& jsondata, schema_files_t& files,
+void ThriftSchemaRead( std::string_view jsondata, schema_files_t& files,
                        schemas_t& structs,  enums_t& enums );
 
 } // namespace jsonio
@@ -0,0 +1,230 @@
+#pragma once
+
+// https://stackoverflow.com/questions/27827923/c-object-pool-that-provides-items-as-smart-pointers-that-are-returned-to-pool !!!!
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stack>
+
+namespace jsonio {
+
+/// Usage and wait-time counters of the SharedPool.
+struct SharedPoolStatistics
+{
+    /// Maximum number of items the pool can hold
+    std::size_t max_size = 0;
+    /// Number of items created by the pool
+    std::size_t created = 0;
+    /// Number of items currently in use
+    std::size_t in_use = 0;
+    /// Number of successful get() calls
+    std::size_t acquired = 0;
+    /// Number of get() calls that had to wait for a free item
+    std::size_t waited = 0;
+    /// Total time spent waiting for a free item
+    std::chrono::microseconds total_wait = std::chrono::microseconds(0);
+    /// The longest single wait for a free item
+    std::chrono::microseconds max_wait = std::chrono::microseconds(0);
+
+    /// Average wait time over all get() calls
+    std::chrono::microseconds average_wait() const
+    {
+        if( acquired == 0 )
+            return std::chrono::microseconds(0);
+        return std::chrono::microseconds( total_wait.count()/static_cast<long long>(acquired) );
+    }
+};
+
+/// \class SharedPool bounded thread-safe pool of objects.
+/// Items are provided as smart pointers that are returned to the pool when released.
+/// New items are created on demand by the factory function until max_size is reached,
+/// after that get() waits until one of the items is returned.
+template <class T>
+class SharedPool
+{
+ private:
+
+    struct External_Deleter
+    {
+        explicit External_Deleter(std::weak_ptr<SharedPool<T>* > pool)
+            : pool_(pool) {}
+
+        void operator()(T* ptr)
+        {
+            if (auto pool_ptr = pool_.lock())
+            {
+                try {
+                    (*pool_ptr.get())->add(std::unique_ptr<T>{ptr});
+                    return;
+                } catch(...) {}
+            }
+            std::default_delete<T>{}(ptr);
+        }
+    private:
+        std::weak_ptr<SharedPool<T>* > pool_;
+    };
+
+ public:
+
+    using ptr_type = std::unique_ptr<T, External_Deleter >;
+    using factory_type = std::function<std::unique_ptr<T>()>;
+
+    /// Constructor
+    /// \param max_size - maximum number of items in the pool ( at least one )
+    /// \param factory - function to create a new item
+    explicit SharedPool( std::size_t max_size = 1,
+                         factory_type factory = [](){ return std::make_unique<T>(); } ):
+        this_ptr_(new SharedPool<T>*(this)), factory_(factory),
+        max_size_( max_size > 0 ? max_size : 1 )
+    {}
+
+    virtual ~SharedPool(){}
+
+    SharedPool( const SharedPool& ) = delete;
+    SharedPool& operator=( const SharedPool& ) = delete;
+
+    /// Get a free item, create a new one or wait until one is returned to the pool.
+    ptr_type get()
+    {
+        return get_item( nullptr );
+    }
+
+    /// Get a free item, create a new one or wait until one is returned to the pool
+    /// no longer than the timeout.
+    /// \return nullptr if no item was returned to the pool during the timeout
+    ptr_type try_get( std::chrono::milliseconds timeout )
+    {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        return get_item( &deadline );
+    }
+
+    /// Create items up to count in advance.
+    void reserve( std::size_t count )
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        while( created_ < max_size_ && created_ < count )
+        {
+            pool_.push( factory_() );
+            created_++;
+        }
+    }
+
+    /// Test for no free items into the pool.
+    bool empty() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return pool_.empty();
+    }
+
+    /// Number of free items into the pool.
+    size_t size() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return pool_.size();
+    }
+
+    /// Maximum number of items in the pool.
+    size_t max_size() const
+    {
+        return max_size_;
+    }
+
+    /// Get usage and wait-time counters.
+    SharedPoolStatistics statistics() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto stat = statistics_;
+        stat.max_size = max_size_;
+        stat.created = created_;
+        stat.in_use = in_use_;
+        return stat;
+    }
+
+    /// Reset wait-time counters.
+    void reset_statistics()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        statistics_ = SharedPoolStatistics();
+    }
+
+ private:
+
+    std::shared_ptr<SharedPool<T>* > this_ptr_;
+    std::stack<std::unique_ptr<T> > pool_;
+    factory_type factory_;
+    std::size_t max_size_;
+    std::size_t created_ = 0;
+    std::size_t in_use_ = 0;
+    SharedPoolStatistics statistics_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable condition_;
+
+    /// Get a free item ( wait until deadline if it is defined, nullptr - wait without limit )
+    ptr_type get_item( const std::chrono::steady_clock::time_point* deadline )
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if( pool_.empty() && created_ >= max_size_ )
+        {
+            auto start = std::chrono::steady_clock::now();
+            auto free_item = [this]{ return !pool_.empty() || created_ < max_size_; };
+            bool ready = true;
+            if( deadline )
+                ready = condition_.wait_until( lock, *deadline, free_item );
+            else
+                condition_.wait( lock, free_item );
+            auto wait_time = std::chrono::duration_cast<std::chrono::microseconds>(
+                        std::chrono::steady_clock::now() - start );
+            statistics_.waited++;
+            statistics_.total_wait += wait_time;
+            if( wait_time > statistics_.max_wait )
+                statistics_.max_wait = wait_time;
+            if( !ready )
+                return ptr_type( nullptr, External_Deleter{std::weak_ptr<SharedPool<T>*>{this_ptr_}} );
+        }
+
+        std::unique_ptr<T> item;
+        if( !pool_.empty() )
+        {
+            item = std::move( pool_.top() );
+            pool_.pop();
+        }
+        else
+        {
+            // create new item outside of the lock, the slot is reserved
+            created_++;
+            lock.unlock();
+            try {
+                item = factory_();
+            }
+            catch(...)
+            {
+                lock.lock();
+                created_--;
+                condition_.notify_one();
+                throw;
+            }
+            lock.lock();
+        }
+        statistics_.acquired++;
+        in_use_++;
+        return ptr_type( item.release(),
+                         External_Deleter{std::weak_ptr<SharedPool<T>*>{this_ptr_}} );
+    }
+
+    void add(std::unique_ptr<T> t)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            pool_.push(std::move(t));
+            in_use_--;
+        }
+        condition_.notify_one();
+    }
+
+};
+
+} // namespace jsonio
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace jsonio {
+
+/// \class ThreadPool bounded executor with a fixed number of worker threads.
+/// Tasks are executed in the order they were submitted.
+/// If the queue of waiting tasks is full, submit() blocks until a worker takes a task,
+/// so the number of requests in flight stays bounded.
+class ThreadPool
+{
+
+public:
+
+    /// Constructor
+    /// \param threads_count - number of worker threads ( at least one )
+    /// \param max_queue_size - maximum number of waiting tasks ( 0 - unlimited )
+    explicit ThreadPool( std::size_t threads_count, std::size_t max_queue_size = 0 );
+
+    /// Destructor, executes all submitted tasks and joins worker threads
+    ~ThreadPool();
+
+    ThreadPool( const ThreadPool& ) = delete;
+    ThreadPool& operator=( const ThreadPool& ) = delete;
+
+    /// Submit a task for execution.
+    /// \return future to get the result or the exception of the task
+    template <class F>
+    auto submit( F&& func ) -> std::future<std::invoke_result_t<std::decay_t<F>>>
+    {
+        using result_t = std::invoke_result_t<std::decay_t<F>>;
+        auto task = std::make_shared<std::packaged_task<result_t()>>( std::forward<F>(func) );
+        auto result = task->get_future();
+        push( [task]() { (*task)(); } );
+        return result;
+    }
+
+    /// Number of worker threads
+    std::size_t size() const
+    {
+        return workers.size();
+    }
+
+    /// Number of tasks submitted and not yet finished
+    std::size_t pending() const;
+
+    /// Wait until all submitted tasks are finished
+    void wait_all();
+
+protected:
+
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::size_t max_queue;
+    std::size_t active_tasks = 0;
+    bool stopping = false;
+
+    mutable std::mutex tasks_mutex;
+    std::condition_variable not_empty;
+    std::condition_variable not_full;
+    std::condition_variable all_done;
+
+    /// Add task to queue ( wait if queue is full )
+    void push( std::function<void()>&& task );
+
+    /// Worker thread loop
+    void worker_loop();
+};
+
+} // namespace jsonio
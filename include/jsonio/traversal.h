@@ -1,29 +1,173 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
 #include "jsonio/dbedgedoc.h"
 
 namespace jsonio {
 
-/// The function is executed for all vertexes and edges
+/// The function is executed for all vertexes and edges.
+/// The data is the document normalized by the schema of its _type and _label
+/// ( as DBVertexDocument::getJson() ), documents without loaded schema are passed as read.
 using  GraphElement_f = std::function<void( bool isVertex,  const std::string& data )>;
 
+class DBCollection;
+
+/// \class GraphSnapshot in-memory adjacency of graph in compressed sparse row format.
+/// Vertexes and edges are numbered, the outgoing and incoming edges of each vertex are stored
+/// as ranges of one array, so traversals and neighborhood queries need no database requests.
+/// The snapshot listens to changes of edge collections done through DBCollection:
+/// new and removed edges are kept as delta to the compressed arrays, which are rebuilt
+/// when the number of changes is large.
+class GraphSnapshot
+{
+
+public:
+
+    /// Minimum number of changes to rebuild compressed arrays
+    static std::size_t compact_min_changes;
+    /// Part of edges changed to rebuild compressed arrays
+    static double compact_changes_ratio;
+
+    /// Function to receive the vertex id and its depth from the start vertexes
+    using VisitVertex_f = std::function<void( const std::string& vertex_id, int depth )>;
+
+    /// Edge collections of graph ( defined from schemas or all edge collections of database )
+    static std::vector<std::string> edgeCollections( const DataBase& dbconnect );
+
+    /// Constructor, starts listening to changes of edge collections and reads their edges
+    /// \param edge_collections - edge collections of graph ( empty - edgeCollections() )
+    GraphSnapshot( const DataBase& dbconnect, const std::vector<std::string>& edge_collections = {} );
+
+    /// Destructor, stops listening
+    ~GraphSnapshot();
+
+    GraphSnapshot( const GraphSnapshot& ) = delete;
+    GraphSnapshot& operator=( const GraphSnapshot& ) = delete;
+
+    /// Reread all edges from database.
+    /// Changes of edges received while the database is read are applied over the read data.
+    void rebuild();
+
+    /// Number of vertexes linked by edges
+    std::size_t verticesCount() const;
+    /// Number of edges
+    std::size_t edgesCount() const;
+    /// Test the edge is into snapshot
+    bool containsEdge( const std::string& edge_id ) const;
+
+    /// Ids of edges linked to vertex
+    /// \param trav_type - GraphTraversal::trOut, GraphTraversal::trIn or GraphTraversal::trAll
+    std::vector<std::string> edges( const std::string& vertex_id, int trav_type ) const;
+    /// Ids of vertexes linked to vertex by edges
+    std::vector<std::string> neighbors( const std::string& vertex_id, int trav_type ) const;
+    /// Breadth-first traversal of vertexes by snapshot
+    /// \param max_depth - maximum number of edges from the start vertexes ( -1 - unlimited )
+    void traverse( const std::vector<std::string>& start_vertexes, int trav_type, int max_depth,
+                   VisitVertex_f visitor ) const;
+
+    /// Add or replace the edge
+    void addEdge( const std::string& edge_id, const std::string& from_id, const std::string& to_id );
+    /// Remove the edge
+    void removeEdge( const std::string& edge_id );
+
+protected:
+
+    /// Link of edge
+    struct EdgeLink
+    {
+        std::uint32_t from = 0;
+        std::uint32_t to = 0;
+        bool removed = false;
+    };
+
+    const DataBase& db_connect;
+    std::vector<std::string> collections_names;
+    /// Listened collections and ids of listeners
+    std::vector<std::pair<std::shared_ptr<DBCollection>, std::size_t>> listeners;
+
+    std::vector<std::string> vertex_ids;
+    std::unordered_map<std::string, std::uint32_t> vertex_index;
+    std::vector<std::string> edge_ids;
+    std::unordered_map<std::string, std::uint32_t> edge_index;
+    std::vector<EdgeLink> edge_links;
+
+    /// Compressed outgoing edges: edges of vertex v are out_edges[out_offsets[v]..out_offsets[v+1]]
+    std::vector<std::uint32_t> out_offsets;
+    std::vector<std::uint32_t> out_edges;
+    /// Compressed incoming edges
+    std::vector<std::uint32_t> in_offsets;
+    std::vector<std::uint32_t> in_edges;
+    /// Edges added after the compressed arrays were built
+    std::unordered_map<std::uint32_t, std::vector<std::uint32_t>> added_out;
+    std::unordered_map<std::uint32_t, std::vector<std::uint32_t>> added_in;
+    std::size_t changes_count = 0;
+    std::size_t removed_count = 0;
+
+    /// Changes of edges received while rebuild() reads the database ( replayed over the read edges )
+    std::vector<std::array<std::string, 3>> rebuild_changes;
+    bool rebuilding = false;
+
+    mutable std::shared_mutex snapshot_mutex;
+    /// Only one rebuild() at a time
+    std::mutex rebuild_mutex;
+
+    /// Number of the vertex ( added if not exist )
+    std::uint32_t vertex_number( const std::string& vertex_id );
+    /// Add edge ( snapshot_mutex must be locked )
+    void add_edge( const std::string& edge_id, const std::string& from_id, const std::string& to_id );
+    /// Remove edge ( snapshot_mutex must be locked )
+    void remove_edge( const std::string& edge_id );
+    /// Rebuild compressed arrays without removed edges ( snapshot_mutex must be locked )
+    void compact();
+    /// Rebuild compressed arrays if there are many changes ( snapshot_mutex must be locked )
+    void compact_if_needed();
+    /// Call the function for edges of vertex number and linked vertex numbers
+    void for_each_edge( std::uint32_t vertex, int trav_type,
+                        const std::function<void( std::uint32_t edge, std::uint32_t linked_vertex )>& func ) const;
+};
+
 /// \class GraphTraversal implementation traversal of graph  for Database.
+/// The graph is traversed in breadth-first order by levels: the vertexes of the level ( frontier )
+/// are read by one lookup request for each collection, the edges of the level by one AQL query
+/// for each edge collection, so the number of requests depends on the depth of graph, not on its size.
+/// Requests of one level are executed concurrently in the DataBase executor.
 class GraphTraversal
 {
+    const DataBase& db_connect;
     int trav_type = trAll;
-    std::set<std::string> vertex_list = {};
-    std::set<std::string> edge_list = {};
-    std::shared_ptr<DBVertexDocument> vertex_doc = nullptr;
-    std::shared_ptr<DBEdgeDocument> edge_doc = nullptr;
+    std::unordered_set<std::string> vertex_list = {};
+    std::unordered_set<std::string> edge_list = {};
+    /// Edge collections to traverse ( defined from schemas or all edge collections of database )
+    std::vector<std::string> edge_collections = {};
+    /// Adjacency snapshot used to find edges ( nullptr - edges are queried from database )
+    std::shared_ptr<GraphSnapshot> graph_snapshot = nullptr;
+
+    /// Visit levels of the graph started from the frontier vertexes
+    void traverse_levels( std::vector<std::string> frontier, GraphElement_f afunc, int max_depth );
 
-    /// Visit Vertex and all linked Edges
-    bool parseVertex( const std::string& idVertex, GraphElement_f afunc );
+    /// Visit edges and collect not visited linked vertexes into next_frontier
+    void visit_edges( const std::vector<std::string>& edges_data, GraphElement_f afunc,
+                      std::vector<std::string>& next_frontier );
 
-    /// Visit Edge and all linked Vertexes
-    bool parseEdge( const std::string& idEdge, GraphElement_f afunc  );
+    /// Read documents by ids ( grouped by collections from ids )
+    std::vector<std::string> read_documents( const std::vector<std::string>& ids ) const;
+
+    /// Read edges linked to vertexes by the traversal type
+    std::vector<std::string> read_edges( const std::vector<std::string>& vertexes ) const;
+
+    /// Execute requests concurrently and join results in order of requests
+    std::vector<std::string> execute_requests( const std::vector<std::function<std::vector<std::string>()>>& requests ) const;
 
 public:
 
+    /// Maximum number of ids into one request
+    static std::size_t batch_size;
+    /// Execute requests of one level concurrently
+    static bool parallel_requests;
+
     /// Types of Matrix table mode
     enum TRAVERCE_TYPES {
         trNo  = 0x0000,      ///< No edges
@@ -32,48 +176,60 @@ public:
         trAll = trIn|trOut   ///< Containing all vertexes
        };
 
+    /// Formats of the graph export file
+    enum EXPORT_FORMATS {
+        exJsonArray = 0,     ///< JSON array of documents
+        exJsonLines = 1      ///< One document per line ( NDJSON )
+       };
+
     /// Constructor
     /// Params are needed to define DataBase
     GraphTraversal( const DataBase& dbconnect );
 
     /// Graph Traversal started from one vertex or edge
-    void traversal( bool startFromVertex, const std::string& id, GraphElement_f afunc, int atravType = trAll )
+    /// \param max_depth - maximum number of edges from the start vertexes ( -1 - unlimited )
+    void traversal( bool startFromVertex, const std::string& id, GraphElement_f afunc,
+                    int atravType = trAll, int max_depth = -1 )
     {
-      trav_type  =atravType;
-      vertex_list.clear();
-      edge_list.clear();
-
-      if( startFromVertex )
-        parseVertex( id, afunc );
-      else
-        parseEdge( id, afunc );
+        Traversal( startFromVertex, std::vector<std::string>{ id }, afunc, atravType, max_depth );
     }
 
     ///  Graph Traversal started from list vertexes or edges
+    /// \param max_depth - maximum number of edges from the start vertexes ( -1 - unlimited ),
+    ///                    the vertexes of start edges are at depth 0
     void Traversal( bool startFromVertex, const std::vector<std::string>& ids,
-                    GraphElement_f afunc, int atravType = trAll )
+                    GraphElement_f afunc, int atravType = trAll, int max_depth = -1 );
+
+    /// Write vertexes and edges of the Graph Traversal to file without formatting spaces.
+    /// Documents are written while they are visited, so the graph is not kept in memory.
+    /// \param format - exJsonArray or exJsonLines
+    /// \return number of written documents
+    std::size_t exportGraph( const std::string& file_path, bool startFromVertex, const std::vector<std::string>& ids,
+                             int format = exJsonArray, int atravType = trAll, int max_depth = -1 );
+
+    /// Find edges of vertexes by the adjacency snapshot instead of database queries
+    /// ( nullptr - query edges from database )
+    void setSnapshot( std::shared_ptr<GraphSnapshot> snapshot )
     {
-      trav_type  = atravType;
-      vertex_list.clear();
-      edge_list.clear();
-
-      if( startFromVertex )
-      {
-          for(auto const &id : ids)
-             parseVertex( id, afunc );
-      }
-      else
-      {
-          for(auto const &id : ids)
-             parseEdge( id, afunc );
-      }
-      io_logger->info("Traverse {} vertexes and  {} edges ", vertex_list.size(), edge_list.size());
+        graph_snapshot = snapshot;
     }
 
-    /// Read graph from JSON file
+    /// Build the adjacency snapshot of edge collections and use it for traversals
+    std::shared_ptr<GraphSnapshot> buildSnapshot()
+    {
+        graph_snapshot = std::make_shared<GraphSnapshot>( db_connect );
+        return graph_snapshot;
+    }
+
+    /// Read graph from JSON array file.
+    /// The file is read by elements, records are saved into collections defined by the
+    /// _type and _label ( or the _id ) fields by batches of batch_size records,
+    /// batches are written concurrently in the DataBase executor if parallel_requests is set
+    /// ( batches of one collection are written in turn ).
+    /// Records are saved through DBVertexDocument/DBEdgeDocument of the schema of their label
+    /// ( as updateFromJson() ), records of labels without loaded schema are saved as read.
     void restoreGraphFromFile( const std::string& filePath );
 
 };
 
 } // namespace jsonio
-
@@ -1,6 +1,10 @@
 #pragma once
 
+#include <functional>
+#include <istream>
+#include <memory>
 #include "jsonio/jsonfree.h"
+#include "jsonio/file_stream.h"
 
 namespace jsonio {
 
@@ -8,7 +12,7 @@ namespace jsonio {
 /// Get all regular file names from the directory.
 list_names_t files_into_directory( const std::string& directory_path, const std::string& sample = "");
 
-/// Read whole ASCII file into string.
+/// Read whole ASCII file into string ( the file is read through MappedFile ).
 std::string read_ascii_file( const std::string& file_path );
 
 /// Generate path.
@@ -42,7 +46,8 @@ public:
 
     /// Possible text file formats.
     enum FileTypes {
-        Txt = 't', Json = 'j', Yaml = 'y',  XML = 'x'
+        Txt = 't', Json = 'j', Yaml = 'y',  XML = 'x',
+        JsonLines = 'l'   ///< Newline-delimited json ( one document per line )
     };
 
     /// This enum is used to describe the mode in which a device is opened
@@ -92,11 +97,24 @@ public:
     { return file_type;  }
 
 
+    /// Compression of file defined by extension ( ".gz", ".zst" )
+    Compression compression() const
+    { return compression_from_path( file_path ); }
+
+    /// Compression ratio and throughput of the last closed stream of file
+    const StreamStatistics& statistics() const
+    { return stream_statistics; }
+
     /// Read whole file into string.
     virtual std::string load_all() const;
 
 protected:
 
+    mutable StreamStatistics stream_statistics;
+
+    /// Keep and log statistics of closed stream
+    void set_statistics( const StreamStatistics& statistics ) const;
+
     std::string file_dir = "";
     std::string file_name = "";
     std::string file_ext = "";
@@ -136,6 +154,10 @@ public:
     /// Convert readed data to json string
     std::string load_json() const;
 
+    /// Save data to temporary file and replace the file by it,
+    /// so the file is never left partially written
+    void save_atomic( const JsonBase& object ) const;
+
 protected:
 
     /// Load data from json file to dom object
@@ -147,7 +169,63 @@ protected:
 };
 
 
-/// Class for read/write json arrays files
+/// Class for incremental reading of json array elements from stream.
+/// The stream is read by blocks, only the text of the current element is kept in memory.
+class JsonArrayReader
+{
+
+public:
+
+    /// Size of the block read from stream
+    static std::size_t block_size;
+
+    /// Constructor
+    explicit JsonArrayReader( std::istream& input_stream ):
+        input( input_stream )
+    {}
+
+    /// Read json text of the next element of array
+    /// \return false at the end of array
+    bool next( std::string& element );
+
+    /// Number of bytes read from stream
+    std::size_t bytesRead() const
+    {
+        return bytes_read;
+    }
+
+    /// Size of the stream data up to the end of the last read element
+    /// ( or up to the opening bracket if no elements were read )
+    std::size_t completeSize() const
+    {
+        return complete_size;
+    }
+
+protected:
+
+    std::istream& input;
+    std::string buffer = "";
+    std::size_t pos = 0;
+    std::size_t bytes_read = 0;
+    std::size_t complete_size = 0;
+    bool started = false;
+    bool finished = false;
+
+    /// Read next block from stream ( false at the end of stream )
+    bool read_block();
+    /// Skip spaces ( false at the end of stream )
+    bool skip_space();
+};
+
+/// Class for read/write json arrays files.
+/// In ReadOnly mode the file is read lazily by JsonArrayReader: each element is
+/// parsed straight into the target object, the whole array is never loaded.
+/// In WriteOnly mode each saved element is appended to the file through a buffered writer
+/// ( if stream write is not switched off ), the array is closed by Close().
+/// At checkpoints the closing bracket is written and the file is synchronized with the disk.
+/// The elements written after the checkpoint overwrite the bracket when the buffer of writer is full,
+/// so the plain file interrupted by a crash must be restored by recover(): it keeps all elements saved
+/// before the last checkpoint.
 class JsonArrayFile : public JsonFile
 {
 
@@ -172,14 +250,13 @@ public:
             Close();
     }
 
-    /// Copy constructor
-    JsonArrayFile(const JsonArrayFile &obj ) = default;
-    /// Move constructor
-    JsonArrayFile( JsonArrayFile &&obj ) = default;
-    /// Copy assignment
-    JsonArrayFile &operator =( const JsonArrayFile &other) = default;
-    /// Move assignment
-    JsonArrayFile &operator =( JsonArrayFile &&other) = default;
+    /// The opened file streams could not be shared
+    JsonArrayFile(const JsonArrayFile &obj ) = delete;
+    JsonArrayFile &operator =( const JsonArrayFile &other) = delete;
+    /// Move constructor ( the moved file is left closed )
+    JsonArrayFile( JsonArrayFile &&obj );
+    /// Move assignment ( this file is closed before, the moved file is left closed )
+    JsonArrayFile &operator =( JsonArrayFile &&other);
 
     /// Load next object data from file to dom object
     bool loadNext( JsonBase&  object );
@@ -196,9 +273,30 @@ public:
     virtual void Close();
     virtual void Open( OpenModeTypes amode );
 
+    /// Set mode of writing: stream elements to file ( default ) or
+    /// keep the whole array in memory and save it on Close() ( needed for getString() )
+    void setStreamWrite( bool stream_elements )
+    {
+        stream_write = stream_elements;
+    }
+
+    /// Set number of saved elements to make a checkpoint ( 0 - only on request )
+    void setCheckpoint( std::size_t elements_count )
+    {
+        checkpoint_elements = elements_count;
+    }
+
+    /// Close the array written at this moment and synchronize file with disk ( stream write mode )
+    void checkpoint();
+
+    /// Restore the plain file interrupted while writing: the file is truncated after
+    /// the last complete element and the array is closed ( the file must not be opened ).
+    /// \return number of elements into restored file
+    std::size_t recover();
+
     /// Load array from string ( do not need open file )
     virtual void loadString( const std::string& input_data );
-    /// Export internal data to string
+    /// Export internal data to string ( empty if elements were streamed to file )
     virtual std::string getString();
 
 protected:
@@ -206,6 +304,86 @@ protected:
     std::size_t loaded_ndx = 0;   ///< Current loaded
     JsonFree arr_object;
 
+    /// Opened file and reader of elements ( ReadOnly mode )
+    std::shared_ptr<FileReadStream> input_stream;
+    std::shared_ptr<JsonArrayReader> array_reader;
+    /// Text of the last read element
+    std::string element_text = "";
+
+    /// Buffered writer of elements ( WriteOnly mode )
+    std::shared_ptr<FileWriteStream> output_stream;
+    bool stream_write = true;
+    std::size_t checkpoint_elements = 0;
+
+};
+
+/// Class for read/write newline-delimited json files ( NDJSON, JSON Lines ).
+/// Each document is written densely into one line through a buffered stream.
+/// The whole file could be read by loadAll(): the file is split into chunks at newline
+/// boundaries and the chunks are parsed concurrently.
+class JsonLinesFile : public TxtFile
+{
+
+public:
+
+    /// Function to receive the parsed document
+    using Record_f = std::function<void( const JsonFree& record )>;
+
+    /// Size of the chunk parsed by one task of loadAll()
+    static std::size_t chunk_size;
+
+    /// Constructor
+    JsonLinesFile( const std::string& name, const std::string& ext, const std::string& dir=""):
+        TxtFile( name, ext, dir )
+    {
+        file_type = JsonLines;
+        open_mode = WriteOnly;
+    }
+    /// Constructor from path
+    JsonLinesFile( const std::string& path):
+        TxtFile( path )
+    {
+        file_type = JsonLines;
+        open_mode = WriteOnly;
+    }
+    /// Destructor
+    virtual ~JsonLinesFile()
+    {
+        if( is_opened )
+            Close();
+    }
+
+    /// The opened file streams could not be shared
+    JsonLinesFile(const JsonLinesFile &obj ) = delete;
+    JsonLinesFile &operator =( const JsonLinesFile &other) = delete;
+
+    /// Load next document from file to dom object
+    bool loadNext( JsonBase&  object );
+    /// Load next document from file to json string
+    bool loadNext( std::string& strjson );
+
+    /// Save next dom object to file
+    bool saveNext( const JsonBase&  object );
+    /// Save next json string to file ( formatting spaces are removed )
+    bool saveNext( const std::string& strjson );
+
+    virtual void Close();
+    virtual void Open( OpenModeTypes amode );
+
+    /// Parse all documents of file concurrently ( do not need open file ).
+    /// \param ordered - call func in order of documents into file, otherwise documents
+    ///                  are passed as soon as they are parsed ( calls of func are serialized )
+    /// \param threads_count - number of parsing threads ( 0 - hardware concurrency )
+    /// \return number of documents
+    std::size_t loadAll( Record_f func, bool ordered = true, std::size_t threads_count = 0 ) const;
+
+protected:
+
+    std::size_t loaded_ndx = 0;   ///< Number of loaded or saved documents
+    std::shared_ptr<FileReadStream> input_stream;
+    std::shared_ptr<FileWriteStream> output_stream;
+    std::string line_text = "";
+
 };
 
 
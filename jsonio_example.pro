@@ -61,6 +61,12 @@ win32:LIBS +=  -larango-cpp-static -llibcurl
 !win32:LIBS += -larango-cpp -lcurl
 LIBS +=   -lvelocypack
 
+# gzip compressed files
+!win32 {
+  DEFINES += JSONIO_WITH_ZLIB
+  LIBS += -lz
+}
+
 OBJECTS_DIR   = obj
 
 include($$JSONIO_DIR/jsonio.pri)
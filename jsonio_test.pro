@@ -43,6 +43,12 @@ INCLUDEPATH   += $$TESTS_DIR
 win32:LIBS +=  -larango-cpp-static
 !win32:LIBS += -larango-cpp
 
+# gzip compressed files
+!win32 {
+  DEFINES += JSONIO_WITH_ZLIB
+  LIBS += -lz
+}
+
 #unix:!macx-clang:LIBS += -lstdc++fs
 #win32:LIBS +=  -ljsonarango-static -llibcurl
 #!win32:LIBS += -ljsonarango -lcurl
@@ -57,6 +63,7 @@ HEADERS += \
         $$TESTS_DIR/example_schema.h \
         $$TESTS_DIR/tst_jsonio.h \
         $$TESTS_DIR/tst_service.h \
+        $$TESTS_DIR/tst_shared_pool.h \
         $$TESTS_DIR/tst_detail.h \
         $$TESTS_DIR/tst_dump.h   \
         $$TESTS_DIR/tst_base.h \
@@ -66,6 +73,12 @@ HEADERS += \
         $$TESTS_DIR/tst_base_complex.h \
         $$TESTS_DIR/tst_schema.h \
         $$TESTS_DIR/tst_jsonschema.h \
+        $$TESTS_DIR/tst_dbcache.h \
+        $$TESTS_DIR/tst_dbcursor.h \
+        $$TESTS_DIR/tst_dbdriverfile.h \
+        $$TESTS_DIR/tst_dbdrivermemory.h \
+        $$TESTS_DIR/tst_dbqueryresult.h \
+        $$TESTS_DIR/tst_traversal.h \
         $$TESTS_DIR/tst_dbquery.h
 
 SOURCES += \
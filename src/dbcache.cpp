@@ -0,0 +1,135 @@
+#include "jsonio/dbcache.h"
+
+namespace jsonio {
+
+std::size_t DocumentsCache::size() const
+{
+    std::lock_guard<std::mutex> g(cache_mutex);
+    return lru_list.size();
+}
+
+bool DocumentsCache::get( const std::string& key, JsonFree& document )
+{
+    std::lock_guard<std::mutex> g(cache_mutex);
+    auto itr = lru_index.find( key );
+    if( itr == lru_index.end() )
+    {
+        counters.misses++;
+        return false;
+    }
+    // move to front
+    lru_list.splice( lru_list.begin(), lru_list, itr->second );
+    document = itr->second->document;
+    counters.hits++;
+    return true;
+}
+
+std::string DocumentsCache::revision( const std::string& key ) const
+{
+    std::lock_guard<std::mutex> g(cache_mutex);
+    auto itr = lru_index.find( key );
+    if( itr == lru_index.end() )
+        return "";
+    return itr->second->revision;
+}
+
+void DocumentsCache::put( const std::string& key, const JsonBase& document )
+{
+    if( max_size_ == 0 )
+        return;
+
+    auto entry = make_entry( key, document );
+    std::lock_guard<std::mutex> g(cache_mutex);
+    insert( std::move(entry) );
+}
+
+bool DocumentsCache::put( const std::string& key, const JsonBase& document, std::uint64_t read_generation )
+{
+    if( max_size_ == 0 )
+        return false;
+
+    auto entry = make_entry( key, document );
+    std::lock_guard<std::mutex> g(cache_mutex);
+    // the document could be changed on the server while it was read
+    if( read_generation != invalidations_generation )
+        return false;
+    insert( std::move(entry) );
+    return true;
+}
+
+std::uint64_t DocumentsCache::generation() const
+{
+    std::lock_guard<std::mutex> g(cache_mutex);
+    return invalidations_generation;
+}
+
+void DocumentsCache::invalidate( const std::string& key )
+{
+    std::lock_guard<std::mutex> g(cache_mutex);
+    invalidations_generation++;
+    if( erase( key ) )
+        counters.invalidations++;
+}
+
+void DocumentsCache::outdated( const std::string& key )
+{
+    std::lock_guard<std::mutex> g(cache_mutex);
+    invalidations_generation++;
+    if( erase( key ) )
+        counters.outdated++;
+}
+
+void DocumentsCache::clear()
+{
+    std::lock_guard<std::mutex> g(cache_mutex);
+    invalidations_generation++;
+    lru_index.clear();
+    lru_list.clear();
+}
+
+DocumentsCacheStatistics DocumentsCache::statistics() const
+{
+    std::lock_guard<std::mutex> g(cache_mutex);
+    auto stat = counters;
+    stat.max_size = max_size_;
+    stat.size = lru_list.size();
+    return stat;
+}
+
+bool DocumentsCache::erase( const std::string& key )
+{
+    auto itr = lru_index.find( key );
+    if( itr == lru_index.end() )
+        return false;
+    lru_list.erase( itr->second );
+    lru_index.erase( itr );
+    return true;
+}
+
+void DocumentsCache::insert( CacheEntry&& entry )
+{
+    auto key = entry.key;
+    erase( key );
+    lru_list.push_front( std::move(entry) );
+    lru_index[key] = lru_list.begin();
+    while( lru_list.size() > max_size_ )
+    {
+        lru_index.erase( lru_list.back().key );
+        lru_list.pop_back();
+        counters.evictions++;
+    }
+}
+
+DocumentsCache::CacheEntry DocumentsCache::make_entry( const std::string& key, const JsonBase& document )
+{
+    CacheEntry entry{ key, "", JsonFree::object() };
+    document.get_value_via_path( "_rev", entry.revision, std::string("") );
+    auto free_document = dynamic_cast<const JsonFree*>( &document );
+    if( free_document )
+        entry.document = *free_document;
+    else
+        entry.document.loads( document.dump( true ) );
+    return entry;
+}
+
+} // namespace jsonio
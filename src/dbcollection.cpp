@@ -29,15 +29,48 @@ std::string make_template_key( const JsonBase& object, const std::vector<std::st
 // TDBCollection - This class contains the structure of Data Base Collection
 //-------------------------------------------------------------
 
+std::size_t DBCollection::load_batch_size = 1000;
+
 
 // Default configuration of the Data Base
 DBCollection::DBCollection(  const DataBase& adbconnect,
                              const std::string& name  ):
     coll_name( name ), db_connect(adbconnect),
-    documents_list(), key_record_map(),
-    keysmap_mutex(), documents_mutex()
+    documents_list(), key_record_map(), ids_index(),
+    keysmap_mutex(), documents_mutex(), documents_cache()
 { }
 
+void DBCollection::setDocumentsCache( std::size_t max_size, bool validate_revision )
+{
+    std::lock_guard<std::shared_mutex> g(keysmap_mutex);
+    if( max_size > 0 )
+        documents_cache = std::make_unique<DocumentsCache>( max_size );
+    else
+        documents_cache.reset();
+    validate_cache_revision = validate_revision;
+}
+
+DocumentsCacheStatistics DBCollection::cacheStatistics() const
+{
+    std::shared_lock<std::shared_mutex> g(keysmap_mutex);
+    if( documents_cache )
+        return documents_cache->statistics();
+    return DocumentsCacheStatistics();
+}
+
+std::size_t DBCollection::addChangesListener( DocumentChanged_f listener )
+{
+    std::lock_guard<std::shared_mutex> g(documents_mutex);
+    changes_listeners[++last_listener_id] = std::move( listener );
+    return last_listener_id;
+}
+
+void DBCollection::removeChangesListener( std::size_t listener_id )
+{
+    std::lock_guard<std::shared_mutex> g(documents_mutex);
+    changes_listeners.erase( listener_id );
+}
+
 
 // Open collection file and build linked record list
 void DBCollection::load()
@@ -48,6 +81,7 @@ void DBCollection::load()
 // Close file, clear key list
 void DBCollection::close()
 {
+    stop_loading();
     closeCollection();
 }
 
@@ -90,6 +124,7 @@ std::string DBCollection::generateOid( const std::string& key_template )
 
 bool DBCollection::existsDocument( const std::string &key ) const
 {
+    waitLoaded();
     //std::shared_lock<std::shared_mutex> g(keysmap_mutex);
     //std::lock_guard<std::shared_mutex> g(keysmap_mutex);
     std::shared_lock<std::shared_mutex> g(keysmap_mutex);
@@ -98,6 +133,7 @@ bool DBCollection::existsDocument( const std::string &key ) const
 
 std::string DBCollection::createDocument( JsonBase& data_object )
 {
+    waitLoaded();
     auto new_id = getKeyFrom( data_object );
 
     if( !new_id.empty() )
@@ -108,34 +144,70 @@ std::string DBCollection::createDocument( JsonBase& data_object )
         JSONIO_THROW_IF( existsDocument( new_id ), "DBCollection", 12,
                          " two records with the same key '" + new_id +"'." );
     }
+    std::string second;
+    // save record to data base ( the server rejects the same _key from parallel requests )
+    std::string ret_id = db_driver()->create_record( name(), second, data_object );
+    JSONIO_THROW_IF( ret_id.empty(), "DBCollection", 13," error saving record '" + new_id +"'." );
+    data_object.set_oid( ret_id );
+    new_id = getKeyFrom( data_object );
     {
         std::lock_guard<std::shared_mutex> g(keysmap_mutex);
-        std::string second;
-        // save record to data base
-        std::string ret_id = db_driver()->create_record( name(), second, data_object );
-        JSONIO_THROW_IF( ret_id.empty(), "DBCollection", 13," error saving record '" + new_id +"'." );
-        data_object.set_oid( ret_id );
-        new_id = getKeyFrom( data_object );
-        key_record_map[new_id] = std::move(second);
+        if( documents_cache )
+            documents_cache->invalidate( ret_id );
+        erase_key( new_id );
+        insert_key( new_id, std::move(second) );
     }
+
+    std::shared_lock<std::shared_mutex> g(documents_mutex);
+    for( auto itdoc:  documents_list)
+        itdoc->add_line( new_id, data_object, false );
+    for( const auto& listener: changes_listeners )
+        listener.second( new_id, &data_object );
     return new_id;
 }
 
 std::string DBCollection::createDocument( DBDocumentBase *document )
 {
-    io_logger->trace("DBCollection::createDocument {}", document->current_data().dump(false));
-    auto new_key = createDocument( document->current_data() );
-    document->add_line( new_key, document->current_data(), false );
-    return new_key;
+    if( io_logger->should_log( spdlog::level::trace ) )
+        io_logger->trace("DBCollection::createDocument {}", document->current_data().dump(false));
+    // the line of document is added with the other documents of collection
+    return createDocument( document->current_data() );
 }
 
 bool DBCollection::readDocument( JsonBase& data_object, const std::string &key )
 {
+    waitLoaded();
     std::shared_lock<std::shared_mutex> g(keysmap_mutex);
     auto itr = key_record_map.find(key);
     JSONIO_THROW_IF( itr==key_record_map.end(), "DBCollection", 14,
                       " record to retrive does not exist '" + key +"'." );
-    return db_driver()->read_record( name(), itr, data_object);
+    if( !documents_cache )
+        return db_driver()->read_record( name(), itr, data_object);
+
+    auto id = db_driver()->get_server_key( itr->second );
+    if( validate_cache_revision )
+    {
+        auto cached_revision = documents_cache->revision( id );
+        if( !cached_revision.empty() && cached_revision != server_revision( id ) )
+            documents_cache->outdated( id );
+    }
+
+    auto read_generation = documents_cache->generation();
+    auto cached_document = JsonFree::object();
+    if( documents_cache->get( id, cached_document ) )
+    {
+        auto free_object = dynamic_cast<JsonFree*>( &data_object );
+        if( free_object )
+            *free_object = std::move( cached_document );
+        else
+            data_object.loads( cached_document.dump( true ) );
+        return true;
+    }
+
+    auto ret = db_driver()->read_record( name(), itr, data_object);
+    if( ret )
+        documents_cache->put( id, data_object, read_generation );
+    return ret;
 }
 
 
@@ -147,6 +219,7 @@ void DBCollection::readDocument(DBDocumentBase *document, const std::string &key
 
 std::string DBCollection::updateDocument( const JsonBase& data_object )
 {
+    waitLoaded();
     std::string rec_id = "";
     auto key = getKeyFrom( data_object );
 
@@ -156,12 +229,19 @@ std::string DBCollection::updateDocument( const JsonBase& data_object )
         JSONIO_THROW_IF( itr==key_record_map.end(), "DBCollection", 16,
                          " record to update does not exist '" + key +"'." );
 
+        // invalidate also after the update: a concurrent reading could cache the old version before it
+        if( documents_cache )
+            documents_cache->invalidate( db_driver()->get_server_key( itr->second ) );
         rec_id = db_driver()->update_record( name(), itr, data_object );
+        if( documents_cache )
+            documents_cache->invalidate( db_driver()->get_server_key( itr->second ) );
     }
 
     std::shared_lock<std::shared_mutex> g(documents_mutex);
     for( auto itdoc:  documents_list)
         itdoc->update_line( rec_id, data_object );
+    for( const auto& listener: changes_listeners )
+        listener.second( rec_id, &data_object );
     return rec_id;
 }
 
@@ -183,54 +263,117 @@ std::string DBCollection::saveDocument( DBDocumentBase *document, const std::str
     auto rec_id = saveDocument( document->current_data(), key );
     JSONIO_THROW_IF( rec_id.empty(), "DBCollection", 17,
                       " error saving record '" + key +"'." );
-    document->add_line( rec_id, document->current_data(), true );
     return rec_id;
 }
 
 
 bool DBCollection::deleteDocument( const std::string &key )
 {
+    waitLoaded();
     bool rec_deleted = false;
     {
-        std::lock_guard<std::shared_mutex> g(keysmap_mutex);
+        std::shared_lock<std::shared_mutex> g(keysmap_mutex);
         auto itr = key_record_map.find(key);
         JSONIO_THROW_IF( itr==key_record_map.end(), "DBCollection", 18,
                          " record to delete does not exist '" + key +"'." );
 
+        auto id = db_driver()->get_server_key( itr->second );
+        if( documents_cache )
+            documents_cache->invalidate( id );
         rec_deleted = db_driver()->delete_record( name(), itr);
-        if( rec_deleted)
-            key_record_map.erase(itr);
+        if( documents_cache )
+            documents_cache->invalidate( id );
+    }
+    if( rec_deleted )
+    {
+        std::lock_guard<std::shared_mutex> g(keysmap_mutex);
+        erase_key( key );
     }
     if( rec_deleted )
     {
         std::shared_lock<std::shared_mutex> g(documents_mutex);
         for( auto itdoc:  documents_list)
             itdoc->delete_line( key );
+        for( const auto& listener: changes_listeners )
+            listener.second( key, nullptr );
     }
     return rec_deleted;
 }
 
 
+std::future<std::string> DBCollection::createDocumentAsync( std::shared_ptr<JsonBase> data_object )
+{
+    return executor().submit( [this, data_object]() {
+        return createDocument( *data_object );
+    });
+}
+
+std::future<bool> DBCollection::readDocumentAsync( std::shared_ptr<JsonBase> data_object, const std::string& key )
+{
+    return executor().submit( [this, data_object, key]() {
+        return readDocument( *data_object, key );
+    });
+}
+
+std::future<std::string> DBCollection::updateDocumentAsync( std::shared_ptr<const JsonBase> data_object )
+{
+    return executor().submit( [this, data_object]() {
+        return updateDocument( *data_object );
+    });
+}
+
+std::future<std::string> DBCollection::saveDocumentAsync( std::shared_ptr<JsonBase> data_object, const std::string& key )
+{
+    return executor().submit( [this, data_object, key]() {
+        return saveDocument( *data_object, key );
+    });
+}
+
+std::future<bool> DBCollection::deleteDocumentAsync( const std::string& key )
+{
+    return executor().submit( [this, key]() {
+        return deleteDocument( key );
+    });
+}
+
 void DBCollection::deleteDocument(DBDocumentBase *document)
 {
     auto key = document->getKeyFromCurrent();
     if( !deleteDocument( key ) )
         JSONIO_THROW( "DBCollection", 19, " deleting of record '" + key +"'." );
-    document->delete_line( key );
+    // the document got delete_line() with the other documents of collection
 }
 
 //-----------------------------------------------------------------
 
+namespace {
+/// Thrown from the keys query callback to stop loading
+struct load_cancelled {};
+}
+
 //  Other thread
 void DBCollection::loadCollectionFile(  const std::set<std::string>& query_fields )
 {
+    auto start = std::chrono::high_resolution_clock::now();
     try {
-        std::lock_guard<std::shared_mutex> g(keysmap_mutex);
+        std::vector<std::pair<std::string, std::string>> keys_batch;
+        keys_batch.reserve( load_batch_size );
         SetReadedKey_f setfnc = [&]( const std::string& jsondata, const std::string& keydata )
         {
-            add_record_to_map( jsondata, keydata );
+            if( loader_cancel )
+                throw load_cancelled();
+            std::string second;
+            db_driver()->set_server_key( second, keydata );
+            keys_batch.emplace_back( key_from_json( jsondata ), std::move(second) );
+            if( keys_batch.size() >= load_batch_size )
+                add_records_to_map( keys_batch );
         };
         db_driver()->all_query( name(), query_fields, setfnc );
+        add_records_to_map( keys_batch );
+    }
+    catch( load_cancelled& )
+    {
+        io_logger->info("loadCollectionFile {} cancelled after {} keys", name(), loaded_keys.load());
     }
     catch(jsonio::jsonio_exception& e)
     {
@@ -244,55 +387,172 @@ void DBCollection::loadCollectionFile(  const std::set<std::string>& query_field
     {
         io_logger->warn("Undefined loadCollectionFile exception");
     }
+
+    auto end = std::chrono::high_resolution_clock::now();
+    io_logger->info("Loaded {} keys of {} in {} ms", loaded_keys.load(), name(),
+                    std::chrono::duration_cast<std::chrono::milliseconds>(end-start).count());
+    {
+        std::lock_guard<std::mutex> g(loader_mutex);
+        loader_running = false;
+    }
+    loader_finished.notify_all();
 }
 
 void DBCollection::loadCollection()
 {
+    stop_loading();
     clear_keysmap();
     // create collection if no exist
     db_driver()->create_collection( name(), coll_type );
-    //loadCollectionFile( keyFields() );
     io_logger->info("Start loadCollection thread {}", name());
-    // Create a thread using member function
-    std::thread th( &DBCollection::loadCollectionFile, this,  keyFields() );
-    th.detach();
-    std::this_thread::sleep_for(std::chrono::microseconds(1)); // wait start thread
+    loader_cancel = false;
+    loaded_keys = 0;
+    loader_running = true;
+    loader_thread = std::thread( &DBCollection::loadCollectionFile, this,  keyFields() );
 }
 
+void DBCollection::waitLoaded() const
+{
+    std::unique_lock<std::mutex> g(loader_mutex);
+    loader_finished.wait( g, [this]{ return !loader_running; } );
+}
+
+void DBCollection::cancelLoading()
+{
+    loader_cancel = true;
+    waitLoaded();
+}
+
+void DBCollection::stop_loading()
+{
+    loader_cancel = true;
+    if( loader_thread.joinable() )
+        loader_thread.join();
+}
 
 // Gen new oid from key template
 std::string DBCollection::key_from_template( const std::string& key_template ) const
 {
+    waitLoaded();
     std::string id_head = name() + "/" + key_template;
+    std::shared_lock<std::shared_mutex> g(keysmap_mutex);
+    return key_template + ids_index.unique_suffix( id_head );
+}
 
-    auto ids_list = get_ids_as_template( id_head  );
-    if( ids_list.empty() )
-        return key_template;
+bool DBCollection::insert_key( const std::string& key, std::string&& second )
+{
+    auto it_new = key_record_map.emplace( key, std::move(second) );
+    if( it_new.second )
+        ids_index.insert( it_new.first->second );
+    return it_new.second;
+}
 
-    int ii=0;
-    while( ids_list.find( id_head + "_" + std::to_string(ii) ) != ids_list.end() )
-        ii++;
-    return key_template + "_" + std::to_string(ii);
+void DBCollection::erase_key( const std::string& key )
+{
+    auto itr = key_record_map.find( key );
+    if( itr != key_record_map.end() )
+    {
+        ids_index.erase( itr->second );
+        key_record_map.erase( itr );
+    }
 }
 
 
-void DBCollection::add_record_to_map( const std::string& jsondata, const std::string& keydata )
+std::string DBCollection::key_from_json( const std::string& jsondata )
 {
-    std::string second;
-    db_driver()->set_server_key(second, keydata);
-
+    if( keyFields() == std::set<std::string>{"_id"} )
+    {
+        // fast path, the key is the string value of _id
+        auto id_key = extract_string_json( "_id", jsondata );
+        trim( id_key );
+        if( !id_key.empty() )
+            return id_key;
+    }
     auto jsFree = json::loads( jsondata );
-    auto id_key = getKeyFrom( jsFree );
+    return getKeyFrom( jsFree );
+}
+
+void DBCollection::add_records_to_map( std::vector<std::pair<std::string, std::string>>& keys_batch )
+{
+    if( keys_batch.empty() )
+        return;
+    {
+        std::lock_guard<std::shared_mutex> g(keysmap_mutex);
+        for( auto& key_data: keys_batch )
+        {
+            // Test unique keys name before add the record(s)
+            if( !insert_key( key_data.first, std::move(key_data.second) ) )
+                JSONIO_THROW( "DBCollection", 20, " two records with the same key '" + key_data.first +"'." );
+        }
+    }
+    loaded_keys += keys_batch.size();
+    io_logger->debug("loadCollectionFile {}: {} keys", name(), loaded_keys.load());
+    keys_batch.clear();
+}
 
-    auto it_new =  key_record_map.insert( std::pair<std::string,std::string >(
-                                              id_key, std::move(second) ) );
-    // Test unique keys name before add the record(s)
-    if( it_new.second == false)
-        JSONIO_THROW( "DBCollection", 20, " two records with the same key '" + id_key +"'." );
+void DBCollection::deleteEdges( const std::string& vertexid )
+{
+    // collect the edges to be deleted
+    std::vector<std::string> edge_keys;
+    DBQueryBase edges_query( "FOR u IN " + name() + " FILTER u._from == @id OR u._to == @id RETURN { \"_id\": u._id }",
+                             DBQueryBase::qAQL );
+    auto bind_object = JsonFree::object();
+    bind_object.set_value_via_path( "id", vertexid );
+    edges_query.setBindVars( bind_object );
+    SetReaded_f setfnc = [&]( const std::string& jsondata )
+    {
+        edge_keys.push_back( key_from_json( jsondata ) );
+    };
+    db_driver()->select_query( name(), edges_query, setfnc );
+
+    db_driver()->delete_edges( name(), vertexid );
+    remove_keys( edge_keys );
+}
+
+void DBCollection::remove_keys( const std::vector<std::string>& rkeys )
+{
+    waitLoaded();
+    {
+        std::lock_guard<std::shared_mutex> g(keysmap_mutex);
+        for( const auto& key: rkeys )
+        {
+            auto itr = key_record_map.find( key );
+            if( itr == key_record_map.end() )
+                continue;
+            if( documents_cache )
+                documents_cache->invalidate( db_driver()->get_server_key( itr->second ) );
+            erase_key( key );
+        }
+    }
+
+    std::shared_lock<std::shared_mutex> g(documents_mutex);
+    for( auto itdoc:  documents_list)
+        itdoc->delete_lines( rkeys );
+    for( const auto& listener: changes_listeners )
+        for( const auto& key: rkeys )
+            listener.second( key, nullptr );
+}
+
+std::string DBCollection::server_revision( const std::string& id ) const
+{
+    std::string revision;
+    DBQueryBase rev_query( "FOR u IN " + name() + " FILTER u._id == @id RETURN { \"_rev\": u._rev }",
+                           DBQueryBase::qAQL );
+    auto bind_object = JsonFree::object();
+    bind_object.set_value_via_path( "id", id );
+    rev_query.setBindVars( bind_object );
+    SetReaded_f setfnc = [&revision]( const std::string& jsondata )
+    {
+        auto rev_object = json::loads( jsondata );
+        rev_object.get_value_via_path( "_rev", revision, std::string("") );
+    };
+    db_driver()->select_query( name(), rev_query, setfnc );
+    return revision;
 }
 
 std::vector<std::string> DBCollection::ids_from_keys(const std::vector<std::string> &rkeys) const
 {
+    waitLoaded();
     std::vector<std::string> ids;
     std::shared_lock<std::shared_mutex> g(keysmap_mutex);
 
@@ -308,15 +568,10 @@ std::vector<std::string> DBCollection::ids_from_keys(const std::vector<std::stri
 
 std::set<std::string> DBCollection::get_ids_as_template( const std::string& id_head ) const
 {
-    std::set<std::string> ids_list;
+    waitLoaded();
     std::shared_lock<std::shared_mutex> g(keysmap_mutex);
-    for( const auto& it: key_record_map )
-    {
-        if( !it.second.empty() )
-            if( it.second.substr(0, id_head.length()) == id_head  )
-                ids_list.insert( it.second );
-    }
-    return ids_list;
+    auto ids_list = ids_index.with_prefix( id_head );
+    return std::set<std::string>( ids_list.begin(), ids_list.end() );
 }
 
 bool DBCollection::is_allowed( const std::string &akey ) const
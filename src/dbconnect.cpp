@@ -3,6 +3,7 @@
 #include "jsonio/dbdriverarango.h"
 #include "jsonio/service.h"
 #include "jsonio/jsondump.h"
+#include "jsonio/io_settings.h"
 
 namespace jsonio {
 
@@ -12,6 +13,9 @@ datamap_t DataBase::edges = {};
 datamap_t DataBase::vertex_collections ={};
 datamap_t DataBase::edge_collections= {};
 std::vector<std::string> DataBase::all_edges_traverse ={};
+std::size_t DataBase::default_async_threads = 4;
+std::size_t DataBase::default_async_queue_size = 256;
+std::size_t DataBase::default_documents_cache_size = 0;
 //"inherits, takes, defines, master, product, prodreac, basis, pulls, involves, adds, yields";
 
 
@@ -62,7 +66,7 @@ void DataBase::update_from_schema( const schemas_t &schema_data )
 DataBase::DataBase(const std::string &db_url, const std::string &db_user,
                    const std::string &user_passwd, const std::string &db_name):
     current_driver(nullptr), collections_list(),
-    driver_mutex(), collections_mutex()
+    driver_mutex(), collections_mutex(), async_executor(nullptr), executor_mutex()
 {
     std::shared_ptr<AbstractDBDriver> db_driver(new ArangoDBClient(db_url, db_user, user_passwd, db_name));
     updateDriver(db_driver);
@@ -70,7 +74,7 @@ DataBase::DataBase(const std::string &db_url, const std::string &db_user,
 
 DataBase::DataBase():
     current_driver(nullptr), collections_list(),
-    driver_mutex(), collections_mutex()
+    driver_mutex(), collections_mutex(), async_executor(nullptr), executor_mutex()
 {
     // Default Constructor - extract data from settings
     std::shared_ptr<AbstractDBDriver> db_driver( new ArangoDBClient() );
@@ -78,7 +82,25 @@ DataBase::DataBase():
 }
 
 DataBase::~DataBase()
-{ }
+{
+    // finish all asynchronous requests
+    std::lock_guard<std::mutex> lock(executor_mutex);
+    async_executor.reset();
+}
+
+ThreadPool& DataBase::executor() const
+{
+    std::lock_guard<std::mutex> lock(executor_mutex);
+    if( !async_executor )
+    {
+        auto settings = ioSettings().snapshot();
+        auto threads = settings->async_threads.value_or( default_async_threads );
+        auto queue_size = settings->async_queue_size.value_or( default_async_queue_size );
+        async_executor = std::make_unique<ThreadPool>( threads, queue_size );
+        io_logger->debug("DataBase executor threads: {} queue: {}", threads, queue_size );
+    }
+    return *async_executor;
+}
 
 void DataBase::updateDriver( std::shared_ptr<AbstractDBDriver> db_driver )
 {
@@ -105,6 +127,9 @@ std::shared_ptr<DBCollection> DataBase::add_collection( const std::string& colna
 {
     auto col_ptr = std::shared_ptr<DBCollection>( new DBCollection( *this, colname) );
     col_ptr->coll_type = type;
+    auto settings = ioSettings().snapshot();
+    col_ptr->setDocumentsCache( settings->documents_cache_size.value_or( default_documents_cache_size ),
+                                settings->documents_cache_validate );
     col_ptr->load();
     {
         std::lock_guard lock(collections_mutex);
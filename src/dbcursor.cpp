@@ -0,0 +1,121 @@
+#include "jsonio/dbcursor.h"
+
+namespace jsonio {
+
+namespace {
+/// Thrown from the query callback to stop the cancelled query
+struct cursor_cancelled {};
+}
+
+DBQueryCursor::DBQueryCursor( producer_t producer, std::size_t abatch_size, std::size_t max_batches ):
+    batch_size( abatch_size > 0 ? abatch_size : 1 ),
+    max_buffered( batch_size * ( max_batches > 0 ? max_batches : 1 ) ),
+    buffer(), query_error()
+{
+    query_thread = std::thread( [this, producer]()
+    {
+        SetReaded_f setfnc = [this]( const std::string& jsondata )
+        {
+            std::unique_lock<std::mutex> lock(buffer_mutex);
+            not_full.wait( lock, [this]{ return buffer.size() < max_buffered || cancelled; } );
+            if( cancelled )
+                throw cursor_cancelled();
+            buffer.push_back( jsondata );
+            not_empty.notify_one();
+        };
+
+        try {
+            producer( setfnc );
+        }
+        catch( cursor_cancelled& )
+        { }
+        catch(...)
+        {
+            std::lock_guard<std::mutex> lock(buffer_mutex);
+            query_error = std::current_exception();
+        }
+        {
+            std::lock_guard<std::mutex> lock(buffer_mutex);
+            finished = true;
+        }
+        not_empty.notify_all();
+    });
+}
+
+DBQueryCursor::~DBQueryCursor()
+{
+    cancel();
+    if( query_thread.joinable() )
+        query_thread.join();
+}
+
+bool DBQueryCursor::next( std::string& jsondata )
+{
+    std::unique_lock<std::mutex> lock(buffer_mutex);
+    if( !wait_data( lock ) )
+        return false;
+    jsondata = std::move( buffer.front() );
+    buffer.pop_front();
+    fetched_count++;
+    lock.unlock();
+    not_full.notify_one();
+    return true;
+}
+
+values_t DBQueryCursor::nextBatch()
+{
+    values_t batch;
+    std::unique_lock<std::mutex> lock(buffer_mutex);
+    if( !wait_data( lock ) )
+        return batch;
+    // return the buffered documents, wait for the full batch only while the query is running
+    while( batch.size() < batch_size )
+    {
+        if( buffer.empty() )
+        {
+            not_full.notify_one();
+            not_empty.wait( lock, [this]{ return !buffer.empty() || finished; } );
+            if( buffer.empty() )
+                break;
+        }
+        batch.push_back( std::move( buffer.front() ) );
+        buffer.pop_front();
+        fetched_count++;
+    }
+    lock.unlock();
+    not_full.notify_one();
+    return batch;
+}
+
+bool DBQueryCursor::atEnd()
+{
+    std::unique_lock<std::mutex> lock(buffer_mutex);
+    not_empty.wait( lock, [this]{ return !buffer.empty() || finished; } );
+    return buffer.empty() && !query_error;
+}
+
+void DBQueryCursor::cancel()
+{
+    {
+        std::lock_guard<std::mutex> lock(buffer_mutex);
+        cancelled = true;
+        buffer.clear();
+    }
+    not_full.notify_all();
+}
+
+bool DBQueryCursor::wait_data( std::unique_lock<std::mutex>& lock )
+{
+    not_empty.wait( lock, [this]{ return !buffer.empty() || finished; } );
+    if( !buffer.empty() )
+        return true;
+    if( query_error )
+    {
+        auto error = query_error;
+        query_error = nullptr;
+        std::rethrow_exception( error );
+    }
+    return false;
+}
+
+} // namespace jsonio
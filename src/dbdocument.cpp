@@ -8,7 +8,8 @@ namespace jsonio {
 
 // Default configuration of the Data Base
 DBDocumentBase::DBDocumentBase( const DataBase& dbconnect, const std::string& collection_type, const std::string& collection_name  ):
-    collection_from(nullptr), query_result(nullptr), query_result_mutex()
+    collection_from(nullptr), query_result(nullptr), query_result_mutex(),
+    async_queue(), async_mutex(), async_idle(), refresh_thread(), refresh_mutex()
 {
     collection_from = dbconnect.collection( collection_name, collection_type  );
     collection_from->addDocument(this);
@@ -17,12 +18,89 @@ DBDocumentBase::DBDocumentBase( const DataBase& dbconnect, const std::string& co
 
 // Default configuration of the Data Base
 DBDocumentBase::DBDocumentBase( DBCollection* collection  ):
-    collection_from( collection ), query_result(nullptr), query_result_mutex()
+    collection_from( collection ), query_result(nullptr), query_result_mutex(),
+    async_queue(), async_mutex(), async_idle(), refresh_thread(), refresh_mutex()
 {
     collection_from->addDocument(this);
 }
 
 
+std::future<std::string> DBDocumentBase::createDocumentAsync( const std::string& key )
+{
+    std::string rid = key;
+    setOid( rid ); // add key _id to structure
+    before_save_update( rid );
+    auto data = current_data_copy();
+    auto collection = collection_from;
+    return submit_in_order( [this, collection, data]() {
+        auto new_key = collection->createDocument( *data );
+        after_save_update( new_key, *data );
+        return new_key;
+    });
+}
+
+std::future<std::string> DBDocumentBase::readDocumentAsync( const std::string& key )
+{
+    before_load( key );
+    auto collection = collection_from;
+    return submit_in_order( [collection, key]() {
+        auto data = JsonFree::object();
+        if( !collection->readDocument( data, key ) )
+            JSONIO_THROW( "DBCollection", 15, " error loading record '" + key +"'." );
+        return data.dump( true );
+    });
+}
+
+std::future<std::string> DBDocumentBase::updateDocumentAsync( const std::string& key )
+{
+    std::string rid = key;
+    setOid( rid ); // add key _id to structure
+    before_save_update( rid );
+    auto data = current_data_copy();
+    auto collection = collection_from;
+    return submit_in_order( [this, collection, data, rid]() {
+        auto saved_key = collection->saveDocument( *data, rid );
+        JSONIO_THROW_IF( saved_key.empty(), "DBCollection", 17, " error saving record '" + rid +"'." );
+        after_save_update( saved_key, *data );
+        return saved_key;
+    });
+}
+
+std::future<void> DBDocumentBase::deleteDocumentAsync( const std::string& key )
+{
+    auto collection = collection_from;
+    return submit_in_order( [this, collection, key]() {
+        before_remove( key );
+        collection->deleteDocument( key );
+        after_remove( key );
+    });
+}
+
+void DBDocumentBase::run_async_queue()
+{
+    while( true )
+    {
+        std::function<void()> request;
+        {
+            std::lock_guard<std::mutex> g(async_mutex);
+            if( async_queue.empty() )
+            {
+                async_running = false;
+                async_idle.notify_all();
+                return;
+            }
+            request = std::move( async_queue.front() );
+            async_queue.pop_front();
+        }
+        request();   // exceptions are stored into the future
+    }
+}
+
+std::shared_ptr<JsonFree> DBDocumentBase::current_data_copy() const
+{
+    return std::make_shared<JsonFree>( json::loads( current_data().dump( true ) ) );
+}
+
 void DBDocumentBase::setQuery( const DBQueryDef& querydef )
 {
     {
@@ -43,11 +121,46 @@ void DBDocumentBase::updateQuery()
             return;
     }
     io_logger->info("Start document {} update query: {}", collection_from->name(), query_result->condition().queryString());
-    //update_query();
-    // Create a thread using member function
-    std::thread th( &DBDocumentBase::update_query, this );
-    th.detach();
-    std::this_thread::sleep_for(std::chrono::microseconds(1)); // wait start thread
+
+    std::lock_guard<std::mutex> g(refresh_mutex);
+    if( refresh_stopped )
+        return;
+    refresh_pending = true;
+    if( refresh_running )
+        return;   // the running refresh executes the query again
+    if( refresh_thread.joinable() )
+        refresh_thread.join();  // the previous refresh is finished
+    refresh_running = true;
+    refresh_thread = std::thread( &DBDocumentBase::run_query_refresh, this );
+}
+
+void DBDocumentBase::run_query_refresh()
+{
+    while( true )
+    {
+        {
+            std::lock_guard<std::mutex> g(refresh_mutex);
+            if( !refresh_pending || refresh_stopped )
+            {
+                refresh_running = false;
+                return;
+            }
+            refresh_pending = false;
+        }
+        update_query();
+    }
+}
+
+void DBDocumentBase::stop_query_refresh()
+{
+    std::thread refresh;
+    {
+        std::lock_guard<std::mutex> g(refresh_mutex);
+        refresh_stopped = true;
+        refresh.swap( refresh_thread );
+    }
+    if( refresh.joinable() )
+        refresh.join();
 }
 
 
@@ -114,17 +227,59 @@ field_value_map_t DBDocumentBase::extract_fields(const std::vector<std::string>
     return extract_fields( queryFields, jsonFree );
 }
 
+JsonProjection DBDocumentBase::make_line_projection( const std::vector<std::string>& fields ) const
+{
+    auto paths = fields;
+    for( const auto& keyfld: collection_from->keyFields() )
+        paths.push_back( keyfld );
+    return JsonProjection( paths );
+}
+
+bool DBDocumentBase::project_line( const JsonProjection& projection, const std::string& jsondata, std::size_t fields_count,
+                                   const std::string* missing_value, std::string& key, values_t& values ) const
+{
+    std::vector<JsonProjection::State> states;
+    if( !projection.extract( jsondata, values, states ) )
+        return false;
+    for( std::size_t ii=0; ii<states.size(); ++ii )
+    {
+        if( states[ii] == JsonProjection::Structured )
+            return false;
+        if( states[ii] == JsonProjection::Missing )
+        {
+            if( !missing_value || ii >= fields_count )
+                return false;
+            values[ii] = *missing_value;
+        }
+    }
+    key.clear();
+    for( std::size_t ii=fields_count; ii<values.size(); ++ii )
+    {
+        trim( values[ii] );
+        key += values[ii];
+    }
+    values.resize( fields_count );
+    return true;
+}
+
 values_table_t DBDocumentBase::downloadDocuments(const DBQueryBase &query,
                                                  const std::vector<std::string> &queryFields) const
 {
     values_table_t records_values;
+    JsonProjection projection( queryFields );
+    const std::string missing_value;
 
     SetReaded_f setfnc = [&, queryFields]( const std::string& jsondata )
     {
-        auto flds_values = DBDocumentBase::extract_fields( queryFields, jsondata );
+        std::string key;
         values_t row_data;
-        for( const auto& fld: queryFields)
-            row_data.push_back( flds_values[fld] );
+        if( !project_line( projection, jsondata, queryFields.size(), &missing_value, key, row_data ) )
+        {
+            auto flds_values = DBDocumentBase::extract_fields( queryFields, jsondata );
+            row_data.clear();
+            for( const auto& fld: queryFields)
+                row_data.push_back( flds_values[fld] );
+        }
         records_values.push_back(row_data);
     };
 
@@ -136,13 +291,20 @@ values_table_t DBDocumentBase::downloadDocuments(const std::vector<std::string>
                                                  const std::vector<std::string> &queryFields) const
 {
     values_table_t records_values;
+    JsonProjection projection( queryFields );
+    const std::string missing_value;
 
     SetReaded_f setfnc = [&, queryFields]( const std::string& jsondata )
     {
-        auto flds_values = DBDocumentBase::extract_fields( queryFields, jsondata );
+        std::string key;
         values_t row_data;
-        for( const auto& fld: queryFields)
-            row_data.push_back( flds_values[fld] );
+        if( !project_line( projection, jsondata, queryFields.size(), &missing_value, key, row_data ) )
+        {
+            auto flds_values = DBDocumentBase::extract_fields( queryFields, jsondata );
+            row_data.clear();
+            for( const auto& fld: queryFields)
+                row_data.push_back( flds_values[fld] );
+        }
         records_values.push_back(row_data);
     };
 
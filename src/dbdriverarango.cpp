@@ -7,6 +7,9 @@
 
 namespace jsonio {
 
+std::size_t ArangoDBClient::default_pool_size = 4;
+std::chrono::milliseconds ArangoDBClient::cursor_connection_timeout = std::chrono::seconds(10);
+
 // Get settings data from ison section
 arangocpp::ArangoDBConnection getFromSettings( const SectionSettings& section, bool rootdata )
 {
@@ -37,7 +40,7 @@ arangocpp::ArangoDBConnection getFromSettings( const SectionSettings& section, b
 ArangoDBClient::ArangoDBClient():AbstractDBDriver()
 {
     arangocpp::ArangoDBConnection aconnect_data =
-            arangocpp::connectFromSettings( ioSettings().dump(), false );
+            arangocpp::connectFromSettings( ioSettings().snapshot()->settings_json, false );
     reset_db_connection( aconnect_data );
 }
 
@@ -62,7 +65,7 @@ AbstractDBDriver *ArangoDBClient::clone(const std::string &new_db_name)
 
 std::string ArangoDBClient::status() const
 {
-    return arando_db->getConnectMessage();
+    return arando_db()->getConnectMessage();
 }
 
 bool ArangoDBClient::connected() const
@@ -71,12 +74,38 @@ bool ArangoDBClient::connected() const
     return status_mess.find("server version") != std::string::npos;
 }
 
+SharedPool<arangocpp::ArangoDBCollectionAPI>::ptr_type ArangoDBClient::arando_db() const
+{
+    return arando_pool->get();
+}
+
+SharedPoolStatistics ArangoDBClient::pool_statistics() const
+{
+    return arando_pool->statistics();
+}
+
+SharedPoolStatistics ArangoDBClient::cursor_pool_statistics() const
+{
+    return arando_cursor_pool->statistics();
+}
+
 void ArangoDBClient::reset_db_connection( const arangocpp::ArangoDBConnection& aconnect_data )
 {
     try {
+        auto pool_size = ioSettings().snapshot()->db_pool_size.value_or( default_pool_size );
         arando_connect = std::make_shared<arangocpp::ArangoDBConnection>(aconnect_data);
-        arando_db = std::make_shared<arangocpp::ArangoDBCollectionAPI>(aconnect_data);
-        io_logger->debug("ArangoDBClient::reset_db_connection url: {}", arando_connect->fullHost() );
+        arando_pool = std::make_shared<SharedPool<arangocpp::ArangoDBCollectionAPI>>( pool_size,
+                         [aconnect_data]() {
+            return std::make_unique<arangocpp::ArangoDBCollectionAPI>(aconnect_data);
+        });
+        // the cursors connections are opened on demand
+        arando_cursor_pool = std::make_shared<SharedPool<arangocpp::ArangoDBCollectionAPI>>( pool_size,
+                         [aconnect_data]() {
+            return std::make_unique<arangocpp::ArangoDBCollectionAPI>(aconnect_data);
+        });
+        // the first connection is opened at once to report connection errors
+        arando_pool->reserve(1);
+        io_logger->debug("ArangoDBClient::reset_db_connection url: {} pool size: {}", arando_connect->fullHost(), pool_size );
     }
     catch(arangocpp::arango_exception& e)
     {
@@ -87,7 +116,7 @@ void ArangoDBClient::reset_db_connection( const arangocpp::ArangoDBConnection& a
 void ArangoDBClient::create_collection(const std::string& collname, const std::string& ctype)
 {
     try {
-        arando_db->createCollection( collname, ctype );
+        arando_db()->createCollection( collname, ctype );
 
     } catch(arangocpp::arango_exception& e)
     {
@@ -99,7 +128,7 @@ void ArangoDBClient::create_collection(const std::string& collname, const std::s
 std::set<std::string> ArangoDBClient::get_collections_names( CollTypes ctype )
 {
     try {
-        return arando_db->collectionNames( to_arrango_types( ctype ) );
+        return arando_db()->collectionNames( to_arrango_types( ctype ) );
 
     } catch(arangocpp::arango_exception& e)
     {
@@ -120,7 +149,7 @@ std::string ArangoDBClient::create_record(const std::string &collname,
                           " try to create document into read only mode." );
 
         auto  jsonrec = recdata.dump();
-        auto new_id =  arando_db->createDocument( collname, jsonrec);
+        auto new_id =  arando_db()->createDocument( collname, jsonrec);
         set_server_key( second, new_id );
         return new_id;
 
@@ -136,7 +165,7 @@ bool ArangoDBClient::read_record( const std::string& collname, keysmap_t::iterat
     try {
         std::string jsonrec;
         std::string rid = get_server_key( it->second );
-        auto ret =  arando_db->readDocument( collname, rid, jsonrec );
+        auto ret =  arando_db()->readDocument( collname, rid, jsonrec );
         recdata.loads(jsonrec);
         return ret;
 
@@ -151,7 +180,7 @@ bool ArangoDBClient::delete_record( const std::string& collname, keysmap_t::iter
 {
     try  {
         std::string rid = get_server_key( itr->second );
-        return arando_db->deleteDocument( collname, rid );
+        return arando_db()->deleteDocument( collname, rid );
 
     } catch(arangocpp::arango_exception& e)
     {
@@ -168,7 +197,7 @@ std::string ArangoDBClient::update_record( const std::string& collname, keysmap_
 
         auto  jsonrec = recdata.dump();
         std::string rid = get_server_key( it->second );
-        rid = arando_db->updateDocument( collname, rid, jsonrec );
+        rid = arando_db()->updateDocument( collname, rid, jsonrec );
         return rid;
 
     }  catch(arangocpp::arango_exception& e)
@@ -182,7 +211,23 @@ void ArangoDBClient::select_query( const std::string& collname, const DBQueryBas
 {
     try {
         auto arango_query = query.arando_query;
-        arando_db->selectQuery( collname,  *arango_query, setfnc );
+        arando_db()->selectQuery( collname,  *arango_query, setfnc );
+
+    } catch(arangocpp::arango_exception& e)
+    {
+        JSONIO_THROW( "ArangoDBClient", e.id, e.what() );
+    }
+}
+
+void ArangoDBClient::cursor_query( const std::string& collname, const DBQueryBase& query,  SetReaded_f setfnc )
+{
+    try {
+        auto arango_query = query.arando_query;
+        auto connection = arando_cursor_pool->try_get( cursor_connection_timeout );
+        JSONIO_THROW_IF( !connection, "ArangoDBClient", 4,
+                         " no free connection for the cursor, more than " +
+                         std::to_string( arando_cursor_pool->max_size() ) + " cursors are open." );
+        connection->selectQuery( collname,  *arango_query, setfnc );
 
     } catch(arangocpp::arango_exception& e)
     {
@@ -202,7 +247,7 @@ void ArangoDBClient::all_query( const std::string& collname, const std::set<std:
             for ( const auto& it : query_fields)
                 arango_query_fields[it] = it;
         }
-        arando_db->selectAll( collname, arango_query_fields, setfnc );
+        arando_db()->selectAll( collname, arango_query_fields, setfnc );
 
     } catch(arangocpp::arango_exception& e)
     {
@@ -216,7 +261,7 @@ void ArangoDBClient::delete_edges(const std::string& collname, const std::string
     try {
         JSONIO_THROW_IF( arando_connect->readonlyDBAccess(), "ArangoDBClient", 4,
                           " try to remove edge into read only mode." );
-        arando_db->removeEdges( collname, vertexid );
+        arando_db()->removeEdges( collname, vertexid );
 
     } catch(arangocpp::arango_exception& e)
     {
@@ -228,7 +273,7 @@ void ArangoDBClient::fpath_collect( const std::string& collname, const std::stri
                                     std::vector<std::string>& values )
 {
     try {
-        arando_db->collectQuery( collname, fpath, values);
+        arando_db()->collectQuery( collname, fpath, values);
 
     } catch(arangocpp::arango_exception& e)
     {
@@ -241,7 +286,7 @@ void ArangoDBClient::lookup_by_ids( const std::string& collname,  const std::vec
 {
     try {
         // we can use ids and keys
-        arando_db->lookupByKeys( collname, ids, setfnc);
+        arando_db()->lookupByKeys( collname, ids, setfnc);
 
     } catch(arangocpp::arango_exception& e)
     {
@@ -254,7 +299,7 @@ void ArangoDBClient::remove_by_ids( const std::string& collname,  const std::vec
     try {
         JSONIO_THROW_IF( arando_connect->readonlyDBAccess(), "ArangoDBClient", 5,
                           " to remove documents into read only mode." );
-        arando_db->removeByKeys( collname, ids );
+        arando_db()->removeByKeys( collname, ids );
 
     } catch(arangocpp::arango_exception& e)
     {
@@ -266,7 +311,7 @@ std::string ArangoDBClient::sanitization(const std::string &documentHandle)
 {
     try {
 
-        return  arando_db->sanitization(documentHandle);
+        return  arando_db()->sanitization(documentHandle);
 
     } catch(arangocpp::arango_exception& e)
     {
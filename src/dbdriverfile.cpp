@@ -0,0 +1,724 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#ifdef _WIN32
+#include  <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "jsonio/dbdriverfile.h"
+#include "jsonio/dbquerymatcher.h"
+#include "jsonio/io_settings.h"
+#include "jsonio/jsonfree.h"
+#include "jsonio/jsondump.h"
+
+#include <filesystem>
+namespace fs = std::filesystem;
+
+namespace jsonio {
+
+std::size_t FileSegmentsStore::segment_max_size = 64*1024*1024;
+std::size_t FileSegmentsStore::compact_min_size = 16*1024*1024;
+bool FileSegmentsStore::sync_writes = false;
+
+std::string FileDBClient::default_directory = "./localdb";
+std::string FileDBClient::default_database = "jsonio";
+std::size_t FileDBClient::scan_batch_size = 1000;
+
+namespace {
+
+const std::uint32_t record_magic = 0x4753494a;
+const char put_operation = 'P';
+const char delete_operation = 'D';
+
+/// Header of the record into segment file, followed by _id and json data
+struct RecordHeader
+{
+    std::uint32_t magic;
+    std::uint32_t operation;
+    std::uint32_t id_size;
+    std::uint32_t data_size;
+};
+
+std::size_t record_size( std::size_t id_size, std::size_t data_size )
+{
+    return sizeof(RecordHeader) + id_size + data_size;
+}
+
+std::string segment_file_name( const std::string& collname, std::size_t number )
+{
+    auto snumber = std::to_string( number );
+    return collname + "." + std::string( snumber.size() < 6 ? 6-snumber.size() : 0, '0' ) + snumber + ".seg";
+}
+
+/// Get number of segment from file name <collname>.<number>.seg
+bool segment_number( const std::string& file_name, const std::string& collname, std::size_t& number )
+{
+    const std::string extension = ".seg";
+    if( file_name.size() <= collname.size()+1+extension.size() ||
+            file_name.compare( 0, collname.size()+1, collname+"." ) != 0 ||
+            file_name.compare( file_name.size()-extension.size(), extension.size(), extension ) != 0 )
+        return false;
+    auto snumber = file_name.substr( collname.size()+1, file_name.size()-collname.size()-1-extension.size() );
+    if( snumber.empty() || !std::all_of( snumber.begin(), snumber.end(), ::isdigit ) )
+        return false;
+    number = std::stoul( snumber );
+    return true;
+}
+
+std::size_t page_rounded( std::size_t size )
+{
+    const std::size_t page_size = 64*1024;
+    return ( size + page_size - 1 ) / page_size * page_size;
+}
+
+} // namespace
+
+//---------------------------------------------------------------------------------------
+
+FileSegmentsStore::FileSegmentsStore( const std::string& directory, const std::string& collname ):
+    directory_path( directory ), collection_name( collname )
+{
+    fs::create_directories( directory_path );
+    open_segments();
+}
+
+FileSegmentsStore::~FileSegmentsStore()
+{
+    for( auto& segment: segments )
+        close_segment( *segment );
+}
+
+std::size_t FileSegmentsStore::size() const
+{
+    std::shared_lock<std::shared_mutex> g(store_mutex);
+    return primary_index.size();
+}
+
+bool FileSegmentsStore::exists( const std::string& id ) const
+{
+    std::shared_lock<std::shared_mutex> g(store_mutex);
+    return primary_index.find( id ) != primary_index.end();
+}
+
+bool FileSegmentsStore::get( const std::string& id, std::string& jsondata ) const
+{
+    std::shared_lock<std::shared_mutex> g(store_mutex);
+    auto itr = primary_index.find( id );
+    if( itr == primary_index.end() )
+        return false;
+    jsondata = document_data( itr->second );
+    return true;
+}
+
+bool FileSegmentsStore::insert( const std::string& id, const std::string& jsondata )
+{
+    std::lock_guard<std::shared_mutex> g(store_mutex);
+    if( primary_index.find( id ) != primary_index.end() )
+        return false;
+    primary_index[id] = append_record( segments, put_operation, id, jsondata );
+    live_bytes += record_size( id.size(), jsondata.size() );
+    return true;
+}
+
+void FileSegmentsStore::put( const std::string& id, const std::string& jsondata )
+{
+    std::lock_guard<std::shared_mutex> g(store_mutex);
+    auto location = append_record( segments, put_operation, id, jsondata );
+    auto itr = primary_index.find( id );
+    if( itr != primary_index.end() )
+    {
+        auto old_size = record_size( id.size(), itr->second.size );
+        live_bytes -= old_size;
+        dead_bytes += old_size;
+        itr->second = location;
+    }
+    else
+        primary_index[id] = location;
+    live_bytes += record_size( id.size(), jsondata.size() );
+    compact_if_needed();
+}
+
+bool FileSegmentsStore::remove( const std::string& id )
+{
+    return remove( std::vector<std::string>{ id } ) > 0;
+}
+
+std::size_t FileSegmentsStore::remove( const std::vector<std::string>& ids )
+{
+    std::size_t removed = 0;
+    std::lock_guard<std::shared_mutex> g(store_mutex);
+    for( const auto& id: ids )
+    {
+        auto itr = primary_index.find( id );
+        if( itr == primary_index.end() )
+            continue;
+        append_record( segments, delete_operation, id, "" );
+        auto old_size = record_size( id.size(), itr->second.size );
+        live_bytes -= old_size;
+        dead_bytes += old_size + record_size( id.size(), 0 );
+        primary_index.erase( itr );
+        removed++;
+    }
+    compact_if_needed();
+    return removed;
+}
+
+std::vector<std::string> FileSegmentsStore::ids() const
+{
+    std::vector<std::pair<Location, const std::string*>> locations;
+    std::vector<std::string> ids_list;
+    std::shared_lock<std::shared_mutex> g(store_mutex);
+    locations.reserve( primary_index.size() );
+    for( const auto& item: primary_index )
+        locations.emplace_back( item.second, &item.first );
+    std::sort( locations.begin(), locations.end(), []( const auto& left, const auto& right )
+    {
+        return std::tie( left.first.segment, left.first.offset ) < std::tie( right.first.segment, right.first.offset );
+    });
+    ids_list.reserve( locations.size() );
+    for( const auto& item: locations )
+        ids_list.push_back( *item.second );
+    return ids_list;
+}
+
+void FileSegmentsStore::read( const std::vector<std::string>& ids,
+                              const std::function<void( const std::string&, std::string_view )>& visitor ) const
+{
+    std::shared_lock<std::shared_mutex> g(store_mutex);
+    for( const auto& id: ids )
+    {
+        auto itr = primary_index.find( id );
+        if( itr != primary_index.end() )
+            visitor( id, document_data( itr->second ) );
+    }
+}
+
+void FileSegmentsStore::compact()
+{
+    std::lock_guard<std::shared_mutex> g(store_mutex);
+    compact_segments();
+}
+
+void FileSegmentsStore::flush()
+{
+#ifndef _WIN32
+    std::shared_lock<std::shared_mutex> g(store_mutex);
+    for( auto& segment: segments )
+        ::fsync( segment->fd );
+#endif
+}
+
+void FileSegmentsStore::open_segments()
+{
+    std::vector<std::pair<std::size_t, std::string>> segment_files;
+    for( const auto& entry: fs::directory_iterator( directory_path ) )
+    {
+        std::size_t number;
+        if( entry.is_regular_file() && segment_number( entry.path().filename().string(), collection_name, number ) )
+            segment_files.emplace_back( number, entry.path().string() );
+    }
+    std::sort( segment_files.begin(), segment_files.end() );
+
+    for( std::size_t ii=0; ii<segment_files.size(); ++ii )
+    {
+        auto segment = std::make_unique<Segment>();
+        segment->number = segment_files[ii].first;
+        segment->path = segment_files[ii].second;
+        segment->size = fs::file_size( segment->path );
+#ifndef _WIN32
+        segment->fd = ::open( segment->path.c_str(), O_RDWR | O_APPEND );
+        JSONIO_THROW_IF( segment->fd < 0, "FileSegmentsStore", 1, " could not open segment file " + segment->path );
+#endif
+        bool is_last = ( ii == segment_files.size()-1 );
+        map_segment( *segment, is_last ? std::max( segment->size, segment_max_size ) : segment->size );
+        last_segment_number = segment->number;
+        segments.push_back( std::move(segment) );
+        scan_segment( ii, is_last );
+    }
+    io_logger->debug("FileSegmentsStore {}: {} documents into {} segments", collection_name, primary_index.size(), segments.size() );
+}
+
+void FileSegmentsStore::scan_segment( std::size_t segment_ndx, bool is_last )
+{
+    auto& segment = *segments[segment_ndx];
+    const char* data = document_data( Location{ segment_ndx, 0, 0 } ).data();
+    std::size_t offset = 0;
+    while( offset + sizeof(RecordHeader) <= segment.size )
+    {
+        RecordHeader header;
+        std::memcpy( &header, data+offset, sizeof(RecordHeader) );
+        if( header.magic != record_magic || ( header.operation != put_operation && header.operation != delete_operation ) )
+            break;
+        auto next_offset = offset + record_size( header.id_size, header.data_size );
+        if( next_offset > segment.size )
+            break;
+
+        std::string id( data+offset+sizeof(RecordHeader), header.id_size );
+        auto itr = primary_index.find( id );
+        if( itr != primary_index.end() )
+        {
+            auto old_size = record_size( id.size(), itr->second.size );
+            live_bytes -= old_size;
+            dead_bytes += old_size;
+        }
+        if( header.operation == put_operation )
+        {
+            primary_index[id] = Location{ segment_ndx, offset+sizeof(RecordHeader)+header.id_size, header.data_size };
+            live_bytes += record_size( header.id_size, header.data_size );
+        }
+        else
+        {
+            if( itr != primary_index.end() )
+                primary_index.erase( itr );
+            dead_bytes += record_size( header.id_size, header.data_size );
+        }
+        offset = next_offset;
+    }
+
+    if( offset < segment.size )
+    {
+        io_logger->warn("FileSegmentsStore {}: broken record into {} at {}", collection_name, segment.path, offset );
+        if( is_last )
+        {
+            // interrupted write, the rest of file is discarded
+            fs::resize_file( segment.path, offset );
+#ifdef _WIN32
+            segment.buffer.resize( offset );
+#endif
+        }
+        segment.size = offset;
+    }
+}
+
+FileSegmentsStore::Location FileSegmentsStore::append_record( std::vector<std::unique_ptr<Segment>>& segments_list,
+                                                              char operation, const std::string& id, std::string_view jsondata )
+{
+    auto full_size = record_size( id.size(), jsondata.size() );
+    if( segments_list.empty() || segments_list.back()->size + full_size > segments_list.back()->capacity ||
+            ( segments_list.back()->size > 0 && segments_list.back()->size + full_size > segment_max_size ) )
+        segments_list.push_back( new_segment( ++last_segment_number, std::max( full_size, segment_max_size ) ) );
+    auto& segment = *segments_list.back();
+
+    RecordHeader header{ record_magic, static_cast<std::uint32_t>(operation),
+                static_cast<std::uint32_t>(id.size()), static_cast<std::uint32_t>(jsondata.size()) };
+    std::string record( reinterpret_cast<const char*>(&header), sizeof(RecordHeader) );
+    record += id;
+    record += jsondata;
+
+#ifdef _WIN32
+    std::ofstream fout( segment.path, std::ios::binary | std::ios::app );
+    fout.write( record.data(), record.size() );
+    if( !fout.good() )
+    {
+        fout.close();
+        std::error_code ec;
+        fs::resize_file( segment.path, segment.size, ec );
+        if( ec )
+            segment.size = segment.capacity;
+        JSONIO_THROW( "FileSegmentsStore", 2, " error writing segment file " + segment.path );
+    }
+    segment.buffer += record;
+#else
+    std::size_t written = 0;
+    while( written < record.size() )
+    {
+        auto result = ::write( segment.fd, record.data()+written, record.size()-written );
+        if( result < 0 && errno == EINTR )
+            continue;
+        if( result <= 0 )
+        {
+            // discard the torn record, the next record must start at segment.size
+            if( ::ftruncate( segment.fd, static_cast<off_t>(segment.size) ) != 0 )
+            {
+                io_logger->error("FileSegmentsStore {}: could not truncate {} after failed write", collection_name, segment.path );
+                segment.size = segment.capacity;  // the segment is sealed, the next record starts new segment
+            }
+            JSONIO_THROW( "FileSegmentsStore", 2, " error writing segment file " + segment.path );
+        }
+        written += static_cast<std::size_t>(result);
+    }
+    if( sync_writes )
+        ::fsync( segment.fd );
+#endif
+
+    Location location{ segments_list.size()-1, segment.size+sizeof(RecordHeader)+id.size(), jsondata.size() };
+    segment.size += full_size;
+    return location;
+}
+
+std::unique_ptr<FileSegmentsStore::Segment> FileSegmentsStore::new_segment( std::size_t number, std::size_t capacity )
+{
+    auto segment = std::make_unique<Segment>();
+    segment->number = number;
+    segment->path = ( fs::path( directory_path ) / segment_file_name( collection_name, number ) ).string();
+#ifdef _WIN32
+    std::ofstream fout( segment->path, std::ios::binary | std::ios::trunc );
+    JSONIO_THROW_IF( !fout.good(), "FileSegmentsStore", 1, " could not create segment file " + segment->path );
+#else
+    segment->fd = ::open( segment->path.c_str(), O_RDWR | O_APPEND | O_CREAT | O_TRUNC, 0644 );
+    JSONIO_THROW_IF( segment->fd < 0, "FileSegmentsStore", 1, " could not create segment file " + segment->path );
+#endif
+    map_segment( *segment, capacity );
+    return segment;
+}
+
+void FileSegmentsStore::map_segment( Segment& segment, std::size_t capacity )
+{
+#ifdef _WIN32
+    // memory mapping is not used, the segment data is read to buffer
+    std::ifstream fin( segment.path, std::ios::binary );
+    std::stringstream buffer;
+    buffer << fin.rdbuf();
+    segment.buffer = buffer.str();
+    segment.capacity = capacity;
+#else
+    segment.capacity = page_rounded( capacity );
+    if( segment.capacity == 0 )
+        return;
+    // the mapping could be greater than file, records appended to the file are visible through the mapping
+    void* data = ::mmap( nullptr, segment.capacity, PROT_READ, MAP_SHARED, segment.fd, 0 );
+    JSONIO_THROW_IF( data == MAP_FAILED, "FileSegmentsStore", 3, " could not map segment file " + segment.path );
+    segment.data = static_cast<char*>( data );
+#endif
+}
+
+void FileSegmentsStore::close_segment( Segment& segment )
+{
+#ifndef _WIN32
+    if( segment.data )
+        ::munmap( segment.data, segment.capacity );
+    if( segment.fd >= 0 )
+        ::close( segment.fd );
+    segment.data = nullptr;
+    segment.fd = -1;
+#endif
+}
+
+std::string_view FileSegmentsStore::document_data( const Location& location ) const
+{
+    const auto& segment = *segments[location.segment];
+#ifdef _WIN32
+    return std::string_view( segment.buffer.data()+location.offset, location.size );
+#else
+    return std::string_view( segment.data+location.offset, location.size );
+#endif
+}
+
+void FileSegmentsStore::compact_if_needed()
+{
+    if( dead_bytes >= compact_min_size && dead_bytes > live_bytes )
+        compact_segments();
+}
+
+void FileSegmentsStore::compact_segments()
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<std::pair<Location, const std::string*>> locations;
+    locations.reserve( primary_index.size() );
+    for( const auto& item: primary_index )
+        locations.emplace_back( item.second, &item.first );
+    std::sort( locations.begin(), locations.end(), []( const auto& left, const auto& right )
+    {
+        return std::tie( left.first.segment, left.first.offset ) < std::tie( right.first.segment, right.first.offset );
+    });
+
+    // actual documents are written to new segments
+    std::vector<std::unique_ptr<Segment>> new_segments;
+    std::unordered_map<std::string, Location> new_index;
+    new_index.reserve( primary_index.size() );
+    for( const auto& item: locations )
+        new_index[*item.second] = append_record( new_segments, put_operation, *item.second, document_data( item.first ) );
+#ifndef _WIN32
+    for( auto& segment: new_segments )
+        ::fsync( segment->fd );
+#endif
+
+    // old segments are removed from the first, so the rest always replays to the same state
+    for( auto& segment: segments )
+    {
+        close_segment( *segment );
+        fs::remove( segment->path );
+    }
+    auto old_count = segments.size();
+    segments = std::move( new_segments );
+    primary_index = std::move( new_index );
+    dead_bytes = 0;
+
+    auto end = std::chrono::high_resolution_clock::now();
+    io_logger->info("FileSegmentsStore {} compacted {} segments to {} in {} ms", collection_name, old_count, segments.size(),
+                    std::chrono::duration_cast<std::chrono::milliseconds>(end-start).count());
+}
+
+//---------------------------------------------------------------------------------------
+
+FileDBClient::FileDBClient():
+    FileDBClient( ioSettings().directoryPath( jsonio_section("LocalDBDirectory"), default_directory ),
+                  ioSettings().value<std::string>( jsonio_section("LocalDBName"), default_database ) )
+{}
+
+FileDBClient::FileDBClient( const std::string& db_directory, const std::string& db_name ):
+    LocalDBDriver(), directory_path( db_directory ), database_name( db_name ),
+    database_path( ( fs::path( db_directory ) / db_name ).string() ),
+    last_tick( static_cast<std::uint64_t>( std::chrono::duration_cast<std::chrono::microseconds>(
+                                               std::chrono::system_clock::now().time_since_epoch() ).count() ) )
+{
+    open_database();
+}
+
+FileDBClient::~FileDBClient()
+{}
+
+AbstractDBDriver *FileDBClient::clone( const std::string& new_db_name )
+{
+    return new FileDBClient{ directory_path, new_db_name };
+}
+
+std::string FileDBClient::status() const
+{
+    std::shared_lock<std::shared_mutex> g(collections_mutex);
+    return "Local file database " + database_path + " ( " + std::to_string( collection_types.size() ) + " collections )";
+}
+
+bool FileDBClient::connected() const
+{
+    return fs::is_directory( database_path );
+}
+
+void FileDBClient::compact()
+{
+    std::shared_lock<std::shared_mutex> g(collections_mutex);
+    for( auto& store: collection_stores )
+        store.second->compact();
+}
+
+void FileDBClient::open_database()
+{
+    try {
+        fs::create_directories( database_path );
+        auto list_path = fs::path( database_path ) / "collections.json";
+        if( fs::exists( list_path ) )
+        {
+            std::ifstream fin( list_path );
+            std::stringstream buffer;
+            buffer << fin.rdbuf();
+            auto collections_list = json::loads( buffer.str() );
+            collections_list.get_to_map( collection_types );
+        }
+        for( const auto& collection: collection_types )
+            collection_stores[collection.first] = std::make_shared<FileSegmentsStore>( database_path, collection.first );
+        io_logger->debug("FileDBClient::open_database {} collections: {}", database_path, collection_types.size() );
+    }
+    catch( fs::filesystem_error& e )
+    {
+        JSONIO_THROW( "FileDBClient", 1, e.what() );
+    }
+}
+
+void FileDBClient::save_collections_list()
+{
+    auto list_path = fs::path( database_path ) / "collections.json";
+    auto tmp_path = fs::path( database_path ) / "collections.json.tmp";
+    {
+        std::ofstream fout( tmp_path, std::ios::trunc );
+        fout << json::dump( collection_types );
+        JSONIO_THROW_IF( !fout.good(), "FileDBClient", 2, " error writing collections list " + tmp_path.string() );
+    }
+    fs::rename( tmp_path, list_path );
+}
+
+void FileDBClient::create_collection( const std::string& collname, const std::string& ctype )
+{
+    std::lock_guard<std::shared_mutex> g(collections_mutex);
+    if( collection_types.find( collname ) != collection_types.end() )
+        return;
+    collection_stores[collname] = std::make_shared<FileSegmentsStore>( database_path, collname );
+    collection_types[collname] = ctype;
+    save_collections_list();
+}
+
+std::set<std::string> FileDBClient::get_collections_names( CollTypes ctype )
+{
+    std::set<std::string> names;
+    std::shared_lock<std::shared_mutex> g(collections_mutex);
+    for( const auto& collection: collection_types )
+    {
+        bool is_edge = ( collection.second == "edge" );
+        if( ( is_edge && ( ctype & clEdge ) ) || ( !is_edge && ( ctype & clVertex ) ) )
+            names.insert( collection.first );
+    }
+    return names;
+}
+
+std::shared_ptr<FileSegmentsStore> FileDBClient::collection_store( const std::string& collname ) const
+{
+    std::shared_lock<std::shared_mutex> g(collections_mutex);
+    auto itr = collection_stores.find( collname );
+    JSONIO_THROW_IF( itr == collection_stores.end(), "FileDBClient", 3, " collection '" + collname + "' does not exist." );
+    return itr->second;
+}
+
+std::uint64_t FileDBClient::new_tick()
+{
+    auto now = static_cast<std::uint64_t>( std::chrono::duration_cast<std::chrono::microseconds>(
+                                               std::chrono::system_clock::now().time_since_epoch() ).count() );
+    auto last = last_tick.load();
+    std::uint64_t next;
+    do {
+        next = std::max( last+1, now );
+    } while( !last_tick.compare_exchange_weak( last, next ) );
+    return next;
+}
+
+std::string FileDBClient::make_document( const std::string& id, const JsonBase& recdata )
+{
+    auto free_data = dynamic_cast<const JsonFree*>( &recdata );
+    JsonFree document = ( free_data ? JsonFree( *free_data ) : json::loads( recdata.dump( true ) ) );
+    document.set_oid( id );
+    document.set_value_via_path( "_rev", std::to_string( new_tick() ) );
+    return document.dump( true );
+}
+
+bool FileDBClient::insert_record( const std::string& collname, const std::string& id, const JsonBase& recdata )
+{
+    return collection_store( collname )->insert( id, make_document( id, recdata ) );
+}
+
+bool FileDBClient::read_record( const std::string& collname, keysmap_t::iterator& it, JsonBase& recdata )
+{
+    std::string jsonrec;
+    auto ret = collection_store( collname )->get( get_server_key( it->second ), jsonrec );
+    if( ret )
+        recdata.loads( jsonrec );
+    return ret;
+}
+
+std::string FileDBClient::update_record( const std::string& collname, keysmap_t::iterator& it, const JsonBase& recdata )
+{
+    auto rid = get_server_key( it->second );
+    collection_store( collname )->put( rid, make_document( rid, recdata ) );
+    return rid;
+}
+
+bool FileDBClient::delete_record( const std::string& collname, keysmap_t::iterator& it )
+{
+    return collection_store( collname )->remove( get_server_key( it->second ) );
+}
+
+void FileDBClient::scan_documents( const FileSegmentsStore& store, const DBQueryMatcher& matcher,
+                                   const std::function<void( const JsonBase&, const std::string& )>& visitor ) const
+{
+    auto ids = store.ids();
+    std::vector<std::string> raw_documents;
+    for( std::size_t pos=0; pos<ids.size(); pos+=scan_batch_size )
+    {
+        // copy the documents under lock, parse and send out of lock
+        std::vector<std::string> ids_batch( ids.begin()+pos, ids.begin()+std::min( pos+scan_batch_size, ids.size() ) );
+        raw_documents.clear();
+        store.read( ids_batch, [&]( const std::string&, std::string_view jsondata )
+        {
+            if( matcher.mayMatch( jsondata ) )
+                raw_documents.emplace_back( jsondata );
+        });
+        for( const auto& jsondata: raw_documents )
+        {
+            auto document = json::loads( jsondata );
+            visitor( document, jsondata );
+        }
+    }
+}
+
+void FileDBClient::select_query( const std::string& collname, const DBQueryBase& query, SetReaded_f setfnc )
+{
+    DBQueryMatcher matcher( query );
+    std::vector<std::shared_ptr<FileSegmentsStore>> stores;
+    for( const auto& query_collection: query_collections( collname, matcher ) )
+        stores.push_back( collection_store( query_collection ) );
+
+    matcher.select( [&]( const DBQueryMatcher::Visit_f& visitor )
+    {
+        for( const auto& store: stores )
+            scan_documents( *store, matcher, visitor );
+    }, setfnc );
+}
+
+void FileDBClient::lookup_by_ids( const std::string& collname, const std::vector<std::string>& ids, SetReaded_f setfnc )
+{
+    auto store = collection_store( collname );
+    std::vector<std::string> documents_ids;
+    for( const auto& id: ids )
+        documents_ids.push_back( document_id( collname, id ) );
+
+    std::vector<std::string> raw_documents;
+    store->read( documents_ids, [&]( const std::string&, std::string_view jsondata )
+    {
+        raw_documents.emplace_back( jsondata );
+    });
+    for( const auto& jsondata: raw_documents )
+        setfnc( jsondata );
+}
+
+void FileDBClient::all_query( const std::string& collname, const std::set<std::string>& query_fields, SetReadedKey_f setfnc )
+{
+    auto store = collection_store( collname );
+    AllQueryFields fields( query_fields );
+    auto ids = store->ids();
+    std::vector<std::pair<std::string, std::string>> raw_documents;
+    for( std::size_t pos=0; pos<ids.size(); pos+=scan_batch_size )
+    {
+        std::vector<std::string> ids_batch( ids.begin()+pos, ids.begin()+std::min( pos+scan_batch_size, ids.size() ) );
+        raw_documents.clear();
+        store->read( ids_batch, [&]( const std::string& id, std::string_view jsondata )
+        {
+            raw_documents.emplace_back( id, fields.need_data() ? std::string( jsondata ) : std::string() );
+        });
+        // projections are parsed out of lock
+        for( const auto& document: raw_documents )
+            setfnc( fields.result( document.first, document.second ), document.first );
+    }
+}
+
+void FileDBClient::fpath_collect( const std::string& collname, const std::string& fpath, std::vector<std::string>& values )
+{
+    std::set<std::string> distinct_values;
+    DBQueryMatcher matcher( DBQueryBase( DBQueryBase::qAll ) );
+    scan_documents( *collection_store( collname ), matcher, [&]( const JsonBase& document, const std::string& )
+    {
+        auto node = document.field( fpath );
+        if( node && !node->isNull() )
+            distinct_values.insert( node->toString( true ) );
+    });
+    values.assign( distinct_values.begin(), distinct_values.end() );
+}
+
+void FileDBClient::delete_edges( const std::string& collname, const std::string& vertexid )
+{
+    auto store = collection_store( collname );
+    DBQueryMatcher matcher( DBQueryBase( "{ \"startVertex\": " + json::dump( vertexid ) + ", \"edgeCollections\": \"\" }",
+                                         DBQueryBase::qEdgesAll ) );
+    std::vector<std::string> edge_ids;
+    scan_documents( *store, matcher, [&]( const JsonBase& document, const std::string& )
+    {
+        std::string edge_id;
+        if( matcher.match( document ) && document.get_value_via_path( "_id", edge_id, std::string("") ) )
+            edge_ids.push_back( edge_id );
+    });
+    store->remove( edge_ids );
+}
+
+void FileDBClient::remove_by_ids( const std::string& collname, const std::vector<std::string>& ids )
+{
+    std::vector<std::string> documents_ids;
+    for( const auto& id: ids )
+        documents_ids.push_back( document_id( collname, id ) );
+    collection_store( collname )->remove( documents_ids );
+}
+
+} // namespace jsonio
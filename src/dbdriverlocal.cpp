@@ -0,0 +1,99 @@
+#include <algorithm>
+#include <cctype>
+#include "jsonio/dbdriverlocal.h"
+#include "jsonio/dbquerymatcher.h"
+#include "jsonio/jsonfree.h"
+#include "jsonio/jsondump.h"
+
+namespace jsonio {
+
+LocalDBDriver::AllQueryFields::AllQueryFields( const std::set<std::string>& query_fields )
+{
+    only_id = ( query_fields.size() == 1 && *query_fields.begin() == "_id" );
+    whole_document = query_fields.empty() ||
+            std::any_of( query_fields.begin(), query_fields.end(), []( const std::string& field )
+    {
+        return field.find( '.' ) != std::string::npos;
+    });
+    for( const auto& field: query_fields )
+        map_fields[field] = field;
+}
+
+std::string LocalDBDriver::AllQueryFields::result( const std::string& id, std::string_view jsondata,
+                                                   const JsonBase* document ) const
+{
+    if( only_id )
+        return "{\"_id\":" + json::dump( id ) + "}";
+    if( whole_document )
+        return std::string( jsondata );
+    if( document )
+        return DBQueryMatcher::project( *document, map_fields );
+    return DBQueryMatcher::project( json::loads( std::string( jsondata ) ), map_fields );
+}
+
+std::string LocalDBDriver::document_id( const std::string& collname, const std::string& id_or_key )
+{
+    if( id_or_key.find( '/' ) != std::string::npos )
+        return id_or_key;
+    return collname + "/" + id_or_key;
+}
+
+std::string LocalDBDriver::create_record( const std::string& collname, std::string& second, const JsonBase& recdata )
+{
+    std::string key;
+    recdata.get_value_via_path( "_key", key, std::string("") );
+    if( key.empty() )
+    {
+        recdata.get_value_via_path( "_id", key, std::string("") );
+        key = key.substr( key.find_last_of( '/' ) + 1 );
+    }
+
+    std::string new_id;
+    if( key.empty() )
+    {
+        // generated keys are unique numbers
+        do {
+            new_id = collname + "/" + std::to_string( new_tick() );
+        } while( !insert_record( collname, new_id, recdata ) );
+    }
+    else
+    {
+        new_id = collname + "/" + key;
+        JSONIO_THROW_IF( !insert_record( collname, new_id, recdata ), "LocalDBDriver", 1,
+                         " unique constraint violated, document '" + new_id + "' already exists." );
+    }
+    set_server_key( second, new_id );
+    return new_id;
+}
+
+std::vector<std::string> LocalDBDriver::query_collections( const std::string& collname, const DBQueryMatcher& matcher )
+{
+    if( matcher.isEdgesQuery() )
+    {
+        auto edge_collections = matcher.collections();
+        if( edge_collections.empty() )
+        {
+            auto edge_names = get_collections_names( clEdge );
+            if( edge_names.find( collname ) != edge_names.end() )
+                edge_collections.push_back( collname );
+            else
+                edge_collections.assign( edge_names.begin(), edge_names.end() );
+        }
+        return edge_collections;
+    }
+    if( matcher.type() == DBQueryBase::qAQL && !matcher.collections().empty() )
+        return { matcher.collections().front() };
+    return { collname };
+}
+
+std::string LocalDBDriver::sanitization( const std::string& documentHandle )
+{
+    static const std::string allowed_characters = "_-:.@()+,=;$!*'%";
+    std::string sanitized = documentHandle;
+    for( auto& ch: sanitized )
+        if( !std::isalnum( static_cast<unsigned char>(ch) ) && allowed_characters.find( ch ) == std::string::npos )
+            ch = '_';
+    return sanitized;
+}
+
+} // namespace jsonio
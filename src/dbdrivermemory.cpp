@@ -0,0 +1,323 @@
+#include <algorithm>
+#include "jsonio/dbdrivermemory.h"
+#include "jsonio/dbquerymatcher.h"
+#include "jsonio/jsonfree.h"
+#include "jsonio/jsondump.h"
+
+namespace jsonio {
+
+MemoryDBClient::MemoryDBClient( const std::string& db_name ):
+    LocalDBDriver(), database_name( db_name ), last_tick( 0 )
+{}
+
+MemoryDBClient::~MemoryDBClient()
+{}
+
+AbstractDBDriver *MemoryDBClient::clone( const std::string& new_db_name )
+{
+    return new MemoryDBClient{ new_db_name };
+}
+
+std::string MemoryDBClient::status() const
+{
+    std::shared_lock<std::shared_mutex> g(collections_mutex);
+    return "In-memory database " + database_name + " ( " + std::to_string( collections.size() ) + " collections )";
+}
+
+void MemoryDBClient::ensure_index( const std::string& collname, const std::string& fieldpath )
+{
+    auto collection = get_collection( collname );
+    std::lock_guard<std::shared_mutex> g(collection->mutex);
+    if( collection->indexes.find( fieldpath ) != collection->indexes.end() )
+        return;
+    auto& index = collection->indexes[fieldpath];
+    for( const auto& document: collection->documents )
+        update_index( index, fieldpath, document.first, *document.second, true );
+}
+
+std::size_t MemoryDBClient::documents_count( const std::string& collname ) const
+{
+    auto collection = get_collection( collname );
+    std::shared_lock<std::shared_mutex> g(collection->mutex);
+    return collection->documents.size();
+}
+
+void MemoryDBClient::clear()
+{
+    std::lock_guard<std::shared_mutex> g(collections_mutex);
+    collections.clear();
+}
+
+void MemoryDBClient::create_collection( const std::string& collname, const std::string& ctype )
+{
+    std::lock_guard<std::shared_mutex> g(collections_mutex);
+    if( collections.find( collname ) != collections.end() )
+        return;
+    auto collection = std::make_shared<Collection>();
+    collection->type = ctype;
+    if( ctype == "edge" )
+    {
+        collection->indexes["_from"];
+        collection->indexes["_to"];
+    }
+    collections[collname] = collection;
+}
+
+std::set<std::string> MemoryDBClient::get_collections_names( CollTypes ctype )
+{
+    std::set<std::string> names;
+    std::shared_lock<std::shared_mutex> g(collections_mutex);
+    for( const auto& collection: collections )
+    {
+        bool is_edge = ( collection.second->type == "edge" );
+        if( ( is_edge && ( ctype & clEdge ) ) || ( !is_edge && ( ctype & clVertex ) ) )
+            names.insert( collection.first );
+    }
+    return names;
+}
+
+std::shared_ptr<MemoryDBClient::Collection> MemoryDBClient::get_collection( const std::string& collname ) const
+{
+    std::shared_lock<std::shared_mutex> g(collections_mutex);
+    auto itr = collections.find( collname );
+    JSONIO_THROW_IF( itr == collections.end(), "MemoryDBClient", 1, " collection '" + collname + "' does not exist." );
+    return itr->second;
+}
+
+MemoryDBClient::Document_ptr MemoryDBClient::make_document( const std::string& id, const JsonBase& recdata )
+{
+    auto free_data = dynamic_cast<const JsonFree*>( &recdata );
+    auto data = ( free_data ? std::make_shared<JsonFree>( *free_data ) :
+                              std::make_shared<JsonFree>( json::loads( recdata.dump( true ) ) ) );
+    data->set_oid( id );
+    data->set_value_via_path( "_rev", std::to_string( new_tick() ) );
+    auto document = std::make_shared<Document>();
+    document->jsondata = data->dump( true );
+    document->data = data;
+    return document;
+}
+
+void MemoryDBClient::update_index( HashIndex& index, const std::string& fieldpath,
+                                   const std::string& id, const Document& document, bool add )
+{
+    const JsonBase* node = document.data->field( fieldpath );
+    if( !node || !node->isString() )
+        return;
+    if( add )
+        index[node->getFieldValue()].insert( id );
+    else
+    {
+        auto itvalue = index.find( node->getFieldValue() );
+        if( itvalue == index.end() )
+            return;
+        itvalue->second.erase( id );
+        if( itvalue->second.empty() )
+            index.erase( itvalue );
+    }
+}
+
+void MemoryDBClient::put_document( Collection& collection, const std::string& id, Document_ptr document )
+{
+    remove_document( collection, id );
+    for( auto& index: collection.indexes )
+        update_index( index.second, index.first, id, *document, true );
+    collection.documents[id] = std::move( document );
+}
+
+bool MemoryDBClient::remove_document( Collection& collection, const std::string& id )
+{
+    auto itdoc = collection.documents.find( id );
+    if( itdoc == collection.documents.end() )
+        return false;
+    for( auto& index: collection.indexes )
+        update_index( index.second, index.first, id, *itdoc->second, false );
+    collection.documents.erase( itdoc );
+    return true;
+}
+
+bool MemoryDBClient::insert_record( const std::string& collname, const std::string& id, const JsonBase& recdata )
+{
+    auto collection = get_collection( collname );
+    auto document = make_document( id, recdata );
+    std::lock_guard<std::shared_mutex> g(collection->mutex);
+    if( collection->documents.find( id ) != collection->documents.end() )
+        return false;
+    put_document( *collection, id, std::move( document ) );
+    return true;
+}
+
+bool MemoryDBClient::read_record( const std::string& collname, keysmap_t::iterator& it, JsonBase& recdata )
+{
+    auto collection = get_collection( collname );
+    Document_ptr document;
+    {
+        std::shared_lock<std::shared_mutex> g(collection->mutex);
+        auto itdoc = collection->documents.find( get_server_key( it->second ) );
+        if( itdoc == collection->documents.end() )
+            return false;
+        document = itdoc->second;
+    }
+    recdata.loads( document->jsondata );
+    return true;
+}
+
+std::string MemoryDBClient::update_record( const std::string& collname, keysmap_t::iterator& it, const JsonBase& recdata )
+{
+    auto collection = get_collection( collname );
+    auto rid = get_server_key( it->second );
+    auto document = make_document( rid, recdata );
+    std::lock_guard<std::shared_mutex> g(collection->mutex);
+    put_document( *collection, rid, std::move( document ) );
+    return rid;
+}
+
+bool MemoryDBClient::delete_record( const std::string& collname, keysmap_t::iterator& it )
+{
+    auto collection = get_collection( collname );
+    std::lock_guard<std::shared_mutex> g(collection->mutex);
+    return remove_document( *collection, get_server_key( it->second ) );
+}
+
+std::vector<MemoryDBClient::Document_ptr> MemoryDBClient::candidates( const Collection& collection,
+                                                                      const DBQueryMatcher& matcher ) const
+{
+    static const std::unordered_set<std::string> no_ids;
+    auto index_ids = [&collection]( const std::string& fieldpath, const std::string& value )
+            -> const std::unordered_set<std::string>*
+    {
+        auto itindex = collection.indexes.find( fieldpath );
+        if( itindex == collection.indexes.end() )
+            return nullptr;
+        auto itvalue = itindex->second.find( value );
+        return ( itvalue == itindex->second.end() ? &no_ids : &itvalue->second );
+    };
+
+    std::vector<Document_ptr> documents;
+    std::shared_lock<std::shared_mutex> g(collection.mutex);
+    std::vector<const std::unordered_set<std::string>*> ids_lists;
+    if( matcher.isEdgesQuery() )
+    {
+        auto from_ids = ( matcher.outEdges() ? index_ids( "_from", matcher.startVertex() ) : &no_ids );
+        auto to_ids = ( matcher.inEdges() ? index_ids( "_to", matcher.startVertex() ) : &no_ids );
+        if( from_ids && to_ids )
+            ids_lists = { from_ids, to_ids };
+    }
+    if( ids_lists.empty() )
+    {
+        // the most selective of indexed conditions
+        for( const auto& condition: matcher.equalConditions() )
+        {
+            auto ids = index_ids( condition.first, condition.second );
+            if( ids && ( ids_lists.empty() || ids->size() < ids_lists[0]->size() ) )
+                ids_lists = { ids };
+        }
+    }
+
+    if( ids_lists.empty() )
+    {
+        documents.reserve( collection.documents.size() );
+        for( const auto& document: collection.documents )
+            documents.push_back( document.second );
+        return documents;
+    }
+
+    std::unordered_set<std::string> added_ids;
+    for( const auto& ids: ids_lists )
+        for( const auto& id: *ids )
+        {
+            // the self-loop edge is into both _from and _to indexes
+            if( ids_lists.size() > 1 && !added_ids.insert( id ).second )
+                continue;
+            auto itdoc = collection.documents.find( id );
+            if( itdoc != collection.documents.end() )
+                documents.push_back( itdoc->second );
+        }
+    return documents;
+}
+
+void MemoryDBClient::select_query( const std::string& collname, const DBQueryBase& query, SetReaded_f setfnc )
+{
+    DBQueryMatcher matcher( query );
+    std::vector<std::shared_ptr<Collection>> collections_list;
+    for( const auto& query_collection: query_collections( collname, matcher ) )
+        collections_list.push_back( get_collection( query_collection ) );
+
+    // documents are immutable, so the callbacks are called out of locks
+    matcher.select( [&]( const DBQueryMatcher::Visit_f& visitor )
+    {
+        for( const auto& collection: collections_list )
+            for( const auto& document: candidates( *collection, matcher ) )
+                visitor( *document->data, document->jsondata );
+    }, setfnc );
+}
+
+void MemoryDBClient::lookup_by_ids( const std::string& collname, const std::vector<std::string>& ids, SetReaded_f setfnc )
+{
+    auto collection = get_collection( collname );
+    std::vector<Document_ptr> documents;
+    {
+        std::shared_lock<std::shared_mutex> g(collection->mutex);
+        for( const auto& id: ids )
+        {
+            auto itdoc = collection->documents.find( document_id( collname, id ) );
+            if( itdoc != collection->documents.end() )
+                documents.push_back( itdoc->second );
+        }
+    }
+    for( const auto& document: documents )
+        setfnc( document->jsondata );
+}
+
+void MemoryDBClient::all_query( const std::string& collname, const std::set<std::string>& query_fields, SetReadedKey_f setfnc )
+{
+    auto collection = get_collection( collname );
+    AllQueryFields fields( query_fields );
+    std::vector<std::pair<std::string, Document_ptr>> documents;
+    {
+        std::shared_lock<std::shared_mutex> g(collection->mutex);
+        documents.assign( collection->documents.begin(), collection->documents.end() );
+    }
+    for( const auto& document: documents )
+        setfnc( fields.result( document.first, document.second->jsondata, document.second->data.get() ), document.first );
+}
+
+void MemoryDBClient::fpath_collect( const std::string& collname, const std::string& fpath, std::vector<std::string>& values )
+{
+    auto collection = get_collection( collname );
+    std::set<std::string> distinct_values;
+    std::shared_lock<std::shared_mutex> g(collection->mutex);
+    for( const auto& document: collection->documents )
+    {
+        auto node = document.second->data->field( fpath );
+        if( node && !node->isNull() )
+            distinct_values.insert( node->toString( true ) );
+    }
+    values.assign( distinct_values.begin(), distinct_values.end() );
+}
+
+void MemoryDBClient::delete_edges( const std::string& collname, const std::string& vertexid )
+{
+    auto collection = get_collection( collname );
+    DBQueryMatcher matcher( DBQueryBase( "{ \"startVertex\": " + json::dump( vertexid ) + ", \"edgeCollections\": \"\" }",
+                                         DBQueryBase::qEdgesAll ) );
+    std::vector<std::string> edge_ids;
+    for( const auto& document: candidates( *collection, matcher ) )
+    {
+        std::string edge_id;
+        if( matcher.match( *document->data ) && document->data->get_value_via_path( "_id", edge_id, std::string("") ) )
+            edge_ids.push_back( edge_id );
+    }
+    std::lock_guard<std::shared_mutex> g(collection->mutex);
+    for( const auto& edge_id: edge_ids )
+        remove_document( *collection, edge_id );
+}
+
+void MemoryDBClient::remove_by_ids( const std::string& collname, const std::vector<std::string>& ids )
+{
+    auto collection = get_collection( collname );
+    std::lock_guard<std::shared_mutex> g(collection->mutex);
+    for( const auto& id: ids )
+        remove_document( *collection, document_id( collname, id ) );
+}
+
+} // namespace jsonio
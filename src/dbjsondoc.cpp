@@ -32,11 +32,23 @@ void DBJsonDocument::update_query()
         std::lock_guard<std::shared_mutex> g(query_result_mutex);
 
         query_result->clear();
+        const auto& fields = query_result->query().fields();
+        auto projection = make_line_projection( fields );
+        const std::string missing_value = "---";
         SetReaded_f setfnc = [&]( const std::string& jsondata )
         {
+            std::string key;
+            values_t values;
+            if( project_line( projection, jsondata, fields.size(), &missing_value, key, values ) )
+            {
+                for( auto& value: values )
+                    trim( value );
+                query_result->add_line_values( key, values );
+                return;
+            }
             auto jsonFree = json::loads( jsondata );
-            auto key = collection_from->getKeyFrom( jsonFree );
-            query_result->add_line( key,  jsonFree, false );
+            key = collection_from->getKeyFrom( jsonFree );
+            query_result->add_line_document( key,  jsonFree );
         };
 
         collection_from->selectQuery( query_result->condition(), setfnc );
@@ -0,0 +1,53 @@
+#include "jsonio/dbkeysindex.h"
+
+namespace jsonio {
+
+void KeysIndex::insert( std::string_view id )
+{
+    if( !id.empty() )
+        ids.insert( id );
+}
+
+void KeysIndex::erase( std::string_view id )
+{
+    ids.erase( id );
+}
+
+void KeysIndex::clear()
+{
+    ids.clear();
+    std::lock_guard<std::mutex> g(suffix_mutex);
+    next_suffix.clear();
+}
+
+bool KeysIndex::has_prefix( std::string_view id_head ) const
+{
+    auto itr = ids.lower_bound( id_head );
+    return itr != ids.end() && itr->substr( 0, id_head.length() ) == id_head;
+}
+
+std::vector<std::string> KeysIndex::with_prefix( std::string_view id_head ) const
+{
+    std::vector<std::string> ids_list;
+    for( auto itr = ids.lower_bound( id_head ); itr != ids.end(); ++itr )
+    {
+        if( itr->substr( 0, id_head.length() ) != id_head )
+            break;
+        ids_list.emplace_back( *itr );
+    }
+    return ids_list;
+}
+
+std::string KeysIndex::unique_suffix( const std::string& id_head ) const
+{
+    if( !has_prefix( id_head ) )
+        return "";
+
+    std::lock_guard<std::mutex> g(suffix_mutex);
+    auto& ii = next_suffix[id_head];
+    while( contains( id_head + "_" + std::to_string(ii) ) )
+        ii++;
+    return "_" + std::to_string(ii);
+}
+
+} // namespace jsonio
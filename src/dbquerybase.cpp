@@ -1,5 +1,7 @@
 
+#include <algorithm>
 #include "jsonio/dbquerybase.h"
+#include "jsonio/dbquerymatcher.h"
 #include "jsonio/jsonfree.h"
 #include "arango-cpp/arangoquery.h"
 
@@ -288,10 +290,9 @@ void DBQueryResult::node_to_values( const JsonBase& node, values_t& values ) con
 void DBQueryResult::node_to_values_fields( const JsonBase& node, const fields2query_t& map_fields, values_t& values ) const
 {
     values.clear();
-    std::string kbuf, fld_key;
-    for( const auto& afield: query_data.fields() )
+    std::string kbuf;
+    for( const auto& fielkey: fields_query_keys )
     {
-        auto fielkey = regexp_replace(afield ,"\\.([0-9])", "[$1]");
         auto it_fld = map_fields.find(fielkey);
         if( it_fld == map_fields.end() )
             kbuf = std::string("---");
@@ -306,44 +307,291 @@ void DBQueryResult::node_to_values_fields( const JsonBase& node, const fields2qu
     }
 }
 
-void DBQueryResult::add_line( const std::string &key_str, const JsonBase& nodedata, bool isupdate )
+std::size_t DBQueryResult::ResultColumn::encode( const std::string& value )
 {
-    values_t values;
-    node_to_values( nodedata, values );
+    auto it = codes.find( value );
+    if( it != codes.end() )
+    {
+        ++uses[it->second];
+        return it->second;
+    }
+    std::size_t code;
+    if( !free_codes.empty() )
+    {
+        code = free_codes.back();
+        free_codes.pop_back();
+        dictionary[code] = value;
+        uses[code] = 1;
+    }
+    else
+    {
+        code = dictionary.size();
+        dictionary.push_back( value );
+        uses.push_back( 1 );
+    }
+    codes[value] = code;
+    return code;
+}
+
+void DBQueryResult::ResultColumn::release( std::size_t code )
+{
+    if( --uses[code] > 0 )
+        return;
+    codes.erase( dictionary[code] );
+    std::string().swap( dictionary[code] );
+    index.erase( code );
+    free_codes.push_back( code );
+}
+
+bool DBQueryResult::ResultColumn::find_code( const std::string& value, std::size_t& code ) const
+{
+    auto it = codes.find( value );
+    if( it == codes.end() )
+        return false;
+    code = it->second;
+    return true;
+}
+
+void DBQueryResult::ResultColumn::build_index( const std::vector<const std::string*>& row_keys )
+{
+    index.clear();
+    for( std::size_t row=0; row<row_keys.size(); ++row )
+        if( row_keys[row] )
+            index[cells[row]].insert( row );
+}
 
-    if( isupdate )
+void DBQueryResult::setIndexedFields( const std::set<std::string>& fieldnames )
+{
+    indexed_fields = fieldnames;
+    for( std::size_t ii=0; ii<columns.size(); ++ii )
     {
-        auto it =  query_result_data.find(key_str);
-        if( it != query_result_data.end() )
-        {   it->second = values;
-            return;
+        auto& column = columns[ii];
+        column.indexed = indexed_fields.find( query_data.fields()[ii] ) != indexed_fields.end();
+        if( column.indexed )
+            column.build_index( row_keys );
+        else
+            column.index.clear();
+    }
+}
+
+void DBQueryResult::reset_columns()
+{
+    fields_query_keys.clear();
+    for( const auto& afield: query_data.fields() )
+        fields_query_keys.push_back( brackets_field_path( afield ) );
+    columns.clear();
+    columns.resize( query_data.fields().size() );
+    for( std::size_t ii=0; ii<columns.size(); ++ii )
+        columns[ii].indexed = indexed_fields.find( query_data.fields()[ii] ) != indexed_fields.end();
+}
+
+void DBQueryResult::reset_matcher()
+{
+    line_matcher.reset();
+    if( query_data.condition() == nullptr )
+        return;
+    try {
+        auto matcher = std::make_shared<DBQueryMatcher>( *query_data.condition() );
+        if( matcher->selectsDocuments() )
+            line_matcher = matcher;
+    }
+    catch( jsonio_exception& )
+    {
+        // not supported query, the changes are applied by executing the query again
+    }
+}
+
+bool DBQueryResult::match_line( const std::string& key_str, const JsonBase& nodedata, bool& matched ) const
+{
+    if( !line_matcher )
+        return false;
+    if( !line_matcher->collections().empty() )
+    {
+        // the query reads other collection
+        auto collection = key_str.substr( 0, key_str.find('/') );
+        if( std::find( line_matcher->collections().begin(), line_matcher->collections().end(),
+                       collection ) == line_matcher->collections().end() )
+            return false;
+    }
+    matched = line_matcher->match( nodedata );
+    return true;
+}
+
+void DBQueryResult::set_row( const std::string& key_str, const values_t& values )
+{
+    std::size_t row;
+    bool update_row = false;
+    auto it = key_rows.find( key_str );
+    if( it != key_rows.end() )
+    {
+        row = it->second;
+        update_row = true;
+        for( auto& column: columns )
+            if( column.indexed )
+                column.index[column.cells[row]].erase( row );
+    }
+    else
+    {
+        if( !free_rows.empty() )
+        {
+            row = free_rows.back();
+            free_rows.pop_back();
         }
+        else
+        {
+            row = row_keys.size();
+            row_keys.push_back( nullptr );
+            for( auto& column: columns )
+                column.cells.push_back( 0 );
+        }
+        it = key_rows.insert( std::pair<std::string, std::size_t>( key_str, row ) ).first;
+        row_keys[row] = &it->first;
+    }
+
+    for( std::size_t ii=0; ii<columns.size(); ++ii )
+    {
+        auto& column = columns[ii];
+        auto old_code = column.cells[row];
+        column.cells[row] = column.encode( ii < values.size() ? values[ii] : std::string("---") );
+        // release after encode, so an unchanged value keeps its code
+        if( update_row )
+            column.release( old_code );
+        if( column.indexed )
+            column.index[column.cells[row]].insert( row );
     }
-    query_result_data.insert(std::pair<std::string,values_t>( key_str, values ));
 }
 
-void DBQueryResult::add_line_fields( const std::string& key_str, const JsonBase& nodedata, const fields2query_t& map_fields )
+values_t DBQueryResult::row_values( std::size_t row ) const
 {
     values_t values;
-    node_to_values_fields( nodedata, map_fields, values );
-    query_result_data.insert(std::pair<std::string,values_t>( key_str, values ));
+    for( const auto& column: columns )
+        values.push_back( column.dictionary[column.cells[row]] );
+    return values;
+}
+
+std::vector<std::size_t> DBQueryResult::select_rows( const std::vector<std::pair<std::size_t, std::size_t>>& column_codes,
+                                                     bool only_first ) const
+{
+    std::vector<std::size_t> rows;
+
+    // use the smallest hash index to get candidate lines
+    const std::unordered_set<std::size_t>* candidates = nullptr;
+    for( const auto& col_code: column_codes )
+    {
+        const auto& column = columns[col_code.first];
+        if( !column.indexed )
+            continue;
+        auto it = column.index.find( col_code.second );
+        if( it == column.index.end() )
+            return rows;
+        if( !candidates || it->second.size() < candidates->size() )
+            candidates = &it->second;
+    }
+
+    auto test_row = [&]( std::size_t row )
+    {
+        for( const auto& col_code: column_codes )
+            if( columns[col_code.first].cells[row] != col_code.second )
+                return false;
+        return true;
+    };
+
+    if( candidates )
+    {
+        for( auto row: *candidates )
+            if( test_row( row ) )
+                rows.push_back( row );
+        std::sort( rows.begin(), rows.end(), [this]( std::size_t a, std::size_t b ) {
+            return *row_keys[a] < *row_keys[b];
+        });
+    }
+    else
+    {
+        for( const auto& it: key_rows )
+            if( test_row( it.second ) )
+            {
+                rows.push_back( it.second );
+                if( only_first )
+                    break;
+            }
+    }
+    return rows;
+}
+
+bool DBQueryResult::add_line( const std::string &key_str, const JsonBase& nodedata, bool isupdate )
+{
+    bool matched;
+    if( !match_line( key_str, nodedata, matched ) )
+        return false;
+    if( !matched )
+    {
+        if( isupdate )
+            delete_line( key_str );
+        return true;
+    }
+    if( isupdate || key_rows.find( key_str ) == key_rows.end() )
+    {
+        values_t values;
+        node_to_values( nodedata, values );
+        set_row( key_str, values );
+    }
+    return true;
 }
 
-void DBQueryResult::update_line(const std::string &key_str, const JsonBase& nodedata)
+void DBQueryResult::add_line_document( const std::string& key_str, const JsonBase& nodedata )
 {
+    if( key_rows.find( key_str ) != key_rows.end() )
+        return;
     values_t values;
     node_to_values( nodedata, values );
+    set_row( key_str, values );
+}
 
-    auto it =  query_result_data.find(key_str);
-    if( it != query_result_data.end() )
-        it->second = values;
+void DBQueryResult::add_line_fields( const std::string& key_str, const JsonBase& nodedata, const fields2query_t& map_fields )
+{
+    if( key_rows.find( key_str ) != key_rows.end() )
+        return;
+    values_t values;
+    node_to_values_fields( nodedata, map_fields, values );
+    set_row( key_str, values );
+}
+
+void DBQueryResult::add_line_values( const std::string& key_str, const values_t& values )
+{
+    if( key_rows.find( key_str ) != key_rows.end() )
+        return;
+    set_row( key_str, values );
+}
+
+bool DBQueryResult::update_line(const std::string &key_str, const JsonBase& nodedata)
+{
+    return add_line( key_str, nodedata, true );
 }
 
 void DBQueryResult::delete_line( const std::string& key_str )
 {
-    auto it =  query_result_data.find(key_str);
-    if( it != query_result_data.end() )
-        query_result_data.erase(it);
+    auto it =  key_rows.find(key_str);
+    if( it != key_rows.end() )
+    {
+        auto row = it->second;
+        for( auto& column: columns )
+        {
+            if( column.indexed )
+                column.index[column.cells[row]].erase( row );
+            column.release( column.cells[row] );
+        }
+        row_keys[row] = nullptr;
+        free_rows.push_back( row );
+        key_rows.erase(it);
+    }
+}
+
+key_values_table_t DBQueryResult::queryResult() const
+{
+    key_values_table_t result_data;
+    for( const auto& it: key_rows )
+        result_data.insert( result_data.end(), std::pair<std::string,values_t>( it.first, row_values( it.second ) ) );
+    return result_data;
 }
 
 std::size_t DBQueryResult::getKeysValues(std::vector<std::string> &aKeyList, std::vector<values_t> &aValList) const
@@ -351,10 +599,10 @@ std::size_t DBQueryResult::getKeysValues(std::vector<std::string> &aKeyList, std
     aKeyList.clear();
     aValList.clear();
 
-    for( const auto& it: query_result_data )
+    for( const auto& it: key_rows )
     {
         aKeyList.push_back( it.first );
-        aValList.push_back( it.second );
+        aValList.push_back( row_values( it.second ) );
     }
 
     return aKeyList.size();
@@ -366,13 +614,12 @@ std::size_t DBQueryResult::getKeysValues(std::vector<std::string> &aKeyList, std
     aKeyList.clear();
     aValList.clear();
 
-    for( const auto& it: query_result_data )
+    for( const auto& it: key_rows )
     {
-        auto key = it.first;
-        if( compareTemplate(keypart, key ) )
+        if( compareTemplate(keypart, it.first ) )
         {
-          aKeyList.push_back( key );
-          aValList.push_back( it.second );
+          aKeyList.push_back( it.first );
+          aValList.push_back( row_values( it.second ) );
         }
     }
 
@@ -386,72 +633,72 @@ std::size_t DBQueryResult::getKeysValues( std::vector<std::string> &aKeyList, st
     aValList.clear();
 
     std::size_t ii;
-    std::vector<std::size_t> fieldindexes;
+    std::vector<std::pair<std::size_t, std::size_t>> column_codes;
 
-    for( const auto& fname: fieldnames )
+    for( std::size_t jj=0; jj<fieldnames.size(); ++jj )
     {
         for( ii=0; ii< query_data.fields().size(); ii++ )
         {
-            if( fname == query_data.fields()[ii])
-            {
-                fieldindexes.push_back(ii);
+            if( fieldnames[jj] == query_data.fields()[ii])
                 break;
-            }
         }
         if( ii == query_data.fields().size() )
             return 0;  // no field
+
+        std::size_t code;
+        if( !columns[ii].find_code( fieldvalues[jj], code ) )
+            return 0;  // no value
+        column_codes.push_back( { ii, code } );
     }
 
-    for( const auto& it: query_result_data )
+    for( auto row: select_rows( column_codes ) )
     {
-        bool getdata=true;
-        for( ii=0; ii<fieldindexes.size(); ii++ )
-        {
-            if( it.second[fieldindexes[ii]] != fieldvalues[ii] )
-            {
-                getdata = false;
-                break;
-            }
-        }
-        if( getdata )
-        {
-            aKeyList.push_back( it.first );
-            aValList.push_back( it.second );
-        }
+        aKeyList.push_back( *row_keys[row] );
+        aValList.push_back( row_values( row ) );
     }
     return aKeyList.size();
 }
 
 std::string DBQueryResult::getKeyFromValue( const JsonBase& node ) const
 {
-    std::size_t ii;
     values_t values;
     node_to_values( node, values );
 
-    for( const auto& it: query_result_data )
+    std::vector<std::pair<std::size_t, std::size_t>> column_codes;
+    for( std::size_t ii=0; ii< query_data.fields().size(); ++ii )
     {
-        for( ii=0; ii< query_data.fields().size(); ++ii )
-        {
-           if( it.second[ii] != values[ii] &&
-               query_data.fields()[ii] != "_id" &&
-               query_data.fields()[ii] != "_key" &&
-               query_data.fields()[ii] != "_rev" )
-             break;
-        }
-        if( ii >= query_data.fields().size() )
-          return it.first;
+        if( query_data.fields()[ii] == "_id" ||
+            query_data.fields()[ii] == "_key" ||
+            query_data.fields()[ii] == "_rev" )
+            continue;
+        std::size_t code;
+        if( !columns[ii].find_code( values[ii], code ) )
+            return "";
+        column_codes.push_back( { ii, code } );
     }
-    return "";
+
+    auto rows = select_rows( column_codes, true );
+    if( rows.empty() )
+        return "";
+    return *row_keys[rows.front()];
 }
 
 std::string DBQueryResult::getFirstKey() const
 {
-    auto it = query_result_data.begin();
-    if( it != query_result_data.end() )
+    auto it = key_rows.begin();
+    if( it != key_rows.end() )
        return it->first;
     return "";  // empty table
 }
 
+std::size_t DBQueryResult::fieldValuesCount( const std::string& fieldname ) const
+{
+    for( std::size_t ii=0; ii< query_data.fields().size(); ++ii )
+        if( query_data.fields()[ii] == fieldname )
+            return columns[ii].codes.size();
+    return 0;
+}
+
 
 } // namespace jsonio
 
@@ -0,0 +1,994 @@
+#include <algorithm>
+#include <cctype>
+#include "jsonio/dbquerymatcher.h"
+#include "jsonio/jsonfree.h"
+#include "jsonio/jsondump.h"
+#include "jsonio/jsondetail.h"
+
+namespace jsonio {
+
+/// Node of the compiled FILTER, SORT or RETURN expression
+struct DBQueryMatcher::Expression
+{
+    enum Kind { Literal, Attribute, Array, Object, Not, And, Or, Compare, In, NotIn, Like };
+
+    Kind kind = Literal;
+    /// Comparison operator
+    std::string op = "";
+    /// Attribute path into document ( empty - the document )
+    std::string path = "";
+    /// Literal value
+    const JsonBase* literal = nullptr;
+    /// Operands
+    std::vector<std::shared_ptr<Expression>> args = {};
+    /// Names of object fields
+    std::vector<std::string> names = {};
+};
+
+namespace {
+
+using Expression_ptr = std::shared_ptr<DBQueryMatcher::Expression>;
+
+/// Lexical token of AQL
+struct AQLToken
+{
+    enum Kind { End, Name, Bind, String, Number, Punct };
+    Kind kind = End;
+    std::string text = "";
+};
+
+std::vector<AQLToken> aql_tokens( const std::string& aql )
+{
+    std::vector<AQLToken> tokens;
+    std::size_t pos = 0;
+    while( pos < aql.size() )
+    {
+        char ch = aql[pos];
+        if( std::isspace( static_cast<unsigned char>(ch) ) )
+        {
+            pos++;
+            continue;
+        }
+        if( ch == '/' && pos+1 < aql.size() && aql[pos+1] == '/' )  // comment
+        {
+            pos = aql.find( '\n', pos );
+            if( pos == std::string::npos )
+                break;
+            continue;
+        }
+
+        AQLToken token;
+        if( std::isalpha( static_cast<unsigned char>(ch) ) || ch == '_' )
+        {
+            auto end = pos;
+            while( end < aql.size() && ( std::isalnum( static_cast<unsigned char>(aql[end]) ) || aql[end] == '_' ) )
+                end++;
+            token = { AQLToken::Name, aql.substr( pos, end-pos ) };
+            pos = end;
+        }
+        else if( ch == '`' )
+        {
+            auto end = aql.find( '`', pos+1 );
+            JSONIO_THROW_IF( end == std::string::npos, "DBQueryMatcher", 1, " unterminated name into AQL." );
+            token = { AQLToken::Name, aql.substr( pos+1, end-pos-1 ) };
+            pos = end+1;
+        }
+        else if( ch == '@' )
+        {
+            auto end = pos+1;
+            while( end < aql.size() && ( std::isalnum( static_cast<unsigned char>(aql[end]) ) || aql[end] == '_' || aql[end] == '@' ) )
+                end++;
+            token = { AQLToken::Bind, aql.substr( pos+1, end-pos-1 ) };
+            pos = end;
+        }
+        else if( ch == '\'' || ch == '"' )
+        {
+            std::string value;
+            auto end = pos+1;
+            while( end < aql.size() && aql[end] != ch )
+            {
+                if( aql[end] == '\\' && end+1 < aql.size() )
+                {
+                    end++;
+                    switch( aql[end] )
+                    {
+                    case 'n': value += '\n'; break;
+                    case 't': value += '\t'; break;
+                    case 'r': value += '\r'; break;
+                    default:  value += aql[end]; break;
+                    }
+                }
+                else
+                    value += aql[end];
+                end++;
+            }
+            JSONIO_THROW_IF( end >= aql.size(), "DBQueryMatcher", 1, " unterminated string into AQL." );
+            token = { AQLToken::String, value };
+            pos = end+1;
+        }
+        else if( std::isdigit( static_cast<unsigned char>(ch) ) ||
+                 ( ch == '-' && pos+1 < aql.size() && std::isdigit( static_cast<unsigned char>(aql[pos+1]) ) &&
+                   ( tokens.empty() || tokens.back().kind == AQLToken::Punct ) ) )
+        {
+            auto end = pos+1;
+            while( end < aql.size() && ( std::isdigit( static_cast<unsigned char>(aql[end]) ) ||
+                                         aql[end] == '.' || aql[end] == 'e' || aql[end] == 'E' ||
+                                         ( ( aql[end] == '-' || aql[end] == '+' ) && ( aql[end-1] == 'e' || aql[end-1] == 'E' ) ) ) )
+                end++;
+            token = { AQLToken::Number, aql.substr( pos, end-pos ) };
+            pos = end;
+        }
+        else
+        {
+            auto two = aql.substr( pos, 2 );
+            if( two == "==" || two == "!=" || two == "<=" || two == ">=" || two == "&&" || two == "||" )
+            {
+                token = { AQLToken::Punct, two };
+                pos += 2;
+            }
+            else
+            {
+                JSONIO_THROW_IF( std::string(".[]{}(),:<>!").find( ch ) == std::string::npos, "DBQueryMatcher", 2,
+                                 std::string(" unsupported character into AQL '") + ch + "'." );
+                token = { AQLToken::Punct, std::string( 1, ch ) };
+                pos++;
+            }
+        }
+        tokens.push_back( token );
+    }
+    tokens.push_back( AQLToken() );
+    return tokens;
+}
+
+bool iequal( const std::string& name, const char* keyword )
+{
+    std::string upper = name;
+    std::transform( upper.begin(), upper.end(), upper.begin(), ::toupper );
+    return upper == keyword;
+}
+
+/// Recursive descent parser of the supported AQL subset
+class AQLParser
+{
+
+public:
+
+    AQLParser( const std::string& aql, const JsonBase* bind_values, std::vector<std::shared_ptr<JsonFree>>& holders ):
+        tokens( aql_tokens( aql ) ), bind_object( bind_values ), value_holders( holders )
+    {}
+
+    const AQLToken& peek( std::size_t shift = 0 ) const
+    {
+        return tokens[ std::min( current+shift, tokens.size()-1 ) ];
+    }
+
+    const AQLToken& next()
+    {
+        const auto& token = peek();
+        if( current < tokens.size()-1 )
+            current++;
+        return token;
+    }
+
+    bool is_keyword( const char* keyword, std::size_t shift = 0 ) const
+    {
+        return peek(shift).kind == AQLToken::Name && iequal( peek(shift).text, keyword );
+    }
+
+    bool is_punct( const char* punct ) const
+    {
+        return peek().kind == AQLToken::Punct && peek().text == punct;
+    }
+
+    void expect_punct( const char* punct )
+    {
+        JSONIO_THROW_IF( !is_punct( punct ), "DBQueryMatcher", 3,
+                         std::string(" expected '") + punct + "' into AQL before '" + peek().text + "'." );
+        next();
+    }
+
+    std::string expect_name()
+    {
+        JSONIO_THROW_IF( peek().kind != AQLToken::Name, "DBQueryMatcher", 3,
+                         " expected name into AQL before '" + peek().text + "'." );
+        return next().text;
+    }
+
+    /// FOR variable
+    std::string variable = "";
+
+    Expression_ptr parse_or()
+    {
+        auto left = parse_and();
+        while( is_punct("||") || is_keyword("OR") )
+        {
+            next();
+            left = make_logical( DBQueryMatcher::Expression::Or, left, parse_and() );
+        }
+        return left;
+    }
+
+    Expression_ptr parse_and()
+    {
+        auto left = parse_not();
+        while( is_punct("&&") || is_keyword("AND") )
+        {
+            next();
+            left = make_logical( DBQueryMatcher::Expression::And, left, parse_not() );
+        }
+        return left;
+    }
+
+    Expression_ptr parse_not()
+    {
+        if( is_punct("!") || ( is_keyword("NOT") && !is_keyword("IN", 1) ) )
+        {
+            next();
+            auto expr = std::make_shared<DBQueryMatcher::Expression>();
+            expr->kind = DBQueryMatcher::Expression::Not;
+            expr->args.push_back( parse_not() );
+            return expr;
+        }
+        return parse_comparison();
+    }
+
+    Expression_ptr parse_comparison()
+    {
+        auto left = parse_operand();
+        auto expr = std::make_shared<DBQueryMatcher::Expression>();
+        if( peek().kind == AQLToken::Punct &&
+                ( peek().text == "==" || peek().text == "!=" || peek().text == "<" ||
+                  peek().text == "<=" || peek().text == ">" || peek().text == ">=" ) )
+        {
+            expr->kind = DBQueryMatcher::Expression::Compare;
+            expr->op = next().text;
+        }
+        else if( is_keyword("IN") )
+        {
+            next();
+            expr->kind = DBQueryMatcher::Expression::In;
+        }
+        else if( is_keyword("NOT") && is_keyword("IN", 1) )
+        {
+            next();
+            next();
+            expr->kind = DBQueryMatcher::Expression::NotIn;
+        }
+        else if( is_keyword("LIKE") )
+        {
+            next();
+            expr->kind = DBQueryMatcher::Expression::Like;
+        }
+        else
+            return left;
+        expr->args.push_back( left );
+        expr->args.push_back( parse_operand() );
+        return expr;
+    }
+
+    Expression_ptr parse_operand()
+    {
+        auto expr = std::make_shared<DBQueryMatcher::Expression>();
+        const auto& token = peek();
+        switch( token.kind )
+        {
+        case AQLToken::String:
+            expr->literal = make_literal( json::dump( next().text ) );
+            break;
+        case AQLToken::Number:
+            expr->literal = make_literal( next().text );
+            break;
+        case AQLToken::Bind:
+        {
+            auto name = next().text;
+            expr->literal = ( bind_object ? bind_object->field( name ) : nullptr );
+            JSONIO_THROW_IF( !expr->literal, "DBQueryMatcher", 4, " no value for bind parameter '@" + name + "'." );
+        }
+            break;
+        case AQLToken::Punct:
+            if( is_punct("(") )
+            {
+                next();
+                expr = parse_or();
+                expect_punct(")");
+            }
+            else if( is_punct("[") )
+            {
+                next();
+                expr->kind = DBQueryMatcher::Expression::Array;
+                while( !is_punct("]") )
+                {
+                    expr->args.push_back( parse_or() );
+                    if( !is_punct("]") )
+                        expect_punct(",");
+                }
+                next();
+            }
+            else if( is_punct("{") )
+            {
+                next();
+                expr->kind = DBQueryMatcher::Expression::Object;
+                while( !is_punct("}") )
+                {
+                    JSONIO_THROW_IF( peek().kind != AQLToken::Name && peek().kind != AQLToken::String, "DBQueryMatcher", 3,
+                                     " expected field name into AQL before '" + peek().text + "'." );
+                    expr->names.push_back( next().text );
+                    expect_punct(":");
+                    expr->args.push_back( parse_or() );
+                    if( !is_punct("}") )
+                        expect_punct(",");
+                }
+                next();
+            }
+            else
+                JSONIO_THROW( "DBQueryMatcher", 5, " unexpected '" + token.text + "' into AQL." );
+            break;
+        case AQLToken::Name:
+            if( token.text == variable )
+            {
+                next();
+                expr->kind = DBQueryMatcher::Expression::Attribute;
+                expr->path = parse_path();
+            }
+            else if( iequal( token.text, "TRUE" ) || iequal( token.text, "FALSE" ) || iequal( token.text, "NULL" ) )
+            {
+                auto value = next().text;
+                std::transform( value.begin(), value.end(), value.begin(), ::tolower );
+                expr->literal = make_literal( value );
+            }
+            else
+                JSONIO_THROW( "DBQueryMatcher", 6, " unsupported AQL expression '" + token.text + "'." );
+            break;
+        case AQLToken::End:
+            JSONIO_THROW( "DBQueryMatcher", 5, " unexpected end of AQL." );
+        }
+        return expr;
+    }
+
+    /// Read attribute path after the variable ( u.a.b[0] -> "a.b.0" )
+    std::string parse_path()
+    {
+        std::string path;
+        while( true )
+        {
+            if( is_punct(".") )
+            {
+                next();
+                add_path_item( path, expect_name() );
+            }
+            else if( is_punct("[") )
+            {
+                next();
+                JSONIO_THROW_IF( peek().kind != AQLToken::Number && peek().kind != AQLToken::String, "DBQueryMatcher", 6,
+                                 " unsupported AQL attribute access '[" + peek().text + "'." );
+                add_path_item( path, next().text );
+                expect_punct("]");
+            }
+            else
+                break;
+        }
+        return path;
+    }
+
+protected:
+
+    std::vector<AQLToken> tokens;
+    std::size_t current = 0;
+    const JsonBase* bind_object;
+    std::vector<std::shared_ptr<JsonFree>>& value_holders;
+
+    static void add_path_item( std::string& path, const std::string& item )
+    {
+        if( !path.empty() )
+            path += ".";
+        path += item;
+    }
+
+    const JsonBase* make_literal( const std::string& jsonvalue )
+    {
+        auto holder = std::make_shared<JsonFree>( json::loads( "{ \"v\": " + jsonvalue + " }" ) );
+        value_holders.push_back( holder );
+        return holder->field( "v" );
+    }
+
+    static Expression_ptr make_logical( DBQueryMatcher::Expression::Kind kind, Expression_ptr left, Expression_ptr right )
+    {
+        auto expr = std::make_shared<DBQueryMatcher::Expression>();
+        expr->kind = kind;
+        expr->args.push_back( left );
+        expr->args.push_back( right );
+        return expr;
+    }
+};
+
+/// Boolean values to return from logical expressions
+const JsonBase* bool_node( bool value )
+{
+    static const JsonFree bool_values = json::loads( "{ \"t\": true, \"f\": false }" );
+    return bool_values.field( value ? "t" : "f" );
+}
+
+int type_rank( const JsonBase* node )
+{
+    if( !node )
+        return 0;
+    switch( node->type() )
+    {
+    case JsonBase::Bool:   return 1;
+    case JsonBase::Int:
+    case JsonBase::Double: return 2;
+    case JsonBase::String: return 3;
+    case JsonBase::Array:  return 4;
+    case JsonBase::Object: return 5;
+    default:               return 0;
+    }
+}
+
+bool is_true( const JsonBase* node )
+{
+    switch( type_rank( node ) )
+    {
+    case 1:  return node->toBool();
+    case 2:  return node->toDouble() != 0.;
+    case 3:  return !node->getFieldValue().empty();
+    case 4:
+    case 5:  return true;
+    default: return false;
+    }
+}
+
+/// AQL LIKE: '%' any sequence, '_' any character, '\' escape
+bool like_match( const std::string& value, const std::string& pattern )
+{
+    std::size_t vpos = 0, ppos = 0;
+    std::size_t star_ppos = std::string::npos, star_vpos = 0;
+    while( vpos < value.size() )
+    {
+        if( ppos < pattern.size() && pattern[ppos] == '%' )
+        {
+            star_ppos = ppos++;
+            star_vpos = vpos;
+            continue;
+        }
+        if( ppos < pattern.size() )
+        {
+            bool escaped = ( pattern[ppos] == '\\' && ppos+1 < pattern.size() );
+            char pch = pattern[ escaped ? ppos+1 : ppos ];
+            if( ( !escaped && pch == '_' ) || pch == value[vpos] )
+            {
+                ppos += ( escaped ? 2 : 1 );
+                vpos++;
+                continue;
+            }
+        }
+        if( star_ppos == std::string::npos )
+            return false;
+        ppos = star_ppos+1;
+        vpos = ++star_vpos;
+    }
+    while( ppos < pattern.size() && pattern[ppos] == '%' )
+        ppos++;
+    return ppos == pattern.size();
+}
+
+/// Escaped json string to find into raw document ( empty if the escaped form differs )
+std::string raw_json_string( const JsonBase& value )
+{
+    if( !value.isString() )
+        return "";
+    auto dumped = json::dump( value.getFieldValue() );
+    if( dumped.size() != value.getFieldValue().size()+2 )
+        return "";
+    return dumped;
+}
+
+} // namespace
+
+
+DBQueryMatcher::DBQueryMatcher( const DBQueryBase& query ):
+    query_type( query.type() ), query_fields( query.queryFields() )
+{
+    switch( query_type )
+    {
+    case DBQueryBase::qTemplate:
+        compile_template( query.queryString() );
+        break;
+    case DBQueryBase::qEdgesFrom:
+    case DBQueryBase::qEdgesTo:
+    case DBQueryBase::qEdgesAll:
+        compile_edges( query.queryString() );
+        break;
+    case DBQueryBase::qAQL:
+        compile_aql( query.queryString(), query.bindVars() );
+        break;
+    case DBQueryBase::qEJDB:
+        JSONIO_THROW( "DBQueryMatcher", 7, " EJDB queries are not supported." );
+    case DBQueryBase::qUndef:
+    case DBQueryBase::qAll:
+        break;
+    }
+}
+
+DBQueryMatcher::~DBQueryMatcher()
+{}
+
+void DBQueryMatcher::compile_template( const std::string& template_json )
+{
+    if( template_json.empty() )
+        return;
+    auto holder = std::make_shared<JsonFree>( json::loads( template_json ) );
+    value_holders.push_back( holder );
+
+    std::function<void( const JsonBase&, const std::string& )> add_fields =
+            [&]( const JsonBase& object, const std::string& prefix )
+    {
+        for( std::size_t ii=0; ii<object.getChildrenCount(); ++ii )
+        {
+            auto child = object.getChild( ii );
+            auto path = prefix.empty() ? child->getKey() : prefix + "." + child->getKey();
+            if( child->isObject() && child->getChildrenCount() > 0 )
+                add_fields( *child, path );
+            else
+                add_equal_condition( path, *child );
+        }
+    };
+    add_fields( *holder, "" );
+}
+
+void DBQueryMatcher::compile_edges( const std::string& edges_json )
+{
+    std::shared_ptr<JsonFree> holder;
+    try {
+        holder = std::make_shared<JsonFree>( json::loads( edges_json ) );
+    }
+    catch( jsonio_exception& )
+    {
+        // old style queries use single quotes
+        holder = std::make_shared<JsonFree>( json::loads( string_replace_all( edges_json, "'", "\"" ) ) );
+    }
+    value_holders.push_back( holder );
+
+    holder->get_value_via_path( "startVertex", start_vertex, std::string("") );
+    if( start_vertex.empty() )
+    {
+        // old style json template of edge
+        const JsonBase& edge_template = *holder;
+        for( std::size_t ii=0; ii<edge_template.getChildrenCount(); ++ii )
+        {
+            auto child = edge_template.getChild( ii );
+            if( child->getKey() != "_type" )
+                add_equal_condition( child->getKey(), *child );
+        }
+        return;
+    }
+
+    out_edges = ( query_type == DBQueryBase::qEdgesFrom || query_type == DBQueryBase::qEdgesAll );
+    in_edges = ( query_type == DBQueryBase::qEdgesTo || query_type == DBQueryBase::qEdgesAll );
+    auto vertex_string = json::dump( start_vertex );
+    if( vertex_string.size() == start_vertex.size()+2 )
+        required_strings.push_back( vertex_string );
+
+    std::string edge_collections;
+    holder->get_value_via_path( "edgeCollections", edge_collections, std::string("") );
+    auto names = split( edge_collections, "," );
+    while( !names.empty() )
+    {
+        auto name = names.front();
+        names.pop();
+        trim( name );
+        if( !name.empty() )
+            query_collections.push_back( name );
+    }
+}
+
+void DBQueryMatcher::compile_aql( const std::string& aql, const std::string& bind_vars )
+{
+    std::shared_ptr<JsonFree> bind_holder;
+    if( !bind_vars.empty() )
+    {
+        bind_holder = std::make_shared<JsonFree>( json::loads( bind_vars ) );
+        value_holders.push_back( bind_holder );
+    }
+
+    AQLParser parser( aql, bind_holder.get(), value_holders );
+    JSONIO_THROW_IF( !parser.is_keyword("FOR"), "DBQueryMatcher", 8, " AQL query must start with FOR." );
+    parser.next();
+    parser.variable = parser.expect_name();
+    JSONIO_THROW_IF( !parser.is_keyword("IN"), "DBQueryMatcher", 8, " expected IN after FOR variable." );
+    parser.next();
+    if( parser.peek().kind == AQLToken::Bind )
+    {
+        auto name = parser.next().text;
+        std::string collection;
+        if( bind_holder )
+            bind_holder->get_value_via_path( name, collection, std::string("") );
+        query_collections.push_back( collection );
+    }
+    else
+        query_collections.push_back( parser.expect_name() );
+
+    while( parser.peek().kind != AQLToken::End )
+    {
+        if( parser.is_keyword("FILTER") )
+        {
+            parser.next();
+            auto condition = parser.parse_or();
+            if( filter )
+            {
+                auto both = std::make_shared<Expression>();
+                both->kind = Expression::And;
+                both->args = { filter, condition };
+                filter = both;
+            }
+            else
+                filter = condition;
+        }
+        else if( parser.is_keyword("SORT") )
+        {
+            parser.next();
+            do {
+                if( parser.is_punct(",") )
+                    parser.next();
+                auto key = parser.parse_operand();
+                bool descending = false;
+                if( parser.is_keyword("ASC") || parser.is_keyword("DESC") )
+                    descending = iequal( parser.next().text, "DESC" );
+                sort_by.emplace_back( key, descending );
+            } while( parser.is_punct(",") );
+        }
+        else if( parser.is_keyword("LIMIT") )
+        {
+            parser.next();
+            JSONIO_THROW_IF( parser.peek().kind != AQLToken::Number, "DBQueryMatcher", 9, " LIMIT must be a number." );
+            limit_count = std::stoul( parser.next().text );
+            if( parser.is_punct(",") )
+            {
+                parser.next();
+                JSONIO_THROW_IF( parser.peek().kind != AQLToken::Number, "DBQueryMatcher", 9, " LIMIT must be a number." );
+                limit_offset = limit_count;
+                limit_count = std::stoul( parser.next().text );
+            }
+        }
+        else if( parser.is_keyword("RETURN") )
+        {
+            parser.next();
+            if( parser.is_keyword("DISTINCT") )
+            {
+                parser.next();
+                return_distinct = true;
+            }
+            return_value = parser.parse_or();
+            JSONIO_THROW_IF( parser.peek().kind != AQLToken::End, "DBQueryMatcher", 10,
+                             " unsupported AQL after RETURN '" + parser.peek().text + "'." );
+        }
+        else
+            JSONIO_THROW( "DBQueryMatcher", 10, " unsupported AQL operation '" + parser.peek().text + "'." );
+    }
+
+    // raw strings from top level equality conditions
+    std::vector<Expression*> conditions = { filter.get() };
+    while( !conditions.empty() )
+    {
+        auto condition = conditions.back();
+        conditions.pop_back();
+        if( !condition )
+            continue;
+        if( condition->kind == Expression::And )
+        {
+            conditions.push_back( condition->args[0].get() );
+            conditions.push_back( condition->args[1].get() );
+        }
+        else if( condition->kind == Expression::Compare && condition->op == "==" )
+        {
+            for( const auto& arg: condition->args )
+                if( arg->kind == Expression::Literal && arg->literal )
+                {
+                    auto raw = raw_json_string( *arg->literal );
+                    if( !raw.empty() )
+                        required_strings.push_back( raw );
+                }
+            const auto& left = *condition->args[0];
+            const auto& right = *condition->args[1];
+            if( left.kind == Expression::Attribute && !left.path.empty() &&
+                    right.kind == Expression::Literal && right.literal && right.literal->isString() )
+                equal_conditions.emplace_back( left.path, right.literal->getFieldValue() );
+            else if( right.kind == Expression::Attribute && !right.path.empty() &&
+                     left.kind == Expression::Literal && left.literal && left.literal->isString() )
+                equal_conditions.emplace_back( right.path, left.literal->getFieldValue() );
+        }
+    }
+}
+
+void DBQueryMatcher::add_equal_condition( const std::string& fieldpath, const JsonBase& value )
+{
+    auto attribute = std::make_shared<Expression>();
+    attribute->kind = Expression::Attribute;
+    attribute->path = fieldpath;
+    auto literal = std::make_shared<Expression>();
+    literal->literal = &value;
+
+    auto condition = std::make_shared<Expression>();
+    condition->kind = Expression::Compare;
+    condition->op = "==";
+    condition->args = { attribute, literal };
+
+    if( filter )
+    {
+        auto both = std::make_shared<Expression>();
+        both->kind = Expression::And;
+        both->args = { filter, condition };
+        filter = both;
+    }
+    else
+        filter = condition;
+
+    auto raw = raw_json_string( value );
+    if( !raw.empty() )
+        required_strings.push_back( raw );
+    if( value.isString() )
+        equal_conditions.emplace_back( fieldpath, value.getFieldValue() );
+}
+
+namespace {
+
+const JsonBase* evaluate( const DBQueryMatcher::Expression& expr, const JsonBase& document );
+
+bool in_list( const JsonBase* value, const DBQueryMatcher::Expression& list, const JsonBase& document )
+{
+    if( list.kind == DBQueryMatcher::Expression::Array )
+    {
+        for( const auto& item: list.args )
+            if( DBQueryMatcher::compare( value, evaluate( *item, document ) ) == 0 )
+                return true;
+        return false;
+    }
+    auto list_node = evaluate( list, document );
+    if( !list_node || !list_node->isArray() )
+        return false;
+    for( std::size_t ii=0; ii<list_node->getChildrenCount(); ++ii )
+        if( DBQueryMatcher::compare( value, list_node->getChild( ii ) ) == 0 )
+            return true;
+    return false;
+}
+
+bool test( const DBQueryMatcher::Expression& expr, const JsonBase& document )
+{
+    using Expression = DBQueryMatcher::Expression;
+    switch( expr.kind )
+    {
+    case Expression::Not:
+        return !test( *expr.args[0], document );
+    case Expression::And:
+        return test( *expr.args[0], document ) && test( *expr.args[1], document );
+    case Expression::Or:
+        return test( *expr.args[0], document ) || test( *expr.args[1], document );
+    case Expression::Compare:
+    {
+        auto result = DBQueryMatcher::compare( evaluate( *expr.args[0], document ), evaluate( *expr.args[1], document ) );
+        if( expr.op == "==" ) return result == 0;
+        if( expr.op == "!=" ) return result != 0;
+        if( expr.op == "<" )  return result < 0;
+        if( expr.op == "<=" ) return result <= 0;
+        if( expr.op == ">" )  return result > 0;
+        return result >= 0;
+    }
+    case Expression::In:
+        return in_list( evaluate( *expr.args[0], document ), *expr.args[1], document );
+    case Expression::NotIn:
+        return !in_list( evaluate( *expr.args[0], document ), *expr.args[1], document );
+    case Expression::Like:
+    {
+        auto value = evaluate( *expr.args[0], document );
+        auto pattern = evaluate( *expr.args[1], document );
+        if( !value || !pattern || !pattern->isString() )
+            return false;
+        return like_match( value->toString( true ), pattern->getFieldValue() );
+    }
+    default:
+        return is_true( evaluate( expr, document ) );
+    }
+}
+
+const JsonBase* evaluate( const DBQueryMatcher::Expression& expr, const JsonBase& document )
+{
+    using Expression = DBQueryMatcher::Expression;
+    switch( expr.kind )
+    {
+    case Expression::Literal:
+        return expr.literal;
+    case Expression::Attribute:
+        return ( expr.path.empty() ? &document : document.field( expr.path ) );
+    case Expression::Array:
+    case Expression::Object:
+        JSONIO_THROW( "DBQueryMatcher", 11, " array or object could be used only into IN or RETURN." );
+    default:
+        return bool_node( test( expr, document ) );
+    }
+}
+
+/// Dense json string of expression value
+std::string dump_value( const DBQueryMatcher::Expression& expr, const JsonBase& document )
+{
+    using Expression = DBQueryMatcher::Expression;
+    std::string jsonvalue;
+    if( expr.kind == Expression::Object )
+    {
+        jsonvalue = "{";
+        for( std::size_t ii=0; ii<expr.args.size(); ++ii )
+        {
+            if( ii > 0 )
+                jsonvalue += ",";
+            jsonvalue += json::dump( expr.names[ii] ) + ":" + dump_value( *expr.args[ii], document );
+        }
+        jsonvalue += "}";
+    }
+    else if( expr.kind == Expression::Array )
+    {
+        jsonvalue = "[";
+        for( std::size_t ii=0; ii<expr.args.size(); ++ii )
+        {
+            if( ii > 0 )
+                jsonvalue += ",";
+            jsonvalue += dump_value( *expr.args[ii], document );
+        }
+        jsonvalue += "]";
+    }
+    else
+    {
+        auto node = evaluate( expr, document );
+        jsonvalue = ( node ? node->dump( true ) : "null" );
+    }
+    return jsonvalue;
+}
+
+} // namespace
+
+int DBQueryMatcher::compare( const JsonBase* left, const JsonBase* right )
+{
+    auto left_rank = type_rank( left );
+    auto right_rank = type_rank( right );
+    if( left_rank != right_rank )
+        return ( left_rank < right_rank ? -1 : 1 );
+
+    switch( left_rank )
+    {
+    case 1:
+        return static_cast<int>( left->toBool() ) - static_cast<int>( right->toBool() );
+    case 2:
+    {
+        auto left_value = left->toDouble();
+        auto right_value = right->toDouble();
+        return ( left_value < right_value ? -1 : ( right_value < left_value ? 1 : 0 ) );
+    }
+    case 3:
+        return left->getFieldValue().compare( right->getFieldValue() );
+    case 4:
+    {
+        auto size = std::min( left->getChildrenCount(), right->getChildrenCount() );
+        for( std::size_t ii=0; ii<size; ++ii )
+        {
+            auto result = compare( left->getChild( ii ), right->getChild( ii ) );
+            if( result != 0 )
+                return result;
+        }
+        return ( left->getChildrenCount() < right->getChildrenCount() ? -1 :
+                 ( left->getChildrenCount() > right->getChildrenCount() ? 1 : 0 ) );
+    }
+    case 5:
+        return left->dump( true ).compare( right->dump( true ) );
+    default:
+        return 0;
+    }
+}
+
+bool DBQueryMatcher::mayMatch( std::string_view jsondata ) const
+{
+    for( const auto& raw: required_strings )
+        if( jsondata.find( raw ) == std::string_view::npos )
+            return false;
+    return true;
+}
+
+bool DBQueryMatcher::match( const JsonBase& document ) const
+{
+    if( isEdgesQuery() )
+    {
+        std::string vertex;
+        bool linked = ( out_edges && document.get_value_via_path( "_from", vertex, std::string("") ) && vertex == start_vertex ) ||
+                      ( in_edges && document.get_value_via_path( "_to", vertex, std::string("") ) && vertex == start_vertex );
+        if( !linked )
+            return false;
+    }
+    return ( !filter || test( *filter, document ) );
+}
+
+bool DBQueryMatcher::selectsDocuments() const
+{
+    if( isEdgesQuery() || limit_offset > 0 || limit_count != std::string::npos )
+        return false;
+    return !return_value || ( return_value->kind == Expression::Attribute && return_value->path.empty() );
+}
+
+std::string DBQueryMatcher::result( const JsonBase& document, const std::string& jsondata ) const
+{
+    if( return_value )
+        return dump_value( *return_value, document );
+    if( !query_fields.empty() )
+        return project( document, query_fields );
+    return jsondata;
+}
+
+std::string DBQueryMatcher::project( const JsonBase& document, const fields2query_t& map_fields )
+{
+    std::string jsonvalue = "{";
+    for( const auto& field: map_fields )
+    {
+        if( jsonvalue.size() > 1 )
+            jsonvalue += ",";
+        auto node = document.field( field.first );
+        jsonvalue += json::dump( field.second ) + ":" + ( node ? node->dump( true ) : "null" );
+    }
+    jsonvalue += "}";
+    return jsonvalue;
+}
+
+void DBQueryMatcher::select( const Scan_f& scan, SetReaded_f setfnc ) const
+{
+    std::set<std::string> distinct_values;
+    auto send_result = [&]( std::string&& jsonresult )
+    {
+        if( return_distinct && !distinct_values.insert( jsonresult ).second )
+            return;
+        setfnc( jsonresult );
+    };
+
+    if( sort_by.empty() )
+    {
+        std::size_t matched = 0;
+        scan( [&]( const JsonBase& document, const std::string& jsondata )
+        {
+            if( !match( document ) )
+                return;
+            auto number = matched++;
+            if( number < limit_offset || number-limit_offset >= limit_count )
+                return;
+            send_result( result( document, jsondata ) );
+        });
+        return;
+    }
+
+    // SORT needs all matched documents
+    struct SortedResult
+    {
+        std::vector<std::shared_ptr<JsonFree>> keys;
+        std::string jsonresult;
+    };
+    std::vector<SortedResult> sorted;
+    scan( [&]( const JsonBase& document, const std::string& jsondata )
+    {
+        if( !match( document ) )
+            return;
+        SortedResult line;
+        for( const auto& key: sort_by )
+            line.keys.push_back( std::make_shared<JsonFree>(
+                                     json::loads( "{ \"v\": " + dump_value( *key.first, document ) + " }" ) ) );
+        line.jsonresult = result( document, jsondata );
+        sorted.push_back( std::move(line) );
+    });
+
+    std::stable_sort( sorted.begin(), sorted.end(), [this]( const SortedResult& left, const SortedResult& right )
+    {
+        for( std::size_t ii=0; ii<sort_by.size(); ++ii )
+        {
+            auto result = compare( left.keys[ii]->field( "v" ), right.keys[ii]->field( "v" ) );
+            if( result != 0 )
+                return ( sort_by[ii].second ? result > 0 : result < 0 );
+        }
+        return false;
+    });
+
+    for( std::size_t ii=limit_offset; ii<sorted.size() && ii-limit_offset<limit_count; ++ii )
+        send_result( std::move( sorted[ii].jsonresult ) );
+}
+
+} // namespace jsonio
@@ -74,13 +74,21 @@ values_table_t DBSchemaDocument::downloadDocumentsbySchema(const DBQueryBase &qu
 {
     values_table_t records_values;
 
+    JsonProjection projection( queryFields );
+
     SetReaded_f setfnc = [&, queryFields]( const std::string& jsondata )
     {
-        auto jsonbase = json::loads(schema_name, jsondata);
-        auto flds_values = extract_fields( queryFields, jsonbase );
+        std::string key;
         values_t row_data;
-        for( const auto& fld: queryFields)
-            row_data.push_back( flds_values[fld] );
+        // missing fields get the schema defaults, so the full parse is needed
+        if( !project_line( projection, jsondata, queryFields.size(), nullptr, key, row_data ) )
+        {
+            auto jsonbase = json::loads(schema_name, jsondata);
+            auto flds_values = extract_fields( queryFields, jsonbase );
+            row_data.clear();
+            for( const auto& fld: queryFields)
+                row_data.push_back( flds_values[fld] );
+        }
         records_values.push_back(row_data);
     };
 
@@ -92,13 +100,21 @@ values_table_t DBSchemaDocument::downloadDocumentsbySchema( const std::vector<st
 {
     values_table_t records_values;
 
+    JsonProjection projection( queryFields );
+
     SetReaded_f setfnc = [&, queryFields]( const std::string& jsondata )
     {
-        auto jsonbase = json::loads(schema_name, jsondata);
-        auto flds_values = extract_fields( queryFields, jsonbase );
+        std::string key;
         values_t row_data;
-        for( const auto& fld: queryFields)
-            row_data.push_back( flds_values[fld] );
+        // missing fields get the schema defaults, so the full parse is needed
+        if( !project_line( projection, jsondata, queryFields.size(), nullptr, key, row_data ) )
+        {
+            auto jsonbase = json::loads(schema_name, jsondata);
+            auto flds_values = extract_fields( queryFields, jsonbase );
+            row_data.clear();
+            for( const auto& fld: queryFields)
+                row_data.push_back( flds_values[fld] );
+        }
         records_values.push_back(row_data);
     };
 
@@ -113,19 +129,29 @@ void DBSchemaDocument::update_query()
         std::lock_guard<std::shared_mutex> g(query_result_mutex);
 
         query_result->clear();
+        const auto& fields = query_result->query().fields();
+        auto projection = make_line_projection( fields );
         SetReaded_f setfnc = [&]( const std::string& jsondata )
         {
+            std::string key;
+            values_t values;
             if( query_result->condition().isOnlyFieldsQuery() )
             {
                 auto json_free = json::loads( jsondata );
-                auto key = collection_from->getKeyFrom( json_free/*, query_result->condition().queryFields()*/ );
+                key = collection_from->getKeyFrom( json_free/*, query_result->condition().queryFields()*/ );
                 query_result->add_line_fields( key, json_free, query_result->condition().queryFields() );
             }
+            else if( project_line( projection, jsondata, fields.size(), nullptr, key, values ) )
+            {
+                for( auto& value: values )
+                    trim( value );
+                query_result->add_line_values( key, values );
+            }
             else
             {
                 auto json_schema = json::loads( schema_name, jsondata );
-                auto key = collection_from->getKeyFrom( json_schema );
-                query_result->add_line( key,  json_schema, false );
+                key = collection_from->getKeyFrom( json_schema );
+                query_result->add_line_document( key,  json_schema );
             }
         };
 
@@ -131,21 +131,18 @@ void DBVertexDocument::before_load(const std::string & key)
 
 void DBVertexDocument::before_remove(const std::string & vertex_id )
 {
-    /*string bsonquery = "{  \"_type\": \"edge\",  \"$or\": [ { \"_to\":  \"";
-           bsonquery += _vertexid + "\" }, { \"_from\": \"";
-           bsonquery += _vertexid + "\" } ], \"$dropall\": true }";
-    DBQueryData  query( bsonquery, DBQueryData::qEJDB );*/
-
-    std::shared_ptr<DBEdgeDocument> edges( documentAllEdges( collection_from->db_connect ));
-    auto edgekeys =  getKeysByQuery( allEdgesQuery( vertex_id ) );
-    for( const auto& idedge: edgekeys )
+    // edges are grouped by collections and removed by one request for each collection
+    std::map<std::string, std::vector<std::string>> collections_edges;
+    for( auto& idedge: getKeysByQuery( allEdgesQuery( vertex_id ) ) )
     {
-        edges->resetSchema( edges->extractSchemaFromId(idedge), false );
-        edges->deleteDocument(idedge);
+        auto pos = idedge.find( '/' );
+        if( pos == std::string::npos )
+            continue;
+        auto collname = idedge.substr( 0, pos );
+        collections_edges[collname].push_back( std::move(idedge) );
     }
-
-    // very slow
-    // collection_from->deleteEdges( vertex_id );
+    for( const auto& edges: collections_edges )
+        collection_from->db_connect.collection( edges.first, "edge" )->removeByKeys( edges.second );
 }
 
 unique_fields_map_t::iterator DBVertexDocument::unique_line_by_id( const std::string& idschem )
@@ -160,15 +157,51 @@ unique_fields_map_t::iterator DBVertexDocument::unique_line_by_id( const std::st
     return itrow;
 }
 
-void DBVertexDocument::after_remove(const std::string & vertex_id)
+void DBVertexDocument::remove_unique_lines( const std::vector<std::string>& keys )
 {
-    // delete from unique map
-    if( !unique_fields_names.empty() )
+    if( unique_fields_names.empty() )
+        return;
+    std::set<std::string> removed_keys( keys.begin(), keys.end() );
+    std::lock_guard<std::mutex> g(unique_fields_mutex);
+    auto itrow = unique_fields_values.begin();
+    while( itrow != unique_fields_values.end() )
+    {
+        if( removed_keys.find( itrow->second ) != removed_keys.end() )
+            itrow = unique_fields_values.erase( itrow );
+        else
+            itrow++;
+    }
+}
+
+void DBVertexDocument::add_line( const std::string& key_str, const JsonBase& nodedata, bool isupdate )
+{
+    // the vertex collection can contain documents of other labels
+    std::string label;
+    nodedata.get_value_via_path( "_label", label, object_label );
+    if( !object_label.empty() && label != object_label )
     {
-        auto itr = unique_line_by_id( vertex_id );
-        if( itr != unique_fields_values.end() )
-            unique_fields_values.erase(itr);
+        if( isupdate )
+            DBSchemaDocument::delete_line( key_str );
+        return;
     }
+    DBSchemaDocument::add_line( key_str, nodedata, isupdate );
+}
+
+void DBVertexDocument::update_line( const std::string& key_str, const JsonBase& nodedata )
+{
+    add_line( key_str, nodedata, true );
+}
+
+void DBVertexDocument::delete_line( const std::string& key_str )
+{
+    DBSchemaDocument::delete_line( key_str );
+    remove_unique_lines( { key_str } );
+}
+
+void DBVertexDocument::delete_lines( const std::vector<std::string>& keys )
+{
+    DBSchemaDocument::delete_lines( keys );
+    remove_unique_lines( keys );
 }
 
 void DBVertexDocument::before_save_update(std::string & key)
@@ -184,6 +217,7 @@ void DBVertexDocument::before_save_update(std::string & key)
         for( size_t ii=0; ii<unique_fields_names.size()-1; ii++ )
             uniq_values.push_back( uniq_fields[unique_fields_names[ii]] );
 
+        std::lock_guard<std::mutex> g(unique_fields_mutex);
         auto itfind = unique_fields_values.find( uniq_values );
         if( itfind != unique_fields_values.end() )
         {
@@ -193,12 +227,13 @@ void DBVertexDocument::before_save_update(std::string & key)
     }
 }
 
-void DBVertexDocument::after_save_update(const std::string &)
+void DBVertexDocument::after_save_update( const std::string &, const JsonBase& saved_data )
 {
     if( !unique_fields_names.empty() )
     {
-        auto uniq_fields = extract_fields( unique_fields_names, current_schema_object );
+        auto uniq_fields = extract_fields( unique_fields_names, saved_data );
 
+        std::lock_guard<std::mutex> g(unique_fields_mutex);
         // delete old
         auto itrow = unique_line_by_id( uniq_fields["_id"] );
         if( itrow != unique_fields_values.end() )
@@ -218,6 +253,7 @@ void DBVertexDocument::after_save_update(const std::string &)
 
 void DBVertexDocument::load_unique_fields()
 {
+    std::lock_guard<std::mutex> g(unique_fields_mutex);
     unique_fields_names.clear();
     unique_fields_values.clear();
 
@@ -0,0 +1,621 @@
+#include <fstream>
+
+#ifdef _MSC_VER
+#include  <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef JSONIO_WITH_ZLIB
+#include <zlib.h>
+#endif
+#ifdef JSONIO_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+#include "jsonio/file_stream.h"
+#include "jsonio/exceptions.h"
+
+namespace jsonio {
+
+/// Modes of writing data to encoder
+enum EncodeModes {
+    encContinue = 0,   ///< Data could be kept into encoder
+    encFlush = 1,      ///< All data must be written to file
+    encFinish = 2      ///< Write the end of compressed data
+};
+
+static const std::size_t codec_buffer_size = 256*1024;
+
+static double seconds_from( std::chrono::steady_clock::time_point start_time )
+{
+    return std::chrono::duration<double>( std::chrono::steady_clock::now()-start_time ).count();
+}
+
+Compression compression_from_path( const std::string& file_path )
+{
+    auto pos = file_path.rfind( '.' );
+    if( pos == std::string::npos )
+        return Compression::None;
+    auto ext = file_path.substr( pos+1 );
+    if( ext == "gz" )
+        return Compression::Gzip;
+    if( ext == "zst" )
+        return Compression::Zstd;
+    return Compression::None;
+}
+
+bool compression_supported( Compression compression )
+{
+    switch( compression )
+    {
+    case Compression::None:
+        return true;
+    case Compression::Gzip:
+#ifdef JSONIO_WITH_ZLIB
+        return true;
+#else
+        return false;
+#endif
+    case Compression::Zstd:
+#ifdef JSONIO_WITH_ZSTD
+        return true;
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+static std::FILE* open_file( const std::string& file_path, const char* mode, Compression compression )
+{
+    JSONIO_THROW_IF( !compression_supported( compression ), "filesystem", 10,
+                     "compression of file is not supported by build  " + file_path );
+    auto file = std::fopen( file_path.c_str(), mode );
+    JSONIO_THROW_IF( !file, "filesystem", 4, "file open error...  " + file_path );
+    // data is buffered by stream buffers and codecs
+    std::setvbuf( file, nullptr, _IONBF, 0 );
+    return file;
+}
+
+//  MappedFile -----------------------------------------------------------------------
+
+bool MappedFile::use_mmap = true;
+
+MappedFile::MappedFile( const std::string& file_path, bool sequential )
+{
+    if( !use_mmap || !map_file( file_path, sequential ) )
+    {
+        std::ifstream input( file_path, std::ios::binary );
+        JSONIO_THROW_IF( !input.good(), "filesystem", 4, "file open error...  " + file_path );
+        input.seekg( 0, std::ios::end );
+        buffer.resize( static_cast<std::size_t>( input.tellg() ) );
+        input.seekg( 0, std::ios::beg );
+        input.read( buffer.data(), static_cast<std::streamsize>( buffer.size() ) );
+        JSONIO_THROW_IF( static_cast<std::size_t>( input.gcount() ) != buffer.size(), "filesystem", 4,
+                         "file read error...  " + file_path );
+        text = buffer;
+    }
+    // skip over optional BOM http://unicode.org/faq/utf_bom.html
+    if( text.size() >= 3 && text.compare( 0, 3, "\xef\xbb\xbf" ) == 0 )
+        text.remove_prefix( 3 );
+}
+
+MappedFile::~MappedFile()
+{
+#ifndef _MSC_VER
+    if( mapped_data )
+        munmap( mapped_data, mapped_size );
+#endif
+}
+
+bool MappedFile::map_file( const std::string& file_path, bool sequential )
+{
+#ifdef _MSC_VER
+    (void)file_path;
+    (void)sequential;
+    return false;
+#else
+    int fd = open( file_path.c_str(), O_RDONLY );
+    JSONIO_THROW_IF( fd < 0, "filesystem", 4, "file open error...  " + file_path );
+    struct stat file_stat;
+    // empty and not regular files are read into buffer
+    if( fstat( fd, &file_stat ) != 0 || !S_ISREG( file_stat.st_mode ) || file_stat.st_size <= 0 )
+    {
+        close( fd );
+        return false;
+    }
+    auto size = static_cast<std::size_t>( file_stat.st_size );
+    void* data = mmap( nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    close( fd );
+    if( data == MAP_FAILED )
+        return false;
+#ifdef MADV_SEQUENTIAL
+    if( sequential )
+        madvise( data, size, MADV_SEQUENTIAL );
+#endif
+    mapped_data = data;
+    mapped_size = size;
+    text = std::string_view( static_cast<const char*>( data ), size );
+    return true;
+#endif
+}
+
+//  Decoders -------------------------------------------------------------------------
+
+/// Reads data from file
+class FileReadBuffer::Codec
+{
+
+public:
+
+    Codec( std::FILE* afile, const std::string& path ):
+        file( afile ), file_path( path )
+    {}
+    virtual ~Codec()
+    {}
+
+    /// Read decoded data ( 0 - end of file )
+    virtual std::size_t read( char* data, std::size_t size ) = 0;
+
+    std::uint64_t fileBytes() const
+    {
+        return file_bytes;
+    }
+
+protected:
+
+    std::FILE* file;
+    const std::string& file_path;
+    std::uint64_t file_bytes = 0;
+
+    std::size_t read_file( char* data, std::size_t size )
+    {
+        auto readed = std::fread( data, 1, size, file );
+        JSONIO_THROW_IF( readed < size && std::ferror( file ), "filesystem", 4, "file read error...  " + file_path );
+        file_bytes += readed;
+        return readed;
+    }
+};
+
+class PlainDecoder : public FileReadBuffer::Codec
+{
+
+public:
+
+    using Codec::Codec;
+
+    std::size_t read( char* data, std::size_t size ) override
+    {
+        return read_file( data, size );
+    }
+};
+
+#ifdef JSONIO_WITH_ZLIB
+class GzipDecoder : public FileReadBuffer::Codec
+{
+
+public:
+
+    GzipDecoder( std::FILE* afile, const std::string& path ):
+        Codec( afile, path ), input( codec_buffer_size )
+    {
+        // gzip or zlib header is detected automatically
+        JSONIO_THROW_IF( inflateInit2( &zstream, 15+32 ) != Z_OK, "filesystem", 11,
+                         "decompression error...  " + file_path );
+    }
+
+    ~GzipDecoder()
+    {
+        inflateEnd( &zstream );
+    }
+
+    std::size_t read( char* data, std::size_t size ) override
+    {
+        zstream.next_out = reinterpret_cast<Bytef*>( data );
+        zstream.avail_out = static_cast<uInt>( size );
+        while( zstream.avail_out == size )
+        {
+            if( zstream.avail_in == 0 )
+            {
+                auto readed = read_file( input.data(), input.size() );
+                if( readed == 0 )
+                {
+                    JSONIO_THROW_IF( !stream_ended && file_bytes > 0, "filesystem", 11,
+                                     "unexpected end of compressed file  " + file_path );
+                    break;
+                }
+                zstream.next_in = reinterpret_cast<Bytef*>( input.data() );
+                zstream.avail_in = static_cast<uInt>( readed );
+            }
+            // concatenated gzip members
+            if( stream_ended )
+            {
+                inflateReset( &zstream );
+                stream_ended = false;
+            }
+            auto ret = inflate( &zstream, Z_NO_FLUSH );
+            if( ret == Z_STREAM_END )
+                stream_ended = true;
+            else
+                JSONIO_THROW_IF( ret != Z_OK && !( ret == Z_BUF_ERROR && zstream.avail_in == 0 ),
+                                 "filesystem", 11, "decompression error...  " + file_path );
+        }
+        return size-zstream.avail_out;
+    }
+
+protected:
+
+    z_stream zstream = {};
+    std::vector<char> input;
+    bool stream_ended = false;
+};
+#endif
+
+#ifdef JSONIO_WITH_ZSTD
+class ZstdDecoder : public FileReadBuffer::Codec
+{
+
+public:
+
+    ZstdDecoder( std::FILE* afile, const std::string& path ):
+        Codec( afile, path ), input( ZSTD_DStreamInSize() ), context( ZSTD_createDCtx() )
+    {
+        JSONIO_THROW_IF( !context, "filesystem", 11, "decompression error...  " + file_path );
+    }
+
+    ~ZstdDecoder()
+    {
+        ZSTD_freeDCtx( context );
+    }
+
+    std::size_t read( char* data, std::size_t size ) override
+    {
+        ZSTD_outBuffer output = { data, size, 0 };
+        while( output.pos == 0 )
+        {
+            if( input_buffer.pos == input_buffer.size )
+            {
+                auto readed = read_file( input.data(), input.size() );
+                if( readed == 0 )
+                {
+                    JSONIO_THROW_IF( frame_remaining != 0, "filesystem", 11,
+                                     "unexpected end of compressed file  " + file_path );
+                    break;
+                }
+                input_buffer = { input.data(), readed, 0 };
+            }
+            frame_remaining = ZSTD_decompressStream( context, &output, &input_buffer );
+            JSONIO_THROW_IF( ZSTD_isError( frame_remaining ), "filesystem", 11,
+                             "decompression error...  " + file_path );
+        }
+        return output.pos;
+    }
+
+protected:
+
+    std::vector<char> input;
+    ZSTD_inBuffer input_buffer = { nullptr, 0, 0 };
+    ZSTD_DCtx* context;
+    std::size_t frame_remaining = 0;
+};
+#endif
+
+//  FileReadBuffer -------------------------------------------------------------------
+
+FileReadBuffer::FileReadBuffer( const std::string& path, Compression compression, std::size_t buffer_size ):
+    file_path( path ), buffer( buffer_size ), start_time( std::chrono::steady_clock::now() )
+{
+    file = open_file( file_path, "rb", compression );
+    try {
+        switch( compression )
+        {
+#ifdef JSONIO_WITH_ZLIB
+        case Compression::Gzip:
+            decoder = std::make_unique<GzipDecoder>( file, file_path );
+            break;
+#endif
+#ifdef JSONIO_WITH_ZSTD
+        case Compression::Zstd:
+            decoder = std::make_unique<ZstdDecoder>( file, file_path );
+            break;
+#endif
+        default:
+            decoder = std::make_unique<PlainDecoder>( file, file_path );
+            break;
+        }
+    }
+    catch(...)
+    {
+        std::fclose( file );
+        throw;
+    }
+    setg( buffer.data(), buffer.data(), buffer.data() );
+}
+
+FileReadBuffer::~FileReadBuffer()
+{
+    decoder.reset();
+    if( file )
+        std::fclose( file );
+}
+
+StreamStatistics FileReadBuffer::statistics() const
+{
+    return StreamStatistics{ decoder->fileBytes(), data_bytes, seconds_from( start_time ) };
+}
+
+FileReadBuffer::int_type FileReadBuffer::underflow()
+{
+    if( gptr() < egptr() )
+        return traits_type::to_int_type( *gptr() );
+    auto readed = decoder->read( buffer.data(), buffer.size() );
+    if( readed == 0 )
+        return traits_type::eof();
+    data_bytes += readed;
+    setg( buffer.data(), buffer.data(), buffer.data()+readed );
+    return traits_type::to_int_type( *gptr() );
+}
+
+//  Encoders -------------------------------------------------------------------------
+
+/// Writes data to file
+class FileWriteBuffer::Codec
+{
+
+public:
+
+    Codec( std::FILE* afile, const std::string& path ):
+        file( afile ), file_path( path )
+    {}
+    virtual ~Codec()
+    {}
+
+    /// Encode data and write to file
+    /// \param mode - encContinue, encFlush or encFinish
+    virtual void write( const char* data, std::size_t size, int mode ) = 0;
+
+    std::uint64_t fileBytes() const
+    {
+        return file_bytes;
+    }
+
+protected:
+
+    std::FILE* file;
+    const std::string& file_path;
+    std::uint64_t file_bytes = 0;
+
+    void write_file( const char* data, std::size_t size )
+    {
+        JSONIO_THROW_IF( std::fwrite( data, 1, size, file ) != size, "filesystem", 5,
+                         "file save error...  " + file_path );
+        file_bytes += size;
+    }
+};
+
+class PlainEncoder : public FileWriteBuffer::Codec
+{
+
+public:
+
+    using Codec::Codec;
+
+    void write( const char* data, std::size_t size, int ) override
+    {
+        write_file( data, size );
+    }
+
+    /// Bytes will be overwritten
+    void seekBack( std::size_t size )
+    {
+        JSONIO_THROW_IF( std::fseek( file, -static_cast<long>( size ), SEEK_CUR ) != 0, "filesystem", 5,
+                         "file save error...  " + file_path );
+        file_bytes -= size;
+    }
+};
+
+#ifdef JSONIO_WITH_ZLIB
+class GzipEncoder : public FileWriteBuffer::Codec
+{
+
+public:
+
+    GzipEncoder( std::FILE* afile, const std::string& path ):
+        Codec( afile, path ), output( codec_buffer_size )
+    {
+        JSONIO_THROW_IF( deflateInit2( &zstream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15+16, 8,
+                                       Z_DEFAULT_STRATEGY ) != Z_OK, "filesystem", 11,
+                         "compression error...  " + file_path );
+    }
+
+    ~GzipEncoder()
+    {
+        deflateEnd( &zstream );
+    }
+
+    void write( const char* data, std::size_t size, int mode ) override
+    {
+        int flush = ( mode == encFinish ? Z_FINISH : ( mode == encFlush ? Z_SYNC_FLUSH : Z_NO_FLUSH ) );
+        zstream.next_in = reinterpret_cast<Bytef*>( const_cast<char*>( data ) );
+        zstream.avail_in = static_cast<uInt>( size );
+        do {
+            zstream.next_out = reinterpret_cast<Bytef*>( output.data() );
+            zstream.avail_out = static_cast<uInt>( output.size() );
+            auto ret = deflate( &zstream, flush );
+            JSONIO_THROW_IF( ret == Z_STREAM_ERROR, "filesystem", 11, "compression error...  " + file_path );
+            write_file( output.data(), output.size()-zstream.avail_out );
+        } while( zstream.avail_out == 0 );
+    }
+
+protected:
+
+    z_stream zstream = {};
+    std::vector<char> output;
+};
+#endif
+
+#ifdef JSONIO_WITH_ZSTD
+class ZstdEncoder : public FileWriteBuffer::Codec
+{
+
+public:
+
+    ZstdEncoder( std::FILE* afile, const std::string& path ):
+        Codec( afile, path ), output( ZSTD_CStreamOutSize() ), context( ZSTD_createCCtx() )
+    {
+        JSONIO_THROW_IF( !context, "filesystem", 11, "compression error...  " + file_path );
+        ZSTD_CCtx_setParameter( context, ZSTD_c_compressionLevel, 3 );
+    }
+
+    ~ZstdEncoder()
+    {
+        ZSTD_freeCCtx( context );
+    }
+
+    void write( const char* data, std::size_t size, int mode ) override
+    {
+        auto directive = ( mode == encFinish ? ZSTD_e_end : ( mode == encFlush ? ZSTD_e_flush : ZSTD_e_continue ) );
+        ZSTD_inBuffer input = { data, size, 0 };
+        bool finished = false;
+        while( !finished )
+        {
+            ZSTD_outBuffer output_buffer = { output.data(), output.size(), 0 };
+            auto remaining = ZSTD_compressStream2( context, &output_buffer, &input, directive );
+            JSONIO_THROW_IF( ZSTD_isError( remaining ), "filesystem", 11, "compression error...  " + file_path );
+            write_file( output.data(), output_buffer.pos );
+            finished = ( directive == ZSTD_e_continue ? input.pos == input.size : remaining == 0 );
+        }
+    }
+
+protected:
+
+    std::vector<char> output;
+    ZSTD_CCtx* context;
+};
+#endif
+
+//  FileWriteBuffer ------------------------------------------------------------------
+
+FileWriteBuffer::FileWriteBuffer( const std::string& path, Compression compression,
+                                  bool append, std::size_t buffer_size ):
+    file_path( path ), compression_type( compression ), buffer( buffer_size ),
+    start_time( std::chrono::steady_clock::now() )
+{
+    file = open_file( file_path, ( append ? "ab" : "wb" ), compression );
+    try {
+        switch( compression )
+        {
+#ifdef JSONIO_WITH_ZLIB
+        case Compression::Gzip:
+            encoder = std::make_unique<GzipEncoder>( file, file_path );
+            break;
+#endif
+#ifdef JSONIO_WITH_ZSTD
+        case Compression::Zstd:
+            encoder = std::make_unique<ZstdEncoder>( file, file_path );
+            break;
+#endif
+        default:
+            encoder = std::make_unique<PlainEncoder>( file, file_path );
+            break;
+        }
+    }
+    catch(...)
+    {
+        std::fclose( file );
+        throw;
+    }
+    setp( buffer.data(), buffer.data()+buffer.size() );
+}
+
+FileWriteBuffer::~FileWriteBuffer()
+{
+    if( file )
+    {
+        try {
+            close();
+        }
+        catch( std::exception& e )
+        {
+            io_logger->error("Error closing file: {}", e.what());
+        }
+    }
+}
+
+StreamStatistics FileWriteBuffer::statistics() const
+{
+    return StreamStatistics{ encoder->fileBytes(), data_bytes, seconds_from( start_time ) };
+}
+
+void FileWriteBuffer::write_buffer( int mode )
+{
+    JSONIO_THROW_IF( !file, "filesystem", 5, "file was closed  " + file_path );
+    auto size = static_cast<std::size_t>( pptr()-pbase() );
+    data_bytes += size;
+    encoder->write( pbase(), size, mode );
+    setp( buffer.data(), buffer.data()+buffer.size() );
+}
+
+FileWriteBuffer::int_type FileWriteBuffer::overflow( int_type ch )
+{
+    write_buffer( encContinue );
+    if( !traits_type::eq_int_type( ch, traits_type::eof() ) )
+    {
+        *pptr() = traits_type::to_char_type( ch );
+        pbump( 1 );
+    }
+    return traits_type::not_eof( ch );
+}
+
+int FileWriteBuffer::sync()
+{
+    write_buffer( encContinue );
+    return 0;
+}
+
+void FileWriteBuffer::flush( bool to_disk )
+{
+    write_buffer( encFlush );
+    bool flushed = ( std::fflush( file ) == 0 );
+    if( to_disk )
+    {
+#ifdef _MSC_VER
+        flushed = flushed && ( _commit( _fileno( file ) ) == 0 );
+#else
+        flushed = flushed && ( fsync( fileno( file ) ) == 0 );
+#endif
+    }
+    JSONIO_THROW_IF( !flushed, "filesystem", 5, "file save error...  " + file_path );
+}
+
+void FileWriteBuffer::seekBack( std::size_t back_size )
+{
+    JSONIO_THROW_IF( !seekable(), "filesystem", 5, "compressed file could not be overwritten  " + file_path );
+    write_buffer( encContinue );
+    data_bytes -= back_size;
+    static_cast<PlainEncoder*>( encoder.get() )->seekBack( back_size );
+}
+
+void FileWriteBuffer::close()
+{
+    if( !file )
+        return;
+    std::FILE* closed_file = file;
+    try {
+        write_buffer( encFinish );
+    }
+    catch(...)
+    {
+        file = nullptr;
+        std::fclose( closed_file );
+        throw;
+    }
+    file = nullptr;
+    JSONIO_THROW_IF( std::fclose( closed_file ) != 0, "filesystem", 5, "file save error...  " + file_path );
+}
+
+} // namespace jsonio
@@ -1,6 +1,8 @@
 #include "jsonio/io_settings.h"
 #include "jsonio/schema_thrift.h"
 #include "jsonio/dbconnect.h"
+#include "jsonio/jsondump.h"
+#include <spdlog/async.h>
 #include <spdlog/sinks/stdout_color_sinks.h>
 #include <spdlog/sinks/rotating_file_sink.h>
 
@@ -14,6 +16,8 @@ std::string JsonioSettings::logger_section_name = "log";
 std::string JsonioSettings::data_logger_directory = "";
 size_t JsonioSettings::log_file_size = 1048576;
 size_t JsonioSettings::log_file_count = 1;
+size_t JsonioSettings::log_async_queue_size = 8192;
+size_t JsonioSettings::log_async_threads = 1;
 
 
 JsonioSettings& ioSettings()
@@ -25,7 +29,13 @@ JsonioSettings& ioSettings()
 
 void SectionSettings::sync() const
 {
-    io_settins.sync();
+    io_settins.invalidate_snapshot();
+    io_settins.settings_changed();
+}
+
+std::mutex& SectionSettings::changes_mutex() const
+{
+    return io_settins.sync_mutex;
 }
 
 std::string SectionSettings::directoryPath( const std::string& fldpath, const std::string& defvalue ) const
@@ -51,13 +61,129 @@ JsonioSettings::JsonioSettings(const std::string& config_file_path):
 JsonioSettings::~JsonioSettings()
 {
     //        sync(); Temporarily disabled by DK on 3.07.19 to test abnormal behavior of GEMSW
+    stop_sync();
+    // only changes not written because of delay or unfinished batch
+    std::lock_guard<std::mutex> lock( sync_mutex );
+    if( sync_pending )
+    {
+        try {
+            write_settings();
+        }
+        catch( ... )
+        {
+            // the logger could be already destroyed
+        }
+    }
+}
 
+void JsonioSettings::sync() const
+{
+    std::lock_guard<std::mutex> lock( sync_mutex );
+    write_settings();
+}
+
+void JsonioSettings::beginUpdate()
+{
+    std::lock_guard<std::mutex> lock( sync_mutex );
+    update_depth++;
+}
+
+void JsonioSettings::endUpdate()
+{
+    {
+        std::lock_guard<std::mutex> lock( sync_mutex );
+        if( update_depth > 0 )
+            update_depth--;
+        if( update_depth > 0 || !sync_pending )
+            return;
+    }
+    settings_changed();
+}
+
+void JsonioSettings::setSyncDelay( std::chrono::milliseconds delay )
+{
+    bool stop_thread = false;
+    {
+        std::lock_guard<std::mutex> lock( sync_mutex );
+        sync_delay = delay;
+        stop_thread = ( sync_delay.count() <= 0 && sync_thread.joinable() );
+    }
+    if( stop_thread )
+    {
+        stop_sync();
+        std::lock_guard<std::mutex> lock( sync_mutex );
+        stop_sync_thread = false;
+        if( sync_pending && update_depth == 0 )
+            write_settings();
+    }
+}
+
+void JsonioSettings::settings_changed() const
+{
+    std::lock_guard<std::mutex> lock( sync_mutex );
+    sync_pending = true;
+    if( update_depth > 0 )
+        return;
+    if( sync_delay.count() <= 0 )
+    {
+        write_settings();
+        return;
+    }
+    sync_deadline = std::chrono::steady_clock::now() + sync_delay;
+    if( !sync_thread.joinable() )
+        sync_thread = std::thread( &JsonioSettings::sync_thread_loop, this );
+    sync_condition.notify_all();
+}
+
+void JsonioSettings::write_settings() const
+{
+    config_file.save_atomic( all_settings );
+    sync_pending = false;
+}
+
+void JsonioSettings::sync_thread_loop() const
+{
+    std::unique_lock<std::mutex> lock( sync_mutex );
+    while( !stop_sync_thread )
+    {
+        if( !sync_pending || update_depth > 0 )
+        {
+            sync_condition.wait( lock );
+            continue;
+        }
+        // the deadline is moved by each change
+        if( std::chrono::steady_clock::now() < sync_deadline )
+        {
+            sync_condition.wait_until( lock, sync_deadline );
+            continue;
+        }
+        try {
+            write_settings();
+        }
+        catch( std::exception& e )
+        {
+            sync_pending = false;
+            io_logger->error("Error writing settings {}: {}", config_file.path(), e.what());
+        }
+    }
+}
+
+void JsonioSettings::stop_sync()
+{
+    {
+        std::lock_guard<std::mutex> lock( sync_mutex );
+        stop_sync_thread = true;
+    }
+    sync_condition.notify_all();
+    if( sync_thread.joinable() )
+        sync_thread.join();
 }
 
 void JsonioSettings::getDataFromPreferences()
 {
     if( config_file.exist() )
         config_file.load( all_settings );
+    invalidate_snapshot();
     JsonFree& data = all_settings.add_object_via_path(jsonio_section_name);
     jsonio_section.change_head( &data );
     HomeDir = value( "common.UserHomeDirectoryPath", std::string("") );
@@ -87,6 +213,7 @@ void JsonioSettings::setUserDir(const std::string& dir_path)
         return;
     setValue( "common.WorkDirectoryPath", dir_path );
     UserDir = directoryPath("common.WorkDirectoryPath", std::string("."));
+    invalidate_snapshot();
 }
 
 void JsonioSettings::setHomeDir( const std::string& dir_path )
@@ -94,9 +221,64 @@ void JsonioSettings::setHomeDir( const std::string& dir_path )
     setValue( "common.UserHomeDirectoryPath", dir_path );
     HomeDir = value( "common.UserHomeDirectoryPath", std::string("") );
     HomeDir = expand_home_dir( HomeDir, "" ); // "~" or empty generally refers to the user's home directory
+    invalidate_snapshot();
+}
+
+SettingsUpdate::~SettingsUpdate()
+{
+    try {
+        io_settings.endUpdate();
+    }
+    catch( std::exception& e )
+    {
+        io_logger->error("Error writing settings: {}", e.what());
+    }
+}
+
+std::shared_ptr<const SettingsSnapshot> JsonioSettings::snapshot() const
+{
+    std::lock_guard<std::mutex> lock( snapshot_mutex );
+    if( !settings_snapshot )
+        settings_snapshot = build_snapshot();
+    return settings_snapshot;
 }
 
-void JsonioSettings::addSchemaFormat(const std::string &format_type, const std::string &json_string)
+void JsonioSettings::invalidate_snapshot() const
+{
+    std::lock_guard<std::mutex> lock( snapshot_mutex );
+    settings_snapshot.reset();
+}
+
+std::shared_ptr<const SettingsSnapshot> JsonioSettings::build_snapshot() const
+{
+    auto data = std::make_shared<SettingsSnapshot>();
+    // values are read from the copy dumped under sync_mutex, so they are consistent with settings_json
+    data->settings_json = dump();
+    auto settings = json::loads( data->settings_json );
+
+    auto optional_value = [&settings]( const std::string& jsonpath, auto defvalue ) {
+        using value_t = decltype( defvalue );
+        std::optional<value_t> result;
+        if( settings.path_if_exists( jsonpath ) )
+        {
+            value_t avalue;
+            settings.get_value_via_path( jsonpath, avalue, defvalue );
+            result = avalue;
+        }
+        return result;
+    };
+
+    data->user_dir = UserDir;
+    data->home_dir = HomeDir;
+    data->async_threads = optional_value( jsonio::jsonio_section("AsyncThreads"), std::size_t(0) );
+    data->async_queue_size = optional_value( jsonio::jsonio_section("AsyncQueueSize"), std::size_t(0) );
+    data->documents_cache_size = optional_value( jsonio::jsonio_section("DocumentsCacheSize"), std::size_t(0) );
+    data->documents_cache_validate = optional_value( jsonio::jsonio_section("DocumentsCacheValidate"), false ).value_or( false );
+    data->db_pool_size = optional_value( jsonio::arangodb_section("DBPoolSize"), std::size_t(0) );
+    return data;
+}
+
+void JsonioSettings::addSchemaFormat(const std::string &format_type, std::string_view json_string)
 {
     schema.addSchemaFormat(format_type, json_string);
 }
@@ -122,6 +304,127 @@ void JsonioSettings::addSchemaFile(const std::string &file_path)
     DataBase::update_from_schema( schema.allStructs() );
 }
 
+namespace {
+
+/// The only sink of module logger: writes messages to the module sinks directly or through
+/// the asynchronous logger, so the module logger is not replaced when the mode of logging changes.
+class ModuleSink final : public spdlog::sinks::sink
+{
+
+public:
+
+    ModuleSink( const std::string& logger_name, const std::vector<spdlog::sink_ptr>& logger_sinks ):
+        name( logger_name ), sinks( logger_sinks )
+    {}
+
+    void log( const spdlog::details::log_msg& msg ) override
+    {
+        std::shared_ptr<spdlog::logger> logger;
+        std::shared_ptr<spdlog::details::thread_pool> pool;
+        {
+            std::lock_guard<std::mutex> lock( sink_mutex );
+            if( !async_logger )
+            {
+                for( const auto& sink: sinks )
+                    if( sink->should_log( msg.level ) )
+                        sink->log( msg );
+                return;
+            }
+            // the pool is kept while the message is queued
+            logger = async_logger;
+            pool = thread_pool;
+        }
+        logger->log( msg.time, msg.source, msg.level, msg.payload );
+    }
+
+    void flush() override
+    {
+        std::lock_guard<std::mutex> lock( sink_mutex );
+        if( async_logger )
+            async_logger->flush();
+        else
+            for( const auto& sink: sinks )
+                sink->flush();
+    }
+
+    void set_pattern( const std::string& pattern ) override
+    {
+        std::lock_guard<std::mutex> lock( sink_mutex );
+        for( const auto& sink: sinks )
+            sink->set_pattern( pattern );
+    }
+
+    void set_formatter( std::unique_ptr<spdlog::formatter> sink_formatter ) override
+    {
+        std::lock_guard<std::mutex> lock( sink_mutex );
+        for( const auto& sink: sinks )
+            sink->set_formatter( sink_formatter->clone() );
+    }
+
+    /// Add sink of module
+    void add_sink( const spdlog::sink_ptr& sink )
+    {
+        std::lock_guard<std::mutex> lock( sink_mutex );
+        sinks.push_back( sink );
+        reset_async_logger();
+    }
+
+    /// Write messages by the thread pool ( nullptr - write into the logging thread )
+    void set_async( const std::shared_ptr<spdlog::details::thread_pool>& pool, bool overrun )
+    {
+        std::lock_guard<std::mutex> lock( sink_mutex );
+        if( pool == thread_pool && overrun == overrun_oldest )
+            return;
+        // the previous pool is kept until its logger is flushed
+        auto previous_pool = thread_pool;
+        thread_pool = pool;
+        overrun_oldest = overrun;
+        reset_async_logger();
+    }
+
+    /// The sink of logger ( the sinks of logger are moved into the new ModuleSink at first call )
+    static std::shared_ptr<ModuleSink> of_logger( const std::shared_ptr<spdlog::logger>& logger )
+    {
+        auto& logger_sinks = logger->sinks();
+        if( logger_sinks.size() == 1 )
+        {
+            auto sink = std::dynamic_pointer_cast<ModuleSink>( logger_sinks.front() );
+            if( sink )
+                return sink;
+        }
+        auto sink = std::make_shared<ModuleSink>( logger->name(), logger_sinks );
+        logger_sinks.assign( 1, sink );
+        return sink;
+    }
+
+private:
+
+    std::string name;
+    std::vector<spdlog::sink_ptr> sinks;
+    std::shared_ptr<spdlog::details::thread_pool> thread_pool;
+    bool overrun_oldest = false;
+    /// Logger queueing messages to the module sinks ( nullptr - synchronous mode )
+    std::shared_ptr<spdlog::logger> async_logger;
+    std::mutex sink_mutex;
+
+    /// Create the asynchronous logger for the current sinks and pool ( sink_mutex must be locked )
+    void reset_async_logger()
+    {
+        // messages queued before are written by the previous logger
+        if( async_logger )
+            async_logger->flush();
+        async_logger.reset();
+        if( !thread_pool )
+            return;
+        async_logger = std::make_shared<spdlog::async_logger>( name, sinks.begin(), sinks.end(), thread_pool,
+                                                               ( overrun_oldest ? spdlog::async_overflow_policy::overrun_oldest :
+                                                                                  spdlog::async_overflow_policy::block ) );
+        async_logger->set_level( spdlog::level::trace );
+    }
+};
+
+} // namespace
+
 std::shared_ptr<spdlog::logger> JsonioSettings::get_logger(const std::string &module)
 {
   auto pattern = logger_section.value<std::string>("pattern", "[%n] [%^%l%$] %v");
@@ -135,6 +438,7 @@ std::shared_ptr<spdlog::logger> JsonioSettings::get_logger(const std::string &mo
       res = spdlog::stdout_color_mt(module);
       res->set_level(get_level(module));
   }
+  ModuleSink::of_logger(res)->set_async(log_thread_pool, async_overrun);
   res->set_pattern(pattern);
   module_loggers.insert(res);
   io_logger->debug("add logger {} {}", res->name(), module_loggers.size());
@@ -193,9 +497,48 @@ bool JsonioSettings::update_logger()
         add_file_sinks();
     }
     set_levels(logger_section.value<std::string>("level","info"));
+    update_async_mode();
     return true;
 }
 
+void JsonioSettings::set_async_logging( bool async, size_t queue_size, size_t threads_count, bool overrun )
+{
+    {
+        SettingsUpdate update( *this );
+        logger_section.setValue( "async.enabled", async );
+        logger_section.setValue( "async.queue_size", queue_size );
+        logger_section.setValue( "async.threads", threads_count );
+        logger_section.setValue( "async.overrun", overrun );
+    }
+    update_async_mode();
+}
+
+void JsonioSettings::update_async_mode()
+{
+    if( logger_section.value<bool>( "async.enabled", false ) )
+    {
+        auto queue_size = logger_section.value<size_t>( "async.queue_size", log_async_queue_size );
+        auto threads_count = logger_section.value<size_t>( "async.threads", log_async_threads );
+        if( !log_thread_pool || queue_size != async_queue_size || threads_count != async_threads_count )
+        {
+            // the previous pool is released when the loggers switched to the new one
+            log_thread_pool = std::make_shared<spdlog::details::thread_pool>( queue_size, std::max<size_t>( threads_count, 1 ) );
+            async_queue_size = queue_size;
+            async_threads_count = threads_count;
+        }
+    }
+    else
+    {
+        log_thread_pool.reset();
+        async_queue_size = 0;
+        async_threads_count = 0;
+    }
+    async_overrun = logger_section.value<bool>( "async.overrun", false );
+
+    for( const auto& logger: module_loggers )
+        ModuleSink::of_logger( logger )->set_async( log_thread_pool, async_overrun );
+}
+
 std::string JsonioSettings::with_directory(const std::string &logfile_name)
 {
     auto file_path = logfile_name;
@@ -224,7 +567,7 @@ void JsonioSettings::add_file_sinks()
     for(const auto& module_name: file_module_names) {
         auto plogger = spdlog::get(module_name);
         if (plogger) {
-            plogger->sinks().push_back(file_sink);
+            ModuleSink::of_logger(plogger)->add_sink(file_sink);
         }
     }
 }
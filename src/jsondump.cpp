@@ -46,6 +46,37 @@ JsonSchema loads(const std::string& schema_name,const std::string &jsonstr)
     return object;
 }
 
+void minify( std::ostream& os, const std::string& jsonstr )
+{
+    // copy the runs of not space characters, spaces into strings are kept
+    bool in_string = false;
+    bool escaped = false;
+    std::size_t start = 0;
+    for( std::size_t ii=0; ii<jsonstr.size(); ++ii )
+    {
+        char ch = jsonstr[ii];
+        if( in_string )
+        {
+            if( escaped )
+                escaped = false;
+            else if( ch == '\\' )
+                escaped = true;
+            else if( ch == '"' )
+                in_string = false;
+        }
+        else if( ch == '"' )
+            in_string = true;
+        else if( ch == ' ' || ch == '\n' || ch == '\r' || ch == '\t' )
+        {
+            if( ii > start )
+                os.write( jsonstr.data()+start, static_cast<std::streamsize>( ii-start ) );
+            start = ii+1;
+        }
+    }
+    if( jsonstr.size() > start )
+        os.write( jsonstr.data()+start, static_cast<std::streamsize>( jsonstr.size()-start ) );
+}
+
 std::string dump(const std::string &value )
 {
     std::string out;
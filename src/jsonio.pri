@@ -3,12 +3,15 @@ HEADERS += \
     $$JSONIO_HEADERS_DIR/jsonio/type_test.h \
     $$JSONIO_HEADERS_DIR/jsonio/exceptions.h \
     $$JSONIO_HEADERS_DIR/jsonio/service.h \
+    $$JSONIO_HEADERS_DIR/jsonio/shared_pool.h \
+    $$JSONIO_HEADERS_DIR/jsonio/thread_pool.h \
     $$JSONIO_HEADERS_DIR/jsonio/jsondetail.h \
     $$JSONIO_HEADERS_DIR/jsonio/jsondump.h   \
     $$JSONIO_HEADERS_DIR/jsonio/jsonbase.h \
     $$JSONIO_HEADERS_DIR/jsonio/jsonbuilder.h \
     $$JSONIO_HEADERS_DIR/jsonio/jsonparser.h \
     $$JSONIO_HEADERS_DIR/jsonio/jsonfree.h \
+    $$JSONIO_HEADERS_DIR/jsonio/file_stream.h \
     $$JSONIO_HEADERS_DIR/jsonio/txt2file.h \
     $$JSONIO_HEADERS_DIR/jsonio/io_settings.h \
     $$JSONIO_HEADERS_DIR/jsonio/schema.h \
@@ -17,8 +20,15 @@ HEADERS += \
     $$JSONIO_HEADERS_DIR/jsonio/dbquerybase.h \
     $$JSONIO_HEADERS_DIR/jsonio/dbdriverbase.h \
     $$JSONIO_HEADERS_DIR/jsonio/dbdriverarango.h \
+    $$JSONIO_HEADERS_DIR/jsonio/dbquerymatcher.h \
+    $$JSONIO_HEADERS_DIR/jsonio/dbdriverlocal.h \
+    $$JSONIO_HEADERS_DIR/jsonio/dbdriverfile.h \
+    $$JSONIO_HEADERS_DIR/jsonio/dbdrivermemory.h \
     $$JSONIO_HEADERS_DIR/jsonio/dbconnect.h \
     $$JSONIO_HEADERS_DIR/jsonio/dbcollection.h \
+    $$JSONIO_HEADERS_DIR/jsonio/dbcache.h \
+    $$JSONIO_HEADERS_DIR/jsonio/dbkeysindex.h \
+    $$JSONIO_HEADERS_DIR/jsonio/dbcursor.h \
     $$JSONIO_HEADERS_DIR/jsonio/dbdocument.h \
     $$JSONIO_HEADERS_DIR/jsonio/dbjsondoc.h \
     $$JSONIO_HEADERS_DIR/jsonio/dbschemadoc.h \
@@ -30,19 +40,28 @@ HEADERS += \
 SOURCES += \
     $$JSONIO_DIR/exceptions.cpp \
     $$JSONIO_DIR/service.cpp \
+    $$JSONIO_DIR/thread_pool.cpp \
     $$JSONIO_DIR/jsondetail.cpp \
     $$JSONIO_DIR/jsondump.cpp  \
     $$JSONIO_DIR/jsonbase.cpp \
     $$JSONIO_DIR/jsonbuilder.cpp \
     $$JSONIO_DIR/jsonparser.cpp \
     $$JSONIO_DIR/jsonfree.cpp \
+    $$JSONIO_DIR/file_stream.cpp \
     $$JSONIO_DIR/txt2file.cpp \
     $$JSONIO_DIR/io_settings.cpp \
     $$JSONIO_DIR/schema_thrift.cpp \
     $$JSONIO_DIR/jsonschema.cpp \
     $$JSONIO_DIR/dbquerybase.cpp \
     $$JSONIO_DIR/dbdriverarango.cpp \
+    $$JSONIO_DIR/dbquerymatcher.cpp \
+    $$JSONIO_DIR/dbdriverlocal.cpp \
+    $$JSONIO_DIR/dbdriverfile.cpp \
+    $$JSONIO_DIR/dbdrivermemory.cpp \
     $$JSONIO_DIR/dbconnect.cpp \
+    $$JSONIO_DIR/dbcache.cpp \
+    $$JSONIO_DIR/dbkeysindex.cpp \
+    $$JSONIO_DIR/dbcursor.cpp \
     $$JSONIO_DIR/dbcollection.cpp \
     $$JSONIO_DIR/dbdocument.cpp \
     $$JSONIO_DIR/dbjsondoc.cpp \
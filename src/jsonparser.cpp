@@ -22,9 +22,14 @@ enum {
 void JsonParser::parse_to( JsonBase* out )
 {
     cur_pos = 0;
-    skip_space_comment();
+    if( !skip_space_comment() )
+        cur_pos = end_pos;
 
-    if( jsontext[cur_pos] == jsBeginObject )
+    if( cur_pos >= end_pos )
+    {
+        set_scalar( *out );
+    }
+    else if( jsontext[cur_pos] == jsBeginObject )
     {
         JsonObjectBuilder jsBuilder(out);
         parse_object( 0, jsBuilder );
@@ -79,7 +84,7 @@ void JsonParser::parse_object( int depth, JsonObjectBuilder &builder)
 
     }while( jsontext[cur_pos++] == jsValueSeparator );
 
-    JSONIO_THROW(  "JsonParser", 5, "illegal symbol : '" + jsontext.substr(cur_pos-1, err_block_size)+"'" );
+    JSONIO_THROW(  "JsonParser", 5, "illegal symbol : '" + std::string( jsontext.substr(cur_pos-1, err_block_size) )+"'" );
 }
 
 //    array = [ <value1>, ... <valueN> ]
@@ -106,7 +111,7 @@ void JsonParser::parse_array( int depth, JsonArrayBuilder &builder)
         }
     }while( jsontext[cur_pos++] == jsValueSeparator );
 
-    JSONIO_THROW(  "JsonParser", 5, "illegal symbol : '" + jsontext.substr(cur_pos-1, err_block_size)+"'" );
+    JSONIO_THROW(  "JsonParser", 5, "illegal symbol : '" + std::string( jsontext.substr(cur_pos-1, err_block_size) )+"'" );
 }
 
 std::string JsonParser::err_part() const
@@ -115,7 +120,7 @@ std::string JsonParser::err_part() const
     if( cur_pos < end_pos - err_block_size)
         asubstr =  jsontext.substr(cur_pos, err_block_size);
     else if( end_pos < err_block_size )
-        asubstr = jsontext;
+        asubstr = std::string( jsontext );
     else
         asubstr = jsontext.substr( end_pos - err_block_size);
 
@@ -152,7 +157,7 @@ bool JsonParser::parse_string( std::string &str )
     str = "";
     JSONIO_THROW_IF( !skip_space_comment(), "JsonParser", 7, "must be string: " + err_part() );
 
-    if( jsontext[cur_pos++] != jsQuote )
+    if( jsontext[cur_pos++] != jsQuote || cur_pos >= end_pos )
         return false;
 
     while( jsontext[cur_pos] != jsQuote || lastCh )
@@ -219,7 +224,7 @@ void JsonParser::parse_value( int depth, const std::string &name, JsonBuilderBas
         {
            end_size -= cur_pos;
         }
-        auto valuestr = jsontext.substr(cur_pos, end_size);
+        std::string valuestr( jsontext.substr(cur_pos, end_size) );
         trim(valuestr);
         JSONIO_THROW_IF( valuestr.empty(), "JsonParser", 8, "must be value " + err_part() );
         builder.testScalar( name, valuestr, true );
@@ -235,7 +240,7 @@ void JsonParser::set_scalar( JsonBase& result_object )
     long ival = 0;
     double dval=0.;
 
-    if( jsontext[cur_pos] == jsQuote )
+    if( cur_pos < end_pos && jsontext[cur_pos] == jsQuote )
     {
         std::string str;
         parse_string( str );
@@ -265,4 +270,225 @@ void JsonParser::set_scalar( JsonBase& result_object )
                             JSONIO_THROW(  "JsonParser", 9, "must be value " + value );
 }
 
+//-----------------------------------------------------------------------
+
+JsonProjection::JsonProjection( const std::vector<std::string>& field_paths ):
+    nodes(1), fields_by_node(1), fields_count( field_paths.size() )
+{
+    for( std::size_t ii=0; ii<field_paths.size(); ++ii )
+    {
+        auto names = split( field_paths[ii], field_path_delimiters );
+        std::size_t node = 0;
+        while( !names.empty() )
+        {
+            auto itr = nodes[node].children.find( names.front() );
+            if( itr == nodes[node].children.end() )
+            {
+                nodes.emplace_back();
+                fields_by_node.emplace_back();
+                itr = nodes[node].children.emplace( names.front(), nodes.size()-1 ).first;
+            }
+            node = itr->second;
+            names.pop();
+        }
+        nodes[node].is_field = true;
+        fields_by_node[node].push_back( ii );
+    }
+}
+
+bool JsonProjection::extract( const std::string& jsondata, std::vector<std::string>& values,
+                              std::vector<State>& states ) const
+{
+    values.assign( fields_count, "" );
+    states.assign( fields_count, Missing );
+    ExtractState st{ jsondata, 0, values, states };
+
+    if( !extract_value( st, 0 ) )
+        return false;
+    // only spaces after value
+    return !skip_space( st );
+}
+
+void JsonProjection::set_field( ExtractState& st, int node, State state, const std::string& value ) const
+{
+    for( auto ndx: fields_by_node[node] )
+    {
+        st.states[ndx] = state;
+        st.values[ndx] = value;
+    }
+}
+
+bool JsonProjection::skip_space( ExtractState& st ) const
+{
+    while( st.pos < st.text.length() && std::isspace( static_cast<unsigned char>(st.text[st.pos]) ) )
+        ++st.pos;
+    return st.pos < st.text.length();
+}
+
+bool JsonProjection::read_string( ExtractState& st, std::string* str ) const
+{
+    if( st.text[st.pos] != jsQuote )
+        return false;
+    auto start = ++st.pos;
+    while( st.pos < st.text.length() )
+    {
+        if( st.text[st.pos] == '\\' )
+            st.pos++;
+        else if( st.text[st.pos] == jsQuote )
+        {
+            if( str )
+            {
+                *str = st.text.substr( start, st.pos-start );
+                json::undumpString( *str );
+            }
+            st.pos++;
+            return true;
+        }
+        st.pos++;
+    }
+    return false;
+}
+
+bool JsonProjection::skip_value( ExtractState& st ) const
+{
+    if( !skip_space( st ) )
+        return false;
+    switch( st.text[st.pos] )
+    {
+    case jsQuote:
+        return read_string( st, nullptr );
+    case jsBeginArray:
+    case jsBeginObject:
+    {
+        int depth = 0;
+        while( st.pos < st.text.length() )
+        {
+            switch( st.text[st.pos] )
+            {
+            case jsQuote:
+                if( !read_string( st, nullptr ) )
+                    return false;
+                continue;
+            case jsBeginArray:
+            case jsBeginObject:
+                depth++;
+                break;
+            case jsEndArray:
+            case jsEndObject:
+                if( --depth == 0 )
+                {
+                    st.pos++;
+                    return true;
+                }
+                break;
+            }
+            st.pos++;
+        }
+        return false;
+    }
+    default:
+    {
+        auto pos_end = st.text.find_first_of( ",]}", st.pos );
+        st.pos = ( pos_end == std::string::npos ? st.text.length() : pos_end );
+        return true;
+    }
+    }
+}
+
+bool JsonProjection::extract_value( ExtractState& st, int node ) const
+{
+    if( !skip_space( st ) )
+        return false;
+
+    auto& path_node = nodes[node];
+    auto ch = st.text[st.pos];
+    if( path_node.is_field )
+    {
+        if( ch == jsBeginArray || ch == jsBeginObject )
+        {
+            set_field( st, node, Structured, "" );
+            if( path_node.children.empty() )
+                return skip_value( st );
+        }
+        else if( ch == jsQuote )
+        {
+            std::string str;
+            if( !read_string( st, &str ) )
+                return false;
+            set_field( st, node, Scalar, str );
+            return true;
+        }
+        else
+        {
+            auto pos_end = st.text.find_first_of( ",]}", st.pos );
+            auto value = st.text.substr( st.pos, pos_end == std::string::npos ? std::string::npos : pos_end-st.pos );
+            trim( value );
+            long ival = 0;
+            double dval = 0.;
+            if( value == "~" || value == "null" )
+                value = "null";
+            else if( value != "true" && value != "false" )
+            {
+                if( is<long>( ival, value ) )
+                    value = v2string( ival );
+                else if( is<double>( dval, value ) )
+                    value = v2string( dval );
+                else
+                    return false;
+            }
+            set_field( st, node, Scalar, value );
+            st.pos = ( pos_end == std::string::npos ? st.text.length() : pos_end );
+            return true;
+        }
+    }
+
+    if( ch != jsBeginArray && ch != jsBeginObject )
+        return skip_value( st );
+    if( path_node.children.empty() )
+        return skip_value( st );
+
+    // object or array with selected fields
+    bool is_object = ( ch == jsBeginObject );
+    std::size_t array_ndx = 0;
+    std::string key;
+    st.pos++;
+    if( !skip_space( st ) )
+        return false;
+    if( st.text[st.pos] == ( is_object ? jsEndObject : jsEndArray ) )
+    {
+        st.pos++;
+        return true;
+    }
+    while( true )
+    {
+        if( is_object )
+        {
+            if( !skip_space( st ) || !read_string( st, &key ) )
+                return false;
+            if( !skip_space( st ) || st.text[st.pos] != jsNameSeparator )
+                return false;
+            st.pos++;
+        }
+        else
+            key = std::to_string( array_ndx++ );
+
+        auto itr = path_node.children.find( key );
+        if( itr != path_node.children.end() )
+        {
+            if( !extract_value( st, static_cast<int>(itr->second) ) )
+                return false;
+        }
+        else if( !skip_value( st ) )
+            return false;
+
+        if( !skip_space( st ) )
+            return false;
+        ch = st.text[st.pos++];
+        if( ch == ( is_object ? jsEndObject : jsEndArray ) )
+            return true;
+        if( ch != jsValueSeparator )
+            return false;
+    }
+}
+
 } // namespace jsonio
@@ -2,6 +2,7 @@
 #include "jsonio/schema_thrift.h"
 #include "jsonio/service.h"
 #include "jsonio/jsondump.h"
+#include "jsonio/jsonparser.h"
 #include "jsonio/io_settings.h"
 
 namespace jsonio {
@@ -257,11 +258,13 @@ void ThriftEnumDef::read_enum( const JsonFree& object )
 //-----------------------------------------------------------
 
 // Read thrift schema from json string
-void ThriftSchemaRead( const std::string& jsondata, schema_files_t& files,
+void ThriftSchemaRead( std::string_view jsondata, schema_files_t& files,
                        schemas_t& structs,  enums_t& enums )
 {
     ThriftFieldDef::set_type_map();
-    auto object =  json::loads( jsondata );
+    auto object = JsonFree::object();
+    JsonParser parser( jsondata );
+    parser.parse_to( &object );
 
     // extract schema to internal structures
     std::string fname, fdoc;
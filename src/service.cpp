@@ -1,4 +1,7 @@
 #include <regex>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 #include "jsonio/service.h"
 
 
@@ -7,19 +10,43 @@ namespace jsonio {
 // How to split a string in C++.
 std::vector<std::string> split2(const std::string& s, char delimiter);
 
+// Maximum number of compiled regular expressions into cache
+static const std::size_t regex_cache_size = 256;
+
+// Get compiled regular expression, compile it only on first use.
+static std::shared_ptr<const std::regex> cached_regex( const std::string& rgx_str )
+{
+    static std::mutex cache_mutex;
+    static std::unordered_map<std::string, std::shared_ptr<const std::regex>> regex_cache;
+
+    {
+        std::lock_guard<std::mutex> g(cache_mutex);
+        auto it = regex_cache.find( rgx_str );
+        if( it != regex_cache.end() )
+            return it->second;
+    }
+    // compile outside of the lock ( could throw std::regex_error )
+    auto rgx = std::make_shared<const std::regex>( rgx_str );
+    std::lock_guard<std::mutex> g(cache_mutex);
+    if( regex_cache.size() >= regex_cache_size )
+        regex_cache.clear();
+    regex_cache.emplace( rgx_str, rgx );
+    return rgx;
+}
+
 // Returns whether the string matches the regular expression.
 bool regexp_test(const std::string& str, std::string rgx_str)
 {
-    std::regex rx(rgx_str);
-    return std::regex_match( str , rx );
+    auto rx = cached_regex( rgx_str );
+    return std::regex_match( str , *rx );
 }
 
 //  Function that can be used to split text using regexp.
 std::vector<std::string> regexp_split(const std::string& str, std::string rgx_str)
 {
   std::vector<std::string> lst;
-  std::regex rgx(rgx_str);
-  std::sregex_token_iterator iter(str.begin(), str.end(), rgx, -1);
+  auto rgx = cached_regex( rgx_str );
+  std::sregex_token_iterator iter(str.begin(), str.end(), *rgx, -1);
   std::sregex_token_iterator end;
 
   while (iter != end)
@@ -36,8 +63,8 @@ std::vector<std::string> regexp_split(const std::string& str, std::string rgx_st
 std::vector<std::string> regexp_extract(const std::string& str, std::string rgx_str)
 {
   std::vector<std::string> lst;
-  std::regex rgx(rgx_str);
-  std::sregex_token_iterator iter(str.begin(), str.end(), rgx, 0);
+  auto rgx = cached_regex( rgx_str );
+  std::sregex_token_iterator iter(str.begin(), str.end(), *rgx, 0);
   std::sregex_token_iterator end;
 
   while (iter != end)
@@ -52,11 +79,36 @@ std::vector<std::string> regexp_extract(const std::string& str, std::string rgx_
 //  Function that can be used to replace text using regex.
 std::string regexp_replace(const std::string& instr, const std::string& rgx_str, const std::string& replacement )
 {
-   std::regex re(rgx_str);
-   std::string output_str = regex_replace(instr, re, replacement);
+   auto re = cached_regex( rgx_str );
+   std::string output_str = regex_replace(instr, *re, replacement);
    return output_str;
 }
 
+// Convert array indexes into field path to brackets: "a.0.b" -> "a[0].b"
+std::string brackets_field_path( const std::string& fieldpath )
+{
+    std::string output_str;
+    output_str.reserve( fieldpath.size()+4 );
+    std::size_t pos = 0;
+    while( pos < fieldpath.size() )
+    {
+        if( fieldpath[pos] == '.' )
+        {
+            auto pos_end = pos+1;
+            while( pos_end < fieldpath.size() && isdigit( fieldpath[pos_end] ) )
+                ++pos_end;
+            if( pos_end > pos+1 && ( pos_end == fieldpath.size() || fieldpath[pos_end] == '.' ) )
+            {
+                output_str += "[" + fieldpath.substr( pos+1, pos_end-pos-1 ) + "]";
+                pos = pos_end;
+                continue;
+            }
+        }
+        output_str += fieldpath[pos++];
+    }
+    return output_str;
+}
+
 //  Function that can be used to replace text.
 std::string string_replace_all(const std::string& instr, const std::string& replace_from, const std::string& replace_to)
 {
@@ -73,10 +125,10 @@ std::string string_replace_all(const std::string& instr, const std::string& repl
 std::string regexp_extract_string( const std::string& regstr, const std::string& data )
 {
     std::string token = "";
-    std::regex re( regstr );
+    auto re = cached_regex( regstr );
     std::smatch match;
 
-    if( std::regex_search( data, match, re ))
+    if( std::regex_search( data, match, *re ))
     {
         if (match.ready())
             token = match[1];
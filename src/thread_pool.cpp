@@ -0,0 +1,93 @@
+#include "jsonio/thread_pool.h"
+#include "jsonio/exceptions.h"
+
+namespace jsonio {
+
+// Pool which owns the current worker thread
+static thread_local const ThreadPool* current_worker_pool = nullptr;
+
+ThreadPool::ThreadPool( std::size_t threads_count, std::size_t max_queue_size ):
+    workers(), tasks(), max_queue( max_queue_size )
+{
+    if( threads_count < 1 )
+        threads_count = 1;
+    for( std::size_t ii=0; ii<threads_count; ++ii )
+        workers.emplace_back( &ThreadPool::worker_loop, this );
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(tasks_mutex);
+        stopping = true;
+    }
+    not_empty.notify_all();
+    not_full.notify_all();
+    for( auto& worker: workers )
+        if( worker.joinable() )
+            worker.join();
+}
+
+std::size_t ThreadPool::pending() const
+{
+    std::lock_guard<std::mutex> lock(tasks_mutex);
+    return tasks.size() + active_tasks;
+}
+
+void ThreadPool::wait_all()
+{
+    std::unique_lock<std::mutex> lock(tasks_mutex);
+    all_done.wait( lock, [this]{ return tasks.empty() && active_tasks == 0; } );
+}
+
+void ThreadPool::push( std::function<void()>&& task )
+{
+    {
+        std::unique_lock<std::mutex> lock(tasks_mutex);
+        JSONIO_THROW_IF( stopping, "ThreadPool", 1, " submit task to stopped executor." );
+        if( max_queue > 0 && tasks.size() >= max_queue )
+        {
+            if( current_worker_pool == this )
+            {
+                // the task submitted from a worker of the full pool is executed at once
+                lock.unlock();
+                task();
+                return;
+            }
+            not_full.wait( lock, [this]{ return tasks.size() < max_queue || stopping; } );
+            JSONIO_THROW_IF( stopping, "ThreadPool", 2, " executor stopped while waiting to submit task." );
+        }
+        tasks.push( std::move(task) );
+    }
+    not_empty.notify_one();
+}
+
+void ThreadPool::worker_loop()
+{
+    current_worker_pool = this;
+    while( true )
+    {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(tasks_mutex);
+            not_empty.wait( lock, [this]{ return stopping || !tasks.empty(); } );
+            if( tasks.empty() )
+                return;   // stopping and all tasks done
+            task = std::move( tasks.front() );
+            tasks.pop();
+            active_tasks++;
+        }
+        not_full.notify_one();
+
+        task();   // exceptions are stored into the future
+
+        {
+            std::lock_guard<std::mutex> lock(tasks_mutex);
+            active_tasks--;
+            if( tasks.empty() && active_tasks == 0 )
+                all_done.notify_all();
+        }
+    }
+}
+
+} // namespace jsonio
@@ -1,106 +1,731 @@
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <iterator>
 #include "jsonio/traversal.h"
 #include "jsonio/dbconnect.h"
+#include "jsonio/jsondump.h"
 
 namespace jsonio {
 
-GraphTraversal::GraphTraversal( const DataBase& dbconnect )
+std::size_t GraphSnapshot::compact_min_changes = 1024;
+double GraphSnapshot::compact_changes_ratio = 0.25;
+
+std::vector<std::string> GraphSnapshot::edgeCollections( const DataBase& dbconnect )
+{
+    auto edge_collections = DataBase::getEdgesAllDefined();
+    if( edge_collections.empty() )
+    {
+        auto names = dbconnect.theDriver()->get_collections_names( AbstractDBDriver::clEdge );
+        edge_collections.assign( names.begin(), names.end() );
+    }
+    return edge_collections;
+}
+
+GraphSnapshot::GraphSnapshot( const DataBase& dbconnect, const std::vector<std::string>& edge_collections ):
+    db_connect( dbconnect ), collections_names( edge_collections )
 {
-    std::string  schemaName = DataBase::getVertexesList()[0];
-    vertex_doc = std::make_shared<DBVertexDocument>( schemaName, dbconnect  );
-    vertex_doc->setMode(true);
+    if( collections_names.empty() )
+        collections_names = edgeCollections( db_connect );
 
-    schemaName = DataBase::getEdgesList()[0];
-    edge_doc = std::make_shared<DBEdgeDocument>( schemaName, dbconnect  );
-    edge_doc->setMode(true);
+    // listen before the read, so no change is lost
+    for( const auto& collname: collections_names )
+    {
+        auto collection = db_connect.collection( collname, "edge" );
+        auto listener_id = collection->addChangesListener( [this]( const std::string& key, const JsonBase* data_object )
+        {
+            std::string from_id, to_id;
+            if( data_object && data_object->get_value_via_path( "_from", from_id, std::string("") ) &&
+                    data_object->get_value_via_path( "_to", to_id, std::string("") ) )
+                addEdge( key, from_id, to_id );
+            else
+                removeEdge( key );
+        });
+        listeners.emplace_back( collection, listener_id );
+    }
+    rebuild();
 }
 
-// visit Vertex and all linked Edges
-bool GraphTraversal::parseVertex( const std::string& idVertex, GraphElement_f afunc  )
+GraphSnapshot::~GraphSnapshot()
 {
-    // Test Vertex is parsed before
-    if( vertex_list.find( idVertex ) !=  vertex_list.end() )
-        return false;
+    for( auto& listener: listeners )
+        listener.first->removeChangesListener( listener.second );
+}
 
-    io_logger->debug("idVertex  {}", idVertex);
-    vertex_list.insert( idVertex );
-    vertex_doc->readDocument( idVertex );
-    afunc( true, vertex_doc->getJson() );
+void GraphSnapshot::rebuild()
+{
+    std::lock_guard<std::mutex> rebuild_lock(rebuild_mutex);
+    auto start = std::chrono::high_resolution_clock::now();
+    {
+        std::lock_guard<std::shared_mutex> g(snapshot_mutex);
+        rebuild_changes.clear();
+        rebuilding = true;
+    }
 
-    // read all edges
-    std::vector<std::string> edgeslst;
+    std::vector<std::array<std::string, 3>> links;
+    try {
+        for( const auto& collname: collections_names )
+            db_connect.theDriver()->all_query( collname, { "_id", "_from", "_to" },
+                                               [&links]( const std::string& jsondata, const std::string& )
+            {
+                links.push_back( { extract_string_json( "_id", jsondata ),
+                                   extract_string_json( "_from", jsondata ),
+                                   extract_string_json( "_to", jsondata ) } );
+            });
+    }
+    catch(...)
+    {
+        std::lock_guard<std::shared_mutex> g(snapshot_mutex);
+        rebuild_changes.clear();
+        rebuilding = false;
+        throw;
+    }
 
-    if( trav_type&trOut )
+    std::lock_guard<std::shared_mutex> g(snapshot_mutex);
+    vertex_ids.clear();
+    vertex_index.clear();
+    edge_ids.clear();
+    edge_index.clear();
+    edge_links.clear();
+    for( const auto& link: links )
+        add_edge( link[0], link[1], link[2] );
+    // the read could miss changes done while reading, the last change of edge wins
+    for( const auto& change: rebuild_changes )
     {
-        edgeslst = edge_doc->getOutEdgesKeys( idVertex );
-        for(auto const &ent : edgeslst)
-            parseEdge( ent,  afunc  );
+        if( change[1].empty() )
+            remove_edge( change[0] );
+        else
+            add_edge( change[0], change[1], change[2] );
     }
+    rebuild_changes.clear();
+    rebuilding = false;
+    compact();
 
-    if( trav_type&trIn )
+    auto end = std::chrono::high_resolution_clock::now();
+    io_logger->info("GraphSnapshot {} vertexes {} edges in {} ms", vertex_ids.size(), edge_ids.size(),
+                    std::chrono::duration_cast<std::chrono::milliseconds>(end-start).count());
+}
+
+std::size_t GraphSnapshot::verticesCount() const
+{
+    std::shared_lock<std::shared_mutex> g(snapshot_mutex);
+    return vertex_ids.size();
+}
+
+std::size_t GraphSnapshot::edgesCount() const
+{
+    std::shared_lock<std::shared_mutex> g(snapshot_mutex);
+    return edge_index.size();
+}
+
+bool GraphSnapshot::containsEdge( const std::string& edge_id ) const
+{
+    std::shared_lock<std::shared_mutex> g(snapshot_mutex);
+    return edge_index.find( edge_id ) != edge_index.end();
+}
+
+std::vector<std::string> GraphSnapshot::edges( const std::string& vertex_id, int trav_type ) const
+{
+    std::vector<std::string> ids;
+    std::shared_lock<std::shared_mutex> g(snapshot_mutex);
+    auto itvertex = vertex_index.find( vertex_id );
+    if( itvertex == vertex_index.end() )
+        return ids;
+    // the self-loop edge is outgoing and incoming
+    std::unordered_set<std::uint32_t> linked;
+    for_each_edge( itvertex->second, trav_type, [&]( std::uint32_t edge, std::uint32_t )
     {
-        edgeslst = edge_doc->getInEdgesKeys( idVertex );
-        for(auto const &ent : edgeslst)
-            parseEdge( ent, afunc  );
+        if( linked.insert( edge ).second )
+            ids.push_back( edge_ids[edge] );
+    });
+    return ids;
+}
+
+std::vector<std::string> GraphSnapshot::neighbors( const std::string& vertex_id, int trav_type ) const
+{
+    std::vector<std::string> ids;
+    std::shared_lock<std::shared_mutex> g(snapshot_mutex);
+    auto itvertex = vertex_index.find( vertex_id );
+    if( itvertex == vertex_index.end() )
+        return ids;
+    std::unordered_set<std::uint32_t> linked;
+    for_each_edge( itvertex->second, trav_type, [&]( std::uint32_t, std::uint32_t linked_vertex )
+    {
+        if( linked.insert( linked_vertex ).second )
+            ids.push_back( vertex_ids[linked_vertex] );
+    });
+    return ids;
+}
+
+void GraphSnapshot::traverse( const std::vector<std::string>& start_vertexes, int trav_type, int max_depth,
+                              VisitVertex_f visitor ) const
+{
+    std::vector<std::pair<std::string, int>> visited_vertexes;
+    {
+        std::shared_lock<std::shared_mutex> g(snapshot_mutex);
+        std::vector<bool> visited( vertex_ids.size(), false );
+        std::vector<std::uint32_t> frontier, next_frontier;
+        for( const auto& id: start_vertexes )
+        {
+            auto itvertex = vertex_index.find( id );
+            if( itvertex == vertex_index.end() )
+                visited_vertexes.emplace_back( id, 0 );
+            else if( !visited[itvertex->second] )
+            {
+                visited[itvertex->second] = true;
+                frontier.push_back( itvertex->second );
+            }
+        }
+        for( int depth = 0; !frontier.empty(); ++depth )
+        {
+            next_frontier.clear();
+            for( auto vertex: frontier )
+            {
+                visited_vertexes.emplace_back( vertex_ids[vertex], depth );
+                if( max_depth >= 0 && depth >= max_depth )
+                    continue;
+                for_each_edge( vertex, trav_type, [&]( std::uint32_t, std::uint32_t linked_vertex )
+                {
+                    if( !visited[linked_vertex] )
+                    {
+                        visited[linked_vertex] = true;
+                        next_frontier.push_back( linked_vertex );
+                    }
+                });
+            }
+            frontier.swap( next_frontier );
+        }
     }
-    return true;
+    // the visitor could change the graph
+    for( const auto& vertex: visited_vertexes )
+        visitor( vertex.first, vertex.second );
+}
 
+void GraphSnapshot::addEdge( const std::string& edge_id, const std::string& from_id, const std::string& to_id )
+{
+    std::lock_guard<std::shared_mutex> g(snapshot_mutex);
+    if( rebuilding )
+        rebuild_changes.push_back( { edge_id, from_id, to_id } );
+    add_edge( edge_id, from_id, to_id );
+    compact_if_needed();
 }
 
-//  visit Edge and all linked Vertexes
-bool GraphTraversal::parseEdge( const std::string& idEdge, GraphElement_f afunc  )
+void GraphSnapshot::removeEdge( const std::string& edge_id )
 {
-    std::string vertexId;
-    // Test Edge is parsed before
-    if( edge_list.find( idEdge ) !=  edge_list.end() )
-        return false;
+    std::lock_guard<std::shared_mutex> g(snapshot_mutex);
+    if( rebuilding )
+        rebuild_changes.push_back( { edge_id, "", "" } );
+    remove_edge( edge_id );
+    compact_if_needed();
+}
 
-    io_logger->debug("idEdge  {}", idEdge);
-    edge_list.insert( idEdge );
-    edge_doc->readDocument( idEdge );
-    std::string tojson = edge_doc->getJson();
+std::uint32_t GraphSnapshot::vertex_number( const std::string& vertex_id )
+{
+    auto itvertex = vertex_index.find( vertex_id );
+    if( itvertex != vertex_index.end() )
+        return itvertex->second;
+    auto number = static_cast<std::uint32_t>( vertex_ids.size() );
+    vertex_ids.push_back( vertex_id );
+    vertex_index[vertex_id] = number;
+    return number;
+}
 
-    if( (trav_type&trIn) )
+void GraphSnapshot::add_edge( const std::string& edge_id, const std::string& from_id, const std::string& to_id )
+{
+    remove_edge( edge_id );
+    auto number = static_cast<std::uint32_t>( edge_ids.size() );
+    EdgeLink link;
+    link.from = vertex_number( from_id );
+    link.to = vertex_number( to_id );
+    edge_ids.push_back( edge_id );
+    edge_links.push_back( link );
+    edge_index[edge_id] = number;
+    added_out[link.from].push_back( number );
+    added_in[link.to].push_back( number );
+    changes_count++;
+}
+
+void GraphSnapshot::remove_edge( const std::string& edge_id )
+{
+    auto itedge = edge_index.find( edge_id );
+    if( itedge == edge_index.end() )
+        return;
+    edge_links[itedge->second].removed = true;
+    edge_index.erase( itedge );
+    removed_count++;
+    changes_count++;
+}
+
+void GraphSnapshot::compact_if_needed()
+{
+    if( changes_count >= compact_min_changes &&
+            static_cast<double>( changes_count ) >= compact_changes_ratio*static_cast<double>( edge_ids.size() ) )
+        compact();
+}
+
+void GraphSnapshot::compact()
+{
+    if( removed_count > 0 )
     {
-        if( edge_doc->getValueViaPath("_from", vertexId, std::string("")) )
+        std::vector<std::string> live_ids;
+        std::vector<EdgeLink> live_links;
+        live_ids.reserve( edge_index.size() );
+        live_links.reserve( edge_index.size() );
+        for( std::size_t ii=0; ii<edge_ids.size(); ++ii )
+            if( !edge_links[ii].removed )
+            {
+                edge_index[edge_ids[ii]] = static_cast<std::uint32_t>( live_ids.size() );
+                live_ids.push_back( std::move( edge_ids[ii] ) );
+                live_links.push_back( edge_links[ii] );
+            }
+        edge_ids = std::move( live_ids );
+        edge_links = std::move( live_links );
+    }
+
+    // counting sort of edges by vertexes
+    out_offsets.assign( vertex_ids.size()+1, 0 );
+    in_offsets.assign( vertex_ids.size()+1, 0 );
+    for( const auto& link: edge_links )
+    {
+        out_offsets[link.from+1]++;
+        in_offsets[link.to+1]++;
+    }
+    for( std::size_t ii=1; ii<out_offsets.size(); ++ii )
+    {
+        out_offsets[ii] += out_offsets[ii-1];
+        in_offsets[ii] += in_offsets[ii-1];
+    }
+    out_edges.resize( edge_links.size() );
+    in_edges.resize( edge_links.size() );
+    std::vector<std::uint32_t> out_next( out_offsets.begin(), out_offsets.end()-1 );
+    std::vector<std::uint32_t> in_next( in_offsets.begin(), in_offsets.end()-1 );
+    for( std::uint32_t edge=0; edge<edge_links.size(); ++edge )
+    {
+        out_edges[out_next[edge_links[edge].from]++] = edge;
+        in_edges[in_next[edge_links[edge].to]++] = edge;
+    }
+
+    added_out.clear();
+    added_in.clear();
+    changes_count = 0;
+    removed_count = 0;
+}
+
+void GraphSnapshot::for_each_edge( std::uint32_t vertex, int trav_type,
+                                   const std::function<void( std::uint32_t, std::uint32_t )>& func ) const
+{
+    auto visit = [&]( const std::vector<std::uint32_t>& offsets, const std::vector<std::uint32_t>& compressed,
+                      const std::unordered_map<std::uint32_t, std::vector<std::uint32_t>>& added, bool outgoing )
+    {
+        auto send = [&]( std::uint32_t edge )
         {
-            parseVertex( vertexId, afunc );
+            const auto& link = edge_links[edge];
+            if( !link.removed )
+                func( edge, outgoing ? link.to : link.from );
+        };
+        if( vertex+1 < offsets.size() )
+            for( auto pos = offsets[vertex]; pos < offsets[vertex+1]; ++pos )
+                send( compressed[pos] );
+        auto itadded = added.find( vertex );
+        if( itadded != added.end() )
+            for( auto edge: itadded->second )
+                send( edge );
+    };
+    if( trav_type & GraphTraversal::trOut )
+        visit( out_offsets, out_edges, added_out, true );
+    if( trav_type & GraphTraversal::trIn )
+        visit( in_offsets, in_edges, added_in, false );
+}
+
+//---------------------------------------------------------------------------------------
+
+std::size_t GraphTraversal::batch_size = 1000;
+bool GraphTraversal::parallel_requests = true;
+
+GraphTraversal::GraphTraversal( const DataBase& dbconnect ):
+    db_connect( dbconnect )
+{}
+
+void GraphTraversal::Traversal( bool startFromVertex, const std::vector<std::string>& ids,
+                                GraphElement_f afunc, int atravType, int max_depth )
+{
+    trav_type  = atravType;
+    vertex_list.clear();
+    edge_list.clear();
+    if( !graph_snapshot )
+        edge_collections = GraphSnapshot::edgeCollections( db_connect );
+
+    std::vector<std::string> frontier;
+    if( startFromVertex )
+        frontier = ids;
+    else
+    {
+        std::vector<std::string> start_edges;
+        for( const auto& id: ids )
+            if( edge_list.find( id ) == edge_list.end() )
+                start_edges.push_back( id );
+        visit_edges( read_documents( start_edges ), afunc, frontier );
+    }
+    traverse_levels( std::move(frontier), afunc, max_depth );
+    io_logger->info("Traverse {} vertexes and  {} edges ", vertex_list.size(), edge_list.size());
+}
+
+std::size_t GraphTraversal::exportGraph( const std::string& file_path, bool startFromVertex,
+                                         const std::vector<std::string>& ids, int format, int atravType, int max_depth )
+{
+    std::vector<char> write_buffer( 1024*1024 );
+    std::ofstream output;
+    output.rdbuf()->pubsetbuf( write_buffer.data(), static_cast<std::streamsize>( write_buffer.size() ) );
+    output.open( file_path, std::ios::binary|std::ios::trunc );
+    JSONIO_THROW_IF( !output.good(), "GraphTraversal", 2, " error opening file " + file_path );
+
+    std::size_t documents_count = 0;
+    const char* separator = ( format == exJsonLines ? "\n" : ",\n" );
+    if( format != exJsonLines )
+        output << "[\n";
+    Traversal( startFromVertex, ids, [&]( bool, const std::string& data )
+    {
+        if( documents_count++ > 0 )
+            output << separator;
+        json::minify( output, data );
+    }, atravType, max_depth );
+    if( format != exJsonLines )
+        output << "\n]";
+    if( documents_count > 0 || format != exJsonLines )
+        output << "\n";
+
+    output.close();
+    JSONIO_THROW_IF( output.fail(), "GraphTraversal", 3, " error writing file " + file_path );
+    io_logger->debug("Exported {} documents to file {}", documents_count, file_path);
+    return documents_count;
+}
+
+void GraphTraversal::traverse_levels( std::vector<std::string> frontier, GraphElement_f afunc, int max_depth )
+{
+    for( int depth = 0; !frontier.empty(); ++depth )
+    {
+        std::vector<std::string> level_vertexes;
+        for( auto& id: frontier )
+            if( vertex_list.insert( id ).second )
+                level_vertexes.push_back( std::move(id) );
+        io_logger->debug("Traversal level {} vertexes {}", depth, level_vertexes.size());
+
+        for( const auto& vertex_data: read_documents( level_vertexes ) )
+            afunc( true, vertex_data );
+
+        frontier.clear();
+        if( trav_type == trNo || ( max_depth >= 0 && depth >= max_depth ) )
+            break;
+        visit_edges( read_edges( level_vertexes ), afunc, frontier );
+    }
+}
+
+void GraphTraversal::visit_edges( const std::vector<std::string>& edges_data, GraphElement_f afunc,
+                                  std::vector<std::string>& next_frontier )
+{
+    for( const auto& edge_data: edges_data )
+    {
+        // Test Edge is parsed before
+        if( !edge_list.insert( extract_string_json( "_id", edge_data ) ).second )
+            continue;
+        if( trav_type&trIn )
+        {
+            auto vertex_id = extract_string_json( "_from", edge_data );
+            if( !vertex_id.empty() && vertex_list.find( vertex_id ) == vertex_list.end() )
+                next_frontier.push_back( vertex_id );
+        }
+        if( trav_type&trOut )
+        {
+            auto vertex_id = extract_string_json( "_to", edge_data );
+            if( !vertex_id.empty() && vertex_list.find( vertex_id ) == vertex_list.end() )
+                next_frontier.push_back( vertex_id );
         }
+        afunc( false, edge_data );
     }
+}
 
-    if( (trav_type&trOut) )
+/// Document data normalized by its schema ( as DBVertexDocument::getJson() returns ),
+/// data is passed as is if the schema of _type and _label is not loaded
+static std::string schema_json( const std::string& jsondata )
+{
+    auto type = extract_string_json( "_type", jsondata );
+    auto label = extract_string_json( "_label", jsondata );
+    std::string schema_name;
+    if( type == "vertex" )
+        schema_name = DataBase::getVertexName( label );
+    else if( type == "edge" )
+        schema_name = DataBase::getEdgeName( label );
+    if( schema_name.empty() )
+        return jsondata;
+    return json::loads( schema_name, jsondata ).dump();
+}
+
+std::vector<std::string> GraphTraversal::read_documents( const std::vector<std::string>& ids ) const
+{
+    // ids are grouped by collections
+    std::map<std::string, std::vector<std::string>> collections_ids;
+    for( const auto& id: ids )
     {
-        if( edge_doc->getValueViaPath("_to", vertexId, std::string("")) )
+        auto pos = id.find( '/' );
+        if( pos == std::string::npos )
+        {
+            io_logger->warn("Traversal skip document without collection {}", id);
+            continue;
+        }
+        collections_ids[id.substr( 0, pos )].push_back( id );
+    }
+
+    std::vector<std::function<std::vector<std::string>()>> requests;
+    for( const auto& collection: collections_ids )
+        for( std::size_t pos=0; pos<collection.second.size(); pos+=batch_size )
         {
-            parseVertex( vertexId, afunc );
+            auto collname = collection.first;
+            std::vector<std::string> ids_batch( collection.second.begin()+pos,
+                                                collection.second.begin()+std::min( pos+batch_size, collection.second.size() ) );
+            requests.push_back( [this, collname, ids_batch]()
+            {
+                std::vector<std::string> documents;
+                db_connect.theDriver()->lookup_by_ids( collname, ids_batch, [&documents]( const std::string& jsondata )
+                {
+                    documents.push_back( schema_json( jsondata ) );
+                });
+                return documents;
+            });
         }
+    return execute_requests( requests );
+}
+
+std::vector<std::string> GraphTraversal::read_edges( const std::vector<std::string>& vertexes ) const
+{
+    if( graph_snapshot )
+    {
+        std::vector<std::string> edges_ids;
+        for( const auto& vertex: vertexes )
+            for( auto& edge_id: graph_snapshot->edges( vertex, trav_type ) )
+                if( edge_list.find( edge_id ) == edge_list.end() )
+                    edges_ids.push_back( std::move(edge_id) );
+        return read_documents( edges_ids );
     }
-    afunc( false, tojson );
-    return true;
+
+    std::string condition;
+    if( trav_type&trOut )
+        condition = "e._from IN @vertexes";
+    if( trav_type&trIn )
+        condition += ( condition.empty() ? "" : " OR " ) + std::string( "e._to IN @vertexes" );
+
+    std::vector<std::function<std::vector<std::string>()>> requests;
+    for( const auto& collname: edge_collections )
+        for( std::size_t pos=0; pos<vertexes.size(); pos+=batch_size )
+        {
+            std::vector<std::string> ids_batch( vertexes.begin()+pos, vertexes.begin()+std::min( pos+batch_size, vertexes.size() ) );
+            DBQueryBase query( "FOR e IN " + collname + " FILTER " + condition + " RETURN e", DBQueryBase::qAQL );
+            query.setBindVars( "{ \"vertexes\": " + json::dump( ids_batch ) + " }" );
+            requests.push_back( [this, collname, query]()
+            {
+                std::vector<std::string> edges;
+                db_connect.theDriver()->select_query( collname, query, [&edges]( const std::string& jsondata )
+                {
+                    edges.push_back( schema_json( jsondata ) );
+                });
+                return edges;
+            });
+        }
+    return execute_requests( requests );
+}
+
+std::vector<std::string> GraphTraversal::execute_requests(
+        const std::vector<std::function<std::vector<std::string>()>>& requests ) const
+{
+    std::vector<std::string> results;
+    if( !parallel_requests || requests.size() < 2 )
+    {
+        for( const auto& request: requests )
+        {
+            auto documents = request();
+            std::move( documents.begin(), documents.end(), std::back_inserter( results ) );
+        }
+        return results;
+    }
+
+    std::vector<std::future<std::vector<std::string>>> futures;
+    for( const auto& request: requests )
+        futures.push_back( db_connect.executor().submit( request ) );
+    for( auto& future: futures )
+    {
+        auto documents = future.get();
+        std::move( documents.begin(), documents.end(), std::back_inserter( results ) );
+    }
+    return results;
+}
+
+/// Schema of the record of graph file ( empty if the schema of label is not loaded )
+static std::string restore_schema( const std::string& type, const std::string& label )
+{
+    if( type == "vertex" )
+        return DataBase::getVertexName( label );
+    if( type == "edge" )
+        return DataBase::getEdgeName( label );
+    return "";
+}
+
+/// Collection to save the record of graph file ( by schema of record or by collection of _id )
+static std::string restore_collection( const std::string& type, const std::string& schema_name, const std::string& id )
+{
+    std::string collname;
+    if( !schema_name.empty() )
+        collname = ( type == "edge" ? DataBase::getEdgeCollection( schema_name ) : DataBase::getVertexCollection( schema_name ) );
+    if( collname.empty() )
+    {
+        auto pos = id.find( '/' );
+        if( pos != std::string::npos )
+            collname = id.substr( 0, pos );
+    }
+    return collname;
 }
 
 void GraphTraversal::restoreGraphFromFile( const std::string& file_path )
 {
-    std::string type, id;
-    std::string cur_record;
+    struct Batch
+    {
+        std::string type;
+        /// Schema of records ( empty - records are saved as read )
+        std::string schema_name;
+        std::vector<std::string> records;
+    };
+
     io_logger->info("Restore graph from file {}", file_path);
+    auto start_time = std::chrono::steady_clock::now();
+
+    std::ifstream input( file_path, std::ios::binary );
+    JSONIO_THROW_IF( !input.good(), "GraphTraversal", 1, " error opening file " + file_path );
+    JsonArrayReader reader( input );
+
+    bool parallel = parallel_requests;
+    std::size_t max_in_flight = 4*db_connect.executor().size();
+    std::deque<std::shared_future<void>> in_flight;
+    std::map<std::string, Batch> batches;
+    // saveDocument tests the document exists before creates it, so batches of one collection
+    // are written in turn: the batch waits for the last submitted batch of its collection
+    std::map<std::string, std::shared_future<void>> collections_writes;
+    std::set<std::string> unknown_labels;
+    std::size_t vertexes_count = 0, edges_count = 0, skipped_count = 0;
 
-    JsonArrayFile file( file_path);
-    file.Open( TxtFile::ReadOnly );
-    while( file.loadNext( cur_record ) )
+    auto write_batch = [this]( const std::string& collname, const Batch& batch )
     {
-        id = extract_string_json( "_id", cur_record );
-        type = extract_string_json( "_type", cur_record );
-        io_logger->info("{} {}", id, type);
-        if( type.empty() )
-            continue;
-        if( type == "edge" )
-            edge_doc->updateFromJson( cur_record );
-        else
-            if( type == "vertex" )
-                vertex_doc->updateFromJson( cur_record );
+        if( !batch.schema_name.empty() )
+        {
+            // records are tested and saved by the schema document ( as DBVertexDocument::updateFromJson )
+            std::unique_ptr<DBVertexDocument> document;
+            if( batch.type == "edge" )
+                document.reset( new DBEdgeDocument( batch.schema_name, db_connect ) );
+            else
+                document.reset( new DBVertexDocument( batch.schema_name, db_connect ) );
+            for( const auto& record: batch.records )
+                document->updateFromJson( record );
+            return;
+        }
+
+        auto collection = db_connect.collection( collname, batch.type );
+        std::string id;
+        for( const auto& record: batch.records )
+        {
+            auto data = json::loads( record );
+            data.get_value_via_path<std::string>( "_id", id, "" );
+            if( id.empty() )
+                collection->createDocument( data );
+            else
+                collection->saveDocument( data, id );
+        }
+    };
+    // wait for started writes until left of them are in flight, the first error is thrown after all writes stopped
+    auto wait_writes = [&in_flight]( std::size_t left )
+    {
+        std::exception_ptr error;
+        while( !in_flight.empty() && ( in_flight.size() > left || error ) )
+        {
+            auto task = std::move( in_flight.front() );
+            in_flight.pop_front();
+            try {
+                task.get();
+            }
+            catch(...)
+            {
+                if( !error )
+                    error = std::current_exception();
+            }
+        }
+        if( error )
+            std::rethrow_exception( error );
+    };
+    auto flush_batch = [&]( const std::string& batch_key, Batch& batch )
+    {
+        auto collname = batch_key.substr( 0, batch_key.find( ':' ) );
+        auto ready = std::make_shared<Batch>( Batch{ batch.type, batch.schema_name, std::move( batch.records ) } );
+        batch.records.clear();
+        if( !parallel )
+        {
+            write_batch( collname, *ready );
+            return;
+        }
+        wait_writes( max_in_flight-1 );
+        // tasks are started in the order they were submitted, so the previous batch is already running
+        auto& last_write = collections_writes[collname];
+        last_write = db_connect.executor().submit( [write_batch, collname, ready, previous = last_write]() {
+                         if( previous.valid() )
+                             previous.wait();
+                         write_batch( collname, *ready );
+                     }).share();
+        in_flight.push_back( last_write );
+    };
+
+    try {
+        std::string element;
+        while( reader.next( element ) )
+        {
+            auto type = extract_string_json( "_type", element );
+            auto label = extract_string_json( "_label", element );
+            auto schema_name = restore_schema( type, label );
+            auto collname = ( type.empty() ? "" : restore_collection( type, schema_name, extract_string_json( "_id", element ) ) );
+            if( collname.empty() )
+            {
+                skipped_count++;
+                continue;
+            }
+            if( schema_name.empty() && unknown_labels.insert( type+":"+label ).second )
+                io_logger->warn("Restore {} records with label '{}' without schema", type, label);
+            ( type == "edge" ? edges_count : vertexes_count )++;
+
+            auto batch_key = collname+":"+type+":"+schema_name;
+            auto& batch = batches[batch_key];
+            batch.type = type;
+            batch.schema_name = schema_name;
+            batch.records.push_back( std::move( element ) );
+            if( batch.records.size() >= batch_size )
+                flush_batch( batch_key, batch );
+        }
+        for( auto& batch: batches )
+            if( !batch.second.records.empty() )
+                flush_batch( batch.first, batch.second );
+        wait_writes( 0 );
     }
-    file.Close();
+    catch(...)
+    {
+        // finish started writes before report the error
+        for( auto& task: in_flight )
+            task.wait();
+        throw;
+    }
+
+    auto msecs = std::chrono::duration_cast<std::chrono::milliseconds>( std::chrono::steady_clock::now()-start_time ).count();
+    double secs = std::max<double>( static_cast<double>( msecs ), 1. )/1000.;
+    io_logger->info("Restored {} vertexes and {} edges ( skipped {} ) in {} ms: {:.0f} records/s, {:.2f} MB/s",
+                    vertexes_count, edges_count, skipped_count, msecs,
+                    static_cast<double>( vertexes_count+edges_count )/secs,
+                    static_cast<double>( reader.bytesRead() )/secs/1024./1024. );
 }
 
 
@@ -1,4 +1,7 @@
+#include <deque>
 #include <fstream>
+#include <sstream>
+#include <vector>
 
 #ifdef _MSC_VER
 #include  <io.h>
@@ -9,6 +12,9 @@
 
 #include "jsonio/txt2file.h"
 #include "jsonio/jsonfree.h"
+#include "jsonio/jsondump.h"
+#include "jsonio/jsonparser.h"
+#include "jsonio/thread_pool.h"
 
 #include <filesystem>
 namespace fs = std::filesystem;
@@ -124,21 +130,8 @@ list_names_t files_into_directory( const std::string& directory_path, const std:
 // Read whole ASCII file into string.
 std::string read_ascii_file( const std::string& file_path )
 {
-    std::ifstream t(file_path);
-    JSONIO_THROW_IF( !t.good(), "filesystem", 4, "file open error...  " + file_path );
-    std::stringstream buffer;
-    buffer << t.rdbuf();
-
-    auto retstr = buffer.str();
-    // skip over optional BOM http://unicode.org/faq/utf_bom.html
-    if ( retstr.size() >= 3 && static_cast<uint8_t>(retstr[0]) == 0xef &&
-         static_cast<uint8_t>(retstr[1]) == 0xbb &&
-        static_cast<uint8_t>(retstr[2]) == 0xbf )
-    {
-      // found UTF-8 BOM. simply skip over it
-      retstr = retstr.substr(3);
-    }
-    return retstr;
+    MappedFile file( file_path );
+    return std::string( file.view() );
 }
 
 bool path_exist(const std::string& path)
@@ -200,7 +193,22 @@ std::string TxtFile::load_all() const
 {
     JSONIO_THROW_IF( !exist(), "filesystem", 2, "trying read not existing file  " + file_path );
     JSONIO_THROW_IF( !check_permission(ReadOnly), "filesystem", 3, "other users have not read permission  " + file_path );
-    return read_ascii_file( file_path );
+    if( compression() == Compression::None )
+        return read_ascii_file( file_path );
+
+    FileReadStream input( file_path );
+    std::stringstream buffer;
+    buffer << input.rdbuf();
+    set_statistics( input.statistics() );
+    return buffer.str();
+}
+
+void TxtFile::set_statistics( const StreamStatistics& statistics ) const
+{
+    stream_statistics = statistics;
+    if( compression() != Compression::None )
+        io_logger->debug("File {}: {} bytes into file, compression ratio {:.2f}, {:.1f} MB/s",
+                         file_path, statistics.file_bytes, statistics.ratio(), statistics.throughput());
 }
 
 //  JsonFile   --------------------------------------------------------------
@@ -225,22 +233,255 @@ std::string JsonFile::load_json() const
 
 void JsonFile::loadJson(JsonBase& object) const
 {
-    auto jsonstr = TxtFile::load_all();
-    object.loads(jsonstr);
+    if( compression() != Compression::None )
+    {
+        object.loads( TxtFile::load_all() );
+        return;
+    }
+
+    // parse the mapped file without copy
+    JSONIO_THROW_IF( !exist(), "filesystem", 2, "trying read not existing file  " + file_path );
+    JSONIO_THROW_IF( !check_permission(ReadOnly), "filesystem", 3, "other users have not read permission  " + file_path );
+    MappedFile file( file_path );
+    JsonParser parser( file.view() );
+    parser.parse_to( &object );
 }
 
 void JsonFile::saveJson(const JsonBase& object) const
 {
-    std::fstream fout(file_path, std::ios::out );
-    JSONIO_THROW_IF( !fout.good(), "filesystem", 5, "file save error...  " + file_path );
+    FileWriteStream fout( file_path );
     object.dump( fout, false );
+    fout.buffer().close();
+    set_statistics( fout.statistics() );
+}
+
+void JsonFile::save_atomic( const JsonBase& object ) const
+{
+    // the temporary file keeps extension to be written with the same compression
+    auto path = fs::path( file_path );
+    auto temp_path = ( path.parent_path() / ( ".~" + path.filename().string() ) ).string();
+    try {
+        FileWriteStream fout( temp_path );
+        object.dump( fout, false );
+        fout.buffer().flush( true );
+        fout.buffer().close();
+        set_statistics( fout.statistics() );
+        fs::rename( temp_path, file_path );
+    }
+    catch( const fs::filesystem_error& err )
+    {
+        std::error_code ec;
+        fs::remove( temp_path, ec );
+        JSONIO_THROW( "filesystem", 12, "error replacing file " + file_path + " : " + err.what() );
+    }
+    catch( ... )
+    {
+        std::error_code ec;
+        fs::remove( temp_path, ec );
+        throw;
+    }
+}
+
+//  JsonArrayReader --------------------------------------------------------------------------
+
+std::size_t JsonArrayReader::block_size = 64*1024;
+
+bool JsonArrayReader::read_block()
+{
+    if( !input.good() )
+        return false;
+    buffer.resize( block_size );
+    input.read( buffer.data(), static_cast<std::streamsize>( block_size ) );
+    buffer.resize( static_cast<std::size_t>( input.gcount() ) );
+    bytes_read += buffer.size();
+    pos = 0;
+    return !buffer.empty();
+}
+
+bool JsonArrayReader::skip_space()
+{
+    while( true )
+    {
+        while( pos < buffer.size() && isspace( static_cast<unsigned char>( buffer[pos] ) ) )
+            pos++;
+        if( pos < buffer.size() )
+            return true;
+        if( !read_block() )
+            return false;
+    }
+}
+
+bool JsonArrayReader::next( std::string& element )
+{
+    element.clear();
+    if( finished )
+        return false;
+
+    if( !started )
+    {
+        // an empty stream is an empty array
+        if( !skip_space() )
+        {
+            finished = true;
+            return false;
+        }
+        // skip over optional UTF-8 BOM
+        if( buffer.size()-pos >= 3 && buffer.compare( pos, 3, "\xef\xbb\xbf" ) == 0 )
+        {
+            pos += 3;
+            JSONIO_THROW_IF( !skip_space(), "JsonArrayReader", 2, " unexpected end of json array." );
+        }
+        JSONIO_THROW_IF( buffer[pos] != '[', "JsonArrayReader", 1, " the json array must start with '['." );
+        pos++;
+        started = true;
+        complete_size = bytes_read - buffer.size() + pos;
+    }
+
+    JSONIO_THROW_IF( !skip_space(), "JsonArrayReader", 2, " unexpected end of json array." );
+    if( buffer[pos] == ']' )
+    {
+        finished = true;
+        return false;
+    }
+
+    // the element ends by ',' or ']' out of strings and nested structures
+    int depth = 0;
+    bool in_string = false;
+    bool escaped = false;
+    while( true )
+    {
+        auto start = pos;
+        for( ; pos < buffer.size(); ++pos )
+        {
+            char ch = buffer[pos];
+            if( in_string )
+            {
+                if( escaped )
+                    escaped = false;
+                else if( ch == '\\' )
+                    escaped = true;
+                else if( ch == '"' )
+                    in_string = false;
+            }
+            else if( ch == '"' )
+                in_string = true;
+            else if( ch == '{' || ch == '[' )
+                depth++;
+            else if( ch == '}' || ch == ']' )
+            {
+                if( depth == 0 )
+                    break;
+                depth--;
+            }
+            else if( ch == ',' && depth == 0 )
+                break;
+        }
+        element.append( buffer, start, pos-start );
+        if( pos < buffer.size() )
+            break;
+        JSONIO_THROW_IF( !read_block(), "JsonArrayReader", 2, " unexpected end of json array." );
+    }
+
+    while( !element.empty() && isspace( static_cast<unsigned char>( element.back() ) ) )
+        element.pop_back();
+    JSONIO_THROW_IF( element.empty(), "JsonArrayReader", 3, " empty element of json array." );
+    complete_size = bytes_read - buffer.size() + pos;
+    if( buffer[pos] == ',' )
+        pos++;
+    return true;
 }
 
 //  JsonArrayFile --------------------------------------------------------------------------
 
+JsonArrayFile::JsonArrayFile( JsonArrayFile &&obj ):
+    JsonFile( std::move(obj) ), loaded_ndx( obj.loaded_ndx ), arr_object( std::move(obj.arr_object) ),
+    input_stream( std::move(obj.input_stream) ), array_reader( std::move(obj.array_reader) ),
+    element_text( std::move(obj.element_text) ), output_stream( std::move(obj.output_stream) ),
+    stream_write( obj.stream_write ), checkpoint_elements( obj.checkpoint_elements )
+{
+    // the destructor of moved file must not close or save the array
+    obj.is_opened = false;
+}
+
+JsonArrayFile &JsonArrayFile::operator =( JsonArrayFile &&other)
+{
+    if( this != &other )
+    {
+        if( is_opened )
+            Close();
+        JsonFile::operator =( std::move(other) );
+        loaded_ndx = other.loaded_ndx;
+        arr_object = std::move(other.arr_object);
+        input_stream = std::move(other.input_stream);
+        array_reader = std::move(other.array_reader);
+        element_text = std::move(other.element_text);
+        output_stream = std::move(other.output_stream);
+        stream_write = other.stream_write;
+        checkpoint_elements = other.checkpoint_elements;
+        other.is_opened = false;
+    }
+    return *this;
+}
+
+void JsonArrayFile::checkpoint()
+{
+    if( !output_stream )
+        return;
+    auto& writer = output_stream->buffer();
+    if( writer.seekable() )
+    {
+        // closing bracket is overwritten by the next element
+        *output_stream << "\n]";
+        writer.flush( true );
+        writer.seekBack( 2 );
+    }
+    else
+    {
+        writer.flush( true );
+    }
+}
+
+std::size_t JsonArrayFile::recover()
+{
+    JSONIO_THROW_IF( isOpened(), "filesystem", 8, "file was opened " + file_path );
+    JSONIO_THROW_IF( !exist(), "filesystem", 2, "trying read not existing file  " + file_path );
+    JSONIO_THROW_IF( compression_from_path( file_path ) != Compression::None, "filesystem", 13,
+                     "only plain file could be recovered " + file_path );
+
+    std::size_t count = 0;
+    std::size_t complete_size = 0;
+    {
+        FileReadStream input( file_path );
+        JsonArrayReader reader( input );
+        std::string element;
+        try {
+            while( reader.next( element ) )
+                count++;
+            return count;   // the array is closed
+        }
+        catch( jsonio_exception& )
+        {
+            complete_size = reader.completeSize();
+        }
+    }
+    io_logger->warn("Recover json array file {}: {} elements are kept", file_path, count );
+    fs::resize_file( file_path, complete_size );
+    std::ofstream fout( file_path, std::ios::binary | std::ios::app );
+    fout << ( complete_size == 0 ? "[\n]\n" : "\n]\n" );
+    JSONIO_THROW_IF( !fout.good(), "filesystem", 5, "error writing file " + file_path );
+    return count;
+}
 
 bool JsonArrayFile::loadNext( std::string &strjson )
 {
+    if( array_reader )
+    {
+        if( !array_reader->next( strjson ) )
+            return false;
+        loaded_ndx++;
+        return true;
+    }
+
     if( loaded_ndx >= arr_object.size() )
         return false;
 
@@ -250,18 +491,30 @@ bool JsonArrayFile::loadNext( std::string &strjson )
 
 bool JsonArrayFile::loadNext( JsonBase &object )
 {
-    std::string jsonstr;
-
-    if( loadNext(jsonstr) )
+    if( array_reader )
     {
-        object.loads(jsonstr);
+        if( !loadNext( element_text ) )
+            return false;
+        object.loads( element_text );
         return true;
     }
-    return false;
+    if( loaded_ndx >= arr_object.size() )
+        return false;
+
+    object.loads( arr_object[loaded_ndx++].dump( true ) );
+    return true;
 }
 
 bool JsonArrayFile::saveNext(const std::string &strjson)
 {
+   if( output_stream )
+   {
+       *output_stream << ( loaded_ndx++ > 0 ? ",\n" : "\n" );
+       json::minify( *output_stream, strjson );
+       if( checkpoint_elements > 0 && loaded_ndx%checkpoint_elements == 0 )
+           checkpoint();
+       return true;
+   }
    loaded_ndx = arr_object.size();
  //  arr_object[ loaded_ndx ] = JsonFree::object(); //??? do we need
    arr_object[ loaded_ndx ].loads(strjson);
@@ -270,15 +523,36 @@ bool JsonArrayFile::saveNext(const std::string &strjson)
 
 bool JsonArrayFile::saveNext(const JsonBase &object)
 {
+  if( output_stream )
+  {
+      *output_stream << ( loaded_ndx++ > 0 ? ",\n" : "\n" );
+      object.dump( *output_stream, true );
+      if( checkpoint_elements > 0 && loaded_ndx%checkpoint_elements == 0 )
+          checkpoint();
+      return true;
+  }
   return saveNext( object.dump() );
 }
 
 void JsonArrayFile::Close()
 {
-    if( open_mode == WriteOnly )
+    if( output_stream )
+    {
+        auto output = std::move( output_stream );
+        *output << "\n]\n";
+        output->buffer().close();
+        set_statistics( output->statistics() );
+    }
+    else if( open_mode == WriteOnly )
     {
         save(arr_object);
     }
+    if( input_stream )
+        set_statistics( input_stream->statistics() );
+    array_reader.reset();
+    input_stream.reset();
+    element_text.clear();
+    element_text.shrink_to_fit();
     is_opened = false;
 }
 
@@ -297,9 +571,19 @@ void JsonArrayFile::Open( TxtFile::OpenModeTypes amode )
 
     if( open_mode == ReadOnly )
     {
-        load( arr_object );
+        JSONIO_THROW_IF( !exist(), "filesystem", 2, "trying read not existing file  " + file_path );
+        input_stream = std::make_shared<FileReadStream>( file_path );
+        array_reader = std::make_shared<JsonArrayReader>( *input_stream );
+    }
+    else if( open_mode == WriteOnly )
+    {
+        if( stream_write )
+        {
+            output_stream = std::make_shared<FileWriteStream>( file_path );
+            *output_stream << "[";
+        }
     }
-    else if( open_mode != WriteOnly )
+    else
     {
         JSONIO_THROW( "filesystem", 7, "illegal file open mode for class JsonArrayFile" );
     }
@@ -323,12 +607,207 @@ void JsonArrayFile::loadString( const std::string &json_string )
 
 std::string JsonArrayFile::getString()
 {
-    if( open_mode == WriteOnly )
+    if( open_mode == WriteOnly && !stream_write )
     {
         return arr_object.dump();
     }
     return "";
 }
 
+//  JsonLinesFile --------------------------------------------------------------------------
+
+std::size_t JsonLinesFile::chunk_size = 4*1024*1024;
+
+void JsonLinesFile::Open( TxtFile::OpenModeTypes amode )
+{
+    if( isOpened() )
+    {
+        JSONIO_THROW_IF( open_mode!=amode, "filesystem", 6, "file was opened in different mode  " + file_path );
+        return;
+    }
+
+    open_mode  = amode;
+    loaded_ndx = 0;
+    if( open_mode == ReadOnly )
+    {
+        JSONIO_THROW_IF( !exist(), "filesystem", 2, "trying read not existing file  " + file_path );
+        input_stream = std::make_shared<FileReadStream>( file_path );
+    }
+    else if( open_mode == WriteOnly || open_mode == Append )
+    {
+        output_stream = std::make_shared<FileWriteStream>( file_path, open_mode == Append );
+    }
+    else
+    {
+        JSONIO_THROW( "filesystem", 7, "illegal file open mode for class JsonLinesFile" );
+    }
+    is_opened = true;
+}
+
+void JsonLinesFile::Close()
+{
+    if( input_stream )
+    {
+        set_statistics( input_stream->statistics() );
+        input_stream.reset();
+    }
+    if( output_stream )
+    {
+        auto output = std::move( output_stream );
+        output->buffer().close();
+        set_statistics( output->statistics() );
+    }
+    is_opened = false;
+}
+
+bool JsonLinesFile::loadNext( std::string& strjson )
+{
+    JSONIO_THROW_IF( !input_stream, "filesystem", 9, "file was not opened for reading " + file_path );
+    while( std::getline( *input_stream, strjson ) )
+    {
+        if( !strjson.empty() && strjson.back() == '\r' )
+            strjson.pop_back();
+        if( strjson.find_first_not_of( " \t" ) == std::string::npos )
+            continue;
+        loaded_ndx++;
+        return true;
+    }
+    return false;
+}
+
+bool JsonLinesFile::loadNext( JsonBase& object )
+{
+    if( !loadNext( line_text ) )
+        return false;
+    object.loads( line_text );
+    return true;
+}
+
+bool JsonLinesFile::saveNext( const std::string& strjson )
+{
+    JSONIO_THROW_IF( !output_stream, "filesystem", 9, "file was not opened for writing " + file_path );
+    json::minify( *output_stream, strjson );
+    *output_stream << '\n';
+    loaded_ndx++;
+    return output_stream->good();
+}
+
+bool JsonLinesFile::saveNext( const JsonBase& object )
+{
+    JSONIO_THROW_IF( !output_stream, "filesystem", 9, "file was not opened for writing " + file_path );
+    object.dump( *output_stream, true );
+    *output_stream << '\n';
+    loaded_ndx++;
+    return output_stream->good();
+}
+
+std::size_t JsonLinesFile::loadAll( Record_f func, bool ordered, std::size_t threads_count ) const
+{
+    JSONIO_THROW_IF( !exist(), "filesystem", 2, "trying read not existing file  " + file_path );
+    FileReadStream input( file_path );
+
+    // chunks of file are cut after the last newline, the rest is moved to the next chunk
+    std::string rest_text;
+    auto read_chunk = [&input, &rest_text]( std::string& text )
+    {
+        text.swap( rest_text );
+        rest_text.clear();
+        while( true )
+        {
+            auto size = text.size();
+            text.resize( size+chunk_size );
+            input.read( text.data()+size, static_cast<std::streamsize>( chunk_size ) );
+            text.resize( size+static_cast<std::size_t>( input.gcount() ) );
+            if( !input )
+                break;
+            auto last_line = text.rfind( '\n' );
+            if( last_line != std::string::npos )
+            {
+                rest_text = text.substr( last_line+1 );
+                text.resize( last_line+1 );
+                break;
+            }
+        }
+        return !text.empty();
+    };
+
+    using Records = std::vector<JsonFree>;
+    std::mutex func_mutex;
+    std::size_t records_count = 0;
+    auto parse_chunk = [&func, &func_mutex, &records_count, ordered]( const std::string& text )
+    {
+        Records records;
+        for( std::size_t start = 0; start < text.size(); )
+        {
+            auto end = text.find( '\n', start );
+            if( end == std::string::npos )
+                end = text.size();
+            auto line_end = ( end > start && text[end-1] == '\r' ? end-1 : end );
+            if( text.find_first_not_of( " \t", start ) < line_end )
+            {
+                records.push_back( JsonFree::object() );
+                records.back().loads( text.substr( start, line_end-start ) );
+                if( !ordered )
+                {
+                    std::lock_guard<std::mutex> lock( func_mutex );
+                    func( records.back() );
+                    records_count++;
+                    records.clear();
+                }
+            }
+            start = end+1;
+        }
+        return records;
+    };
+    auto deliver = [&func, &records_count]( const Records& records )
+    {
+        for( const auto& record: records )
+            func( record );
+        records_count += records.size();
+    };
+
+    if( threads_count == 0 )
+        threads_count = std::max( 1u, std::thread::hardware_concurrency() );
+    std::string text;
+    if( threads_count <= 1 )
+    {
+        while( read_chunk( text ) )
+            deliver( parse_chunk( text ) );
+    }
+    else
+    {
+        // parsed chunks wait in order of file, no more than 2 chunks for each thread
+        ThreadPool pool( threads_count );
+        std::deque<std::future<Records>> in_flight;
+        bool end_of_file = false;
+        try {
+            while( !end_of_file || !in_flight.empty() )
+            {
+                while( !end_of_file && in_flight.size() < 2*threads_count )
+                {
+                    end_of_file = !read_chunk( text );
+                    if( !end_of_file )
+                        in_flight.push_back( pool.submit( [&parse_chunk, chunk_text = std::move( text )]() {
+                            return parse_chunk( chunk_text );
+                        }) );
+                    text = std::string();
+                }
+                if( in_flight.empty() )
+                    break;
+                auto records = in_flight.front().get();
+                in_flight.pop_front();
+                deliver( records );
+            }
+        }
+        catch(...)
+        {
+            for( auto& task: in_flight )
+                task.wait();
+            throw;
+        }
+    }
+    set_statistics( input.statistics() );
+    return records_count;
+}
 
 } // namespace jsonio
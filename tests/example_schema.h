@@ -491,3 +491,134 @@ const char* const query_schema_str = R"({
                                      ]
                                    }
 )";
+
+const char* const graph_schema_str = R"({
+                                     "name": "graph",
+                                     "namespaces": {
+                                       "*": "graph"
+                                     },
+                                     "includes": [
+                                     ],
+                                     "enums": [
+                                     ],
+                                     "typedefs": [
+                                     ],
+                                     "structs": [
+                                       {
+                                         "name": "GraphPoint",
+                                         "doc": "Vertex of the test graph\n",
+                                         "isException": false,
+                                         "isUnion": false,
+                                         "fields": [
+                                           {
+                                             "key": 1,
+                                             "name": "_id",
+                                             "typeId": "string",
+                                             "doc": "Handle of document\n",
+                                             "required": "required"
+                                           },
+                                           {
+                                             "key": 2,
+                                             "name": "_key",
+                                             "typeId": "string",
+                                             "doc": "Key of document\n",
+                                             "required": "required"
+                                           },
+                                           {
+                                             "key": 3,
+                                             "name": "_type",
+                                             "typeId": "string",
+                                             "doc": "Type of document\n",
+                                             "required": "required",
+                                             "default": "vertex"
+                                           },
+                                           {
+                                             "key": 4,
+                                             "name": "_label",
+                                             "typeId": "string",
+                                             "doc": "Label of vertex\n",
+                                             "required": "required",
+                                             "default": "point"
+                                           },
+                                           {
+                                             "key": 5,
+                                             "name": "name",
+                                             "typeId": "string",
+                                             "doc": "Name of point\n",
+                                             "required": "req_out"
+                                           },
+                                           {
+                                             "key": 6,
+                                             "name": "weight",
+                                             "typeId": "double",
+                                             "doc": "Weight of point\n",
+                                             "required": "req_out",
+                                             "default": 1.5
+                                           }
+                                         ]
+                                       },
+                                       {
+                                         "name": "GraphLink",
+                                         "doc": "Edge of the test graph\n",
+                                         "isException": false,
+                                         "isUnion": false,
+                                         "fields": [
+                                           {
+                                             "key": 1,
+                                             "name": "_id",
+                                             "typeId": "string",
+                                             "doc": "Handle of document\n",
+                                             "required": "required"
+                                           },
+                                           {
+                                             "key": 2,
+                                             "name": "_key",
+                                             "typeId": "string",
+                                             "doc": "Key of document\n",
+                                             "required": "required"
+                                           },
+                                           {
+                                             "key": 3,
+                                             "name": "_type",
+                                             "typeId": "string",
+                                             "doc": "Type of document\n",
+                                             "required": "required",
+                                             "default": "edge"
+                                           },
+                                           {
+                                             "key": 4,
+                                             "name": "_label",
+                                             "typeId": "string",
+                                             "doc": "Label of edge\n",
+                                             "required": "required",
+                                             "default": "links"
+                                           },
+                                           {
+                                             "key": 5,
+                                             "name": "_from",
+                                             "typeId": "string",
+                                             "doc": "Handle of outgoing vertex\n",
+                                             "required": "required"
+                                           },
+                                           {
+                                             "key": 6,
+                                             "name": "_to",
+                                             "typeId": "string",
+                                             "doc": "Handle of incoming vertex\n",
+                                             "required": "required"
+                                           },
+                                           {
+                                             "key": 7,
+                                             "name": "length",
+                                             "typeId": "i32",
+                                             "doc": "Length of link\n",
+                                             "required": "req_out",
+                                             "default": 3
+                                           }
+                                         ]
+                                       }
+                                     ],
+                                     "services": [
+                                     ]
+                                   }
+)";
@@ -3,6 +3,7 @@
 
 #include "tst_jsonio.h"
 #include "tst_service.h"
+#include "tst_shared_pool.h"
 #include "tst_detail.h"
 #include "tst_dump.h"
 #include "tst_builder.h"
@@ -12,6 +13,12 @@
 #include "tst_base_complex.h"
 #include "tst_schema.h"
 #include "tst_jsonschema.h"
+#include "tst_dbcache.h"
+#include "tst_dbcursor.h"
+#include "tst_dbdriverfile.h"
+#include "tst_dbdrivermemory.h"
+#include "tst_dbqueryresult.h"
+#include "tst_traversal.h"
 #include "tst_dbquery.h"
 #include "spdlog/spdlog.h"
 
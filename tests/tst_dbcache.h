@@ -0,0 +1,119 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include <list>
+
+#include "jsonio/dbcache.h"
+#include "jsonio/dbkeysindex.h"
+#include "jsonio/jsondump.h"
+
+using namespace testing;
+using namespace jsonio;
+
+TEST( JsonioDocumentsCache, GetPut )
+{
+    DocumentsCache cache( 2 );
+    auto document = json::loads( "{\"_id\":\"test/1\",\"_rev\":\"r1\",\"value\":5}" );
+    auto cached = JsonFree::object();
+
+    EXPECT_FALSE( cache.get( "test/1", cached ) );
+    cache.put( "test/1", document );
+    EXPECT_EQ( cache.size(), 1u );
+    EXPECT_EQ( cache.revision( "test/1" ), "r1" );
+    EXPECT_TRUE( cache.get( "test/1", cached ) );
+    EXPECT_EQ( cached.dump( true ), document.dump( true ) );
+
+    auto stat = cache.statistics();
+    EXPECT_EQ( stat.hits, 1u );
+    EXPECT_EQ( stat.misses, 1u );
+    EXPECT_EQ( stat.size, 1u );
+    EXPECT_EQ( stat.max_size, 2u );
+}
+
+TEST( JsonioDocumentsCache, Eviction )
+{
+    DocumentsCache cache( 2 );
+    auto cached = JsonFree::object();
+    cache.put( "test/1", json::loads( "{\"_id\":\"test/1\"}" ) );
+    cache.put( "test/2", json::loads( "{\"_id\":\"test/2\"}" ) );
+    // test/1 becomes the recently used one
+    EXPECT_TRUE( cache.get( "test/1", cached ) );
+    cache.put( "test/3", json::loads( "{\"_id\":\"test/3\"}" ) );
+
+    EXPECT_EQ( cache.size(), 2u );
+    EXPECT_TRUE( cache.get( "test/1", cached ) );
+    EXPECT_FALSE( cache.get( "test/2", cached ) );
+    EXPECT_TRUE( cache.get( "test/3", cached ) );
+    EXPECT_EQ( cache.statistics().evictions, 1u );
+}
+
+TEST( JsonioDocumentsCache, Invalidate )
+{
+    DocumentsCache cache( 4 );
+    auto cached = JsonFree::object();
+    cache.put( "test/1", json::loads( "{\"_id\":\"test/1\",\"_rev\":\"r1\"}" ) );
+    cache.put( "test/2", json::loads( "{\"_id\":\"test/2\",\"_rev\":\"r1\"}" ) );
+
+    cache.invalidate( "test/1" );
+    cache.invalidate( "test/5" );
+    cache.outdated( "test/2" );
+    EXPECT_FALSE( cache.get( "test/1", cached ) );
+    EXPECT_FALSE( cache.get( "test/2", cached ) );
+    EXPECT_EQ( cache.revision( "test/1" ), "" );
+
+    auto stat = cache.statistics();
+    EXPECT_EQ( stat.invalidations, 1u );
+    EXPECT_EQ( stat.outdated, 1u );
+    EXPECT_EQ( stat.size, 0u );
+}
+
+TEST( JsonioDocumentsCache, ReadGeneration )
+{
+    DocumentsCache cache( 4 );
+    auto cached = JsonFree::object();
+    auto generation = cache.generation();
+    EXPECT_TRUE( cache.put( "test/1", json::loads( "{\"_id\":\"test/1\",\"_rev\":\"r1\"}" ), generation ) );
+
+    // the document was changed while it was read
+    generation = cache.generation();
+    cache.invalidate( "test/2" );
+    EXPECT_FALSE( cache.put( "test/2", json::loads( "{\"_id\":\"test/2\",\"_rev\":\"r1\"}" ), generation ) );
+    EXPECT_FALSE( cache.get( "test/2", cached ) );
+    EXPECT_TRUE( cache.get( "test/1", cached ) );
+}
+
+TEST( JsonioKeysIndex, PrefixQuery )
+{
+    std::vector<std::string> ids = { "test/abc", "test/abc_0", "test/abd", "test/b", "other/abc" };
+    KeysIndex index;
+    for( const auto& id: ids )
+        index.insert( id );
+
+    EXPECT_EQ( index.size(), 5u );
+    EXPECT_TRUE( index.contains( "test/abd" ) );
+    EXPECT_TRUE( index.has_prefix( "test/ab" ) );
+    EXPECT_FALSE( index.has_prefix( "test/c" ) );
+    EXPECT_EQ( index.with_prefix( "test/abc" ), std::vector<std::string>( { "test/abc", "test/abc_0" } ) );
+
+    index.erase( "test/abc_0" );
+    EXPECT_EQ( index.with_prefix( "test/abc" ), std::vector<std::string>( { "test/abc" } ) );
+    index.clear();
+    EXPECT_EQ( index.size(), 0u );
+}
+
+TEST( JsonioKeysIndex, UniqueSuffix )
+{
+    // the index refers to strings, so they must not be moved
+    std::list<std::string> ids = { "test/abc", "test/abc_0", "test/abc_1" };
+    KeysIndex index;
+    for( const auto& id: ids )
+        index.insert( id );
+
+    EXPECT_EQ( index.unique_suffix( "test/new" ), "" );
+    EXPECT_EQ( index.unique_suffix( "test/abc" ), "_2" );
+    // the suffix is not used until the id is added
+    EXPECT_EQ( index.unique_suffix( "test/abc" ), "_2" );
+    ids.push_back( "test/abc_2" );
+    index.insert( ids.back() );
+    EXPECT_EQ( index.unique_suffix( "test/abc" ), "_3" );
+}
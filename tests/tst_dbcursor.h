@@ -0,0 +1,71 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include <atomic>
+
+#include "jsonio/dbcursor.h"
+#include "jsonio/exceptions.h"
+
+using namespace testing;
+using namespace jsonio;
+
+TEST( JsonioDBQueryCursor, ReadBatches )
+{
+    DBQueryCursor cursor( []( SetReaded_f setfnc ) {
+        for( int ii=0; ii<7; ++ii )
+            setfnc( std::to_string(ii) );
+    }, 3 );
+
+    EXPECT_EQ( cursor.batchSize(), 3u );
+    EXPECT_EQ( cursor.nextBatch(), values_t( { "0", "1", "2" } ) );
+    std::string jsondata;
+    EXPECT_TRUE( cursor.next( jsondata ) );
+    EXPECT_EQ( jsondata, "3" );
+    EXPECT_EQ( cursor.nextBatch(), values_t( { "4", "5", "6" } ) );
+    EXPECT_TRUE( cursor.atEnd() );
+    EXPECT_TRUE( cursor.nextBatch().empty() );
+    EXPECT_FALSE( cursor.next( jsondata ) );
+    EXPECT_EQ( cursor.fetched(), 7u );
+}
+
+TEST( JsonioDBQueryCursor, Backpressure )
+{
+    std::atomic<int> produced = 0;
+    DBQueryCursor cursor( [&produced]( SetReaded_f setfnc ) {
+        for( int ii=0; ii<100; ++ii )
+        {
+            setfnc( std::to_string(ii) );
+            produced++;
+        }
+    }, 2, 2 );
+
+    std::this_thread::sleep_for( std::chrono::milliseconds(20) );
+    // the query waits for the consumer when 4 documents are buffered
+    EXPECT_LE( produced.load(), 5 );
+    EXPECT_EQ( cursor.nextBatch().size(), 2u );
+    int count = 2;
+    std::string jsondata;
+    while( cursor.next( jsondata ) )
+        count++;
+    EXPECT_EQ( count, 100 );
+}
+
+TEST( JsonioDBQueryCursor, ErrorAndCancel )
+{
+    DBQueryCursor cursor( []( SetReaded_f setfnc ) {
+        setfnc( "0" );
+        JSONIO_THROW( "Test", 1, " query error" );
+    }, 10 );
+
+    std::string jsondata;
+    EXPECT_TRUE( cursor.next( jsondata ) );
+    EXPECT_THROW( cursor.next( jsondata ), jsonio_exception );
+    EXPECT_FALSE( cursor.next( jsondata ) );
+
+    DBQueryCursor endless( []( SetReaded_f setfnc ) {
+        while( true )
+            setfnc( "data" );
+    }, 10 );
+    EXPECT_EQ( endless.nextBatch().size(), 10u );
+    // the destructor stops the query
+}
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include <filesystem>
+#ifndef _WIN32
+#include <csignal>
+#include <sys/resource.h>
+#endif
+
+#include "jsonio/dbdriverfile.h"
+#include "jsonio/dbquerymatcher.h"
+#include "jsonio/dbconnect.h"
+#include "jsonio/dbcollection.h"
+#include "jsonio/jsonfree.h"
+
+using namespace testing;
+using namespace jsonio;
+
+namespace {
+
+std::vector<std::string> select_by( const DBQueryBase& query, const std::vector<std::string>& documents )
+{
+    std::vector<std::string> results;
+    DBQueryMatcher matcher( query );
+    matcher.select( [&]( const DBQueryMatcher::Visit_f& visitor ) {
+        for( const auto& jsondata: documents )
+            if( matcher.mayMatch( jsondata ) )
+                visitor( json::loads( jsondata ), jsondata );
+    }, [&]( const std::string& jsondata ) {
+        results.push_back( jsondata );
+    });
+    return results;
+}
+
+std::string field_value( const JsonBase& object, const std::string& fieldpath )
+{
+    std::string value;
+    object.get_value_via_path( fieldpath, value, std::string("") );
+    return value;
+}
+
+const std::vector<std::string> matcher_documents = {
+    "{\"_id\":\"test/1\",\"name\":\"a\",\"value\":10,\"properties\":{\"kind\":\"x\"}}",
+    "{\"_id\":\"test/2\",\"name\":\"b\",\"value\":60,\"properties\":{\"kind\":\"y\"}}",
+    "{\"_id\":\"test/3\",\"name\":\"a\",\"value\":70,\"properties\":{\"kind\":\"y\"}}",
+    "{\"_id\":\"edge/1\",\"_from\":\"test/1\",\"_to\":\"test/2\"}"
+};
+
+} // namespace
+
+TEST( JsonioDBQueryMatcher, TemplateAndEdges )
+{
+    auto result = select_by( DBQueryBase( "{ \"name\" : \"a\" }", DBQueryBase::qTemplate ), matcher_documents );
+    EXPECT_EQ( result, std::vector<std::string>( { matcher_documents[0], matcher_documents[2] } ) );
+    result = select_by( DBQueryBase( "{ \"name\" : \"a\", \"properties\": { \"kind\": \"y\" } }", DBQueryBase::qTemplate ),
+                        matcher_documents );
+    EXPECT_EQ( result, std::vector<std::string>( { matcher_documents[2] } ) );
+
+    result = select_by( DBQueryBase( "{ \"startVertex\": \"test/2\", \"edgeCollections\": \"\" }", DBQueryBase::qEdgesFrom ),
+                        matcher_documents );
+    EXPECT_TRUE( result.empty() );
+    result = select_by( DBQueryBase( "{ \"startVertex\": \"test/2\", \"edgeCollections\": \"\" }", DBQueryBase::qEdgesAll ),
+                        matcher_documents );
+    EXPECT_EQ( result, std::vector<std::string>( { matcher_documents[3] } ) );
+}
+
+TEST( JsonioDBQueryMatcher, AQLSubset )
+{
+    auto result = select_by( DBQueryBase( "FOR u IN test\nFILTER u.value > 50 && u.properties.kind == 'y'\n"
+                                          "SORT u.value DESC\nRETURN { \"_id\": u._id, \"name\":u.name }",
+                                          DBQueryBase::qAQL ), matcher_documents );
+    EXPECT_EQ( result, std::vector<std::string>( { "{\"_id\":\"test/3\",\"name\":\"a\"}",
+                                                   "{\"_id\":\"test/2\",\"name\":\"b\"}" } ) );
+
+    DBQueryBase bind_query( "FOR u IN test FILTER u.name IN @names OR u._from == @id LIMIT 1, 2 RETURN u._id", DBQueryBase::qAQL );
+    bind_query.setBindVars( "{ \"names\": [\"a\", \"b\"], \"id\": \"test/1\" }" );
+    result = select_by( bind_query, matcher_documents );
+    EXPECT_EQ( result, std::vector<std::string>( { "\"test/2\"", "\"test/3\"" } ) );
+
+    result = select_by( DBQueryBase( "FOR u IN test FILTER u.name LIKE 'a%' RETURN DISTINCT u.name", DBQueryBase::qAQL ),
+                        matcher_documents );
+    EXPECT_EQ( result, std::vector<std::string>( { "\"a\"" } ) );
+
+    DBQueryBase fields_query( "FOR u IN test FILTER NOT (u.value < 65)", DBQueryBase::qAQL );
+    fields_query.setQueryFields( std::vector<std::string>{ "properties.kind" } );
+    result = select_by( fields_query, matcher_documents );
+    EXPECT_EQ( result, std::vector<std::string>( { "{\"properties_kind\":\"y\"}" } ) );
+
+    EXPECT_THROW( select_by( DBQueryBase( "FOR u IN test COLLECT a = u.name RETURN a", DBQueryBase::qAQL ), matcher_documents ),
+                  jsonio_exception );
+}
+
+TEST( JsonioFileDBClient, CrudAndReopen )
+{
+    auto db_directory = ( std::filesystem::temp_directory_path() / "jsonio_test_localdb" ).string();
+    std::filesystem::remove_all( db_directory );
+    {
+        FileDBClient client( db_directory, "test" );
+        client.create_collection( "vertex", "vertex" );
+        client.create_collection( "edge", "edge" );
+        EXPECT_EQ( client.get_collections_names( AbstractDBDriver::clEdge ), std::set<std::string>( { "edge" } ) );
+
+        std::string second;
+        auto data = json::loads( "{ \"_key\": \"v1\", \"name\": \"first\" }" );
+        EXPECT_EQ( client.create_record( "vertex", second, data ), "vertex/v1" );
+        EXPECT_THROW( client.create_record( "vertex", second, data ), jsonio_exception );
+        data = json::loads( "{ \"name\": \"second\" }" );
+        auto generated_id = client.create_record( "vertex", second, data );
+        data = json::loads( "{ \"_from\": \"vertex/v1\", \"_to\": \"" + generated_id + "\" }" );
+        client.create_record( "edge", second, data );
+
+        keysmap_t keys{ { "vertex/v1", "vertex/v1" } };
+        auto itr = keys.begin();
+        data = json::loads( "{ \"_key\": \"v1\", \"name\": \"updated\" }" );
+        client.update_record( "vertex", itr, data );
+        auto readed = JsonFree::object();
+        EXPECT_TRUE( client.read_record( "vertex", itr, readed ) );
+        EXPECT_EQ( field_value( readed, "name" ), "updated" );
+        EXPECT_EQ( field_value( readed, "_id" ), "vertex/v1" );
+    }
+    {
+        // data is restored from the segment files
+        FileDBClient client( db_directory, "test" );
+        std::vector<std::string> names;
+        client.fpath_collect( "vertex", "name", names );
+        EXPECT_EQ( names, std::vector<std::string>( { "second", "updated" } ) );
+
+        std::vector<std::string> edges;
+        client.select_query( "vertex", DBQueryBase( "{ \"startVertex\": \"vertex/v1\", \"edgeCollections\": \"edge\" }",
+                                                    DBQueryBase::qEdgesFrom ), [&edges]( const std::string& jsondata ) {
+            edges.push_back( jsondata );
+        });
+        EXPECT_EQ( edges.size(), 1u );
+        client.delete_edges( "edge", "vertex/v1" );
+        client.remove_by_ids( "vertex", { "v1" } );
+        client.compact();
+
+        std::size_t count = 0;
+        client.all_query( "vertex", { "_id" }, [&count]( const std::string&, const std::string& ) { count++; } );
+        client.all_query( "edge", { "_id" }, [&count]( const std::string&, const std::string& ) { count++; } );
+        EXPECT_EQ( count, 1u );
+    }
+    std::filesystem::remove_all( db_directory );
+}
+
+#ifndef _WIN32
+TEST( JsonioFileDBClient, FailedWriteDiscarded )
+{
+    auto db_directory = ( std::filesystem::temp_directory_path() / "jsonio_test_failed_write" ).string();
+    std::filesystem::remove_all( db_directory );
+    auto segment_path = std::filesystem::path( db_directory ) / "test.000001.seg";
+    std::string jsondata;
+    {
+        FileSegmentsStore store( db_directory, "test" );
+        ASSERT_TRUE( store.insert( "test/1", "{\"name\":\"first\"}" ) );
+        auto written_size = std::filesystem::file_size( segment_path );
+
+        // the file size limit breaks the next record in the middle
+        struct rlimit old_limit;
+        ASSERT_EQ( ::getrlimit( RLIMIT_FSIZE, &old_limit ), 0 );
+        auto old_handler = std::signal( SIGXFSZ, SIG_IGN );
+        struct rlimit limit = old_limit;
+        limit.rlim_cur = written_size + 100;
+        ASSERT_EQ( ::setrlimit( RLIMIT_FSIZE, &limit ), 0 );
+        EXPECT_THROW( store.insert( "test/2", "{\"name\":\"" + std::string( 1000, 'x' ) + "\"}" ), jsonio_exception );
+        ::setrlimit( RLIMIT_FSIZE, &old_limit );
+        std::signal( SIGXFSZ, old_handler );
+
+        // the torn record is removed, the next record follows the last written one
+        EXPECT_EQ( std::filesystem::file_size( segment_path ), written_size );
+        EXPECT_FALSE( store.exists( "test/2" ) );
+        ASSERT_TRUE( store.insert( "test/3", "{\"name\":\"third\"}" ) );
+        ASSERT_TRUE( store.get( "test/3", jsondata ) );
+        EXPECT_EQ( jsondata, "{\"name\":\"third\"}" );
+    }
+    {
+        FileSegmentsStore store( db_directory, "test" );
+        EXPECT_EQ( store.ids(), std::vector<std::string>( { "test/1", "test/3" } ) );
+        ASSERT_TRUE( store.get( "test/3", jsondata ) );
+        EXPECT_EQ( jsondata, "{\"name\":\"third\"}" );
+    }
+    std::filesystem::remove_all( db_directory );
+}
+#endif
+
+TEST( JsonioFileDBClient, DataBaseDriver )
+{
+    auto db_directory = ( std::filesystem::temp_directory_path() / "jsonio_test_localdb2" ).string();
+    std::filesystem::remove_all( db_directory );
+    {
+        DataBase db( std::make_shared<FileDBClient>( db_directory, "test" ) );
+        auto coll = db.collection( "test", "vertex" );
+        auto data = json::loads( "{ \"_key\": \"a1\", \"name\": \"a\" }" );
+        auto key = coll->createDocument( data );
+        EXPECT_EQ( key, "test/a1" );
+        EXPECT_TRUE( coll->existsDocument( key ) );
+
+        // a new driver reloads the keys of collections
+        db.updateDriver( std::make_shared<FileDBClient>( db_directory, "test" ) );
+        coll->waitLoaded();
+        EXPECT_EQ( coll->documentsCount(), 1u );
+        auto readed = JsonFree::object();
+        EXPECT_TRUE( coll->readDocument( readed, key ) );
+        EXPECT_EQ( field_value( readed, "name" ), "a" );
+        EXPECT_TRUE( coll->deleteDocument( key ) );
+        EXPECT_FALSE( coll->existsDocument( key ) );
+    }
+    std::filesystem::remove_all( db_directory );
+}
@@ -0,0 +1,371 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+
+#include "jsonio/dbdrivermemory.h"
+#include "jsonio/dbconnect.h"
+#include "jsonio/dbcollection.h"
+#include "jsonio/dbjsondoc.h"
+#include "jsonio/dbvertexdoc.h"
+#include "jsonio/jsonfree.h"
+#include "jsonio/io_settings.h"
+#include "jsonio/schema_thrift.h"
+#include "jsonio/shared_pool.h"
+#include "example_schema.h"
+
+using namespace testing;
+using namespace jsonio;
+
+namespace {
+
+std::set<std::string> select_ids( AbstractDBDriver& client, const std::string& collname, const DBQueryBase& query )
+{
+    std::set<std::string> ids;
+    client.select_query( collname, query, [&ids]( const std::string& jsondata ) {
+        std::string id;
+        json::loads( jsondata ).get_value_via_path( "_id", id, std::string("") );
+        ids.insert( id );
+    });
+    return ids;
+}
+
+/// Memory driver reading the keys of collection slowly
+class SlowKeysDBClient: public MemoryDBClient
+{
+public:
+
+    std::atomic<int> delay_ms = 0;
+
+    void all_query( const std::string& collname, const std::set<std::string>& query_fields,  SetReadedKey_f setfnc ) override
+    {
+        MemoryDBClient::all_query( collname, query_fields, [this, &setfnc]( const std::string& jsondata, const std::string& keydata ) {
+            std::this_thread::sleep_for( std::chrono::milliseconds( delay_ms ) );
+            setfnc( jsondata, keydata );
+        });
+    }
+};
+
+/// Memory driver holding a "connection" of the pool while the request runs, like ArangoDBClient
+class PooledDBClient: public MemoryDBClient
+{
+public:
+
+    SharedPool<int> connections{1};
+    SharedPool<int> cursor_connections{1};
+
+    bool read_record( const std::string& collname, keysmap_t::iterator& it, JsonBase& recdata ) override
+    {
+        auto connection = connections.get();
+        return MemoryDBClient::read_record( collname, it, recdata );
+    }
+
+    void select_query( const std::string& collname, const DBQueryBase& query, SetReaded_f setfnc ) override
+    {
+        auto connection = connections.get();
+        MemoryDBClient::select_query( collname, query, setfnc );
+    }
+
+    void cursor_query( const std::string& collname, const DBQueryBase& query, SetReaded_f setfnc ) override
+    {
+        auto connection = cursor_connections.try_get( std::chrono::milliseconds(50) );
+        JSONIO_THROW_IF( !connection, "PooledDBClient", 1, " no free connection for the cursor" );
+        MemoryDBClient::select_query( collname, query, setfnc );
+    }
+};
+
+} // namespace
+
+TEST( JsonioMemoryDBClient, IndexedQueries )
+{
+    MemoryDBClient client;
+    client.create_collection( "vertex", "vertex" );
+    client.create_collection( "edge", "edge" );
+    client.ensure_index( "vertex", "properties.kind" );
+    EXPECT_EQ( client.get_collections_names( AbstractDBDriver::clEdge ), std::set<std::string>( { "edge" } ) );
+
+    std::string second;
+    for( const auto& jsondata: { "{ \"_key\": \"v1\", \"name\": \"a\", \"properties\": { \"kind\": \"x\" } }",
+                                 "{ \"_key\": \"v2\", \"name\": \"b\", \"properties\": { \"kind\": \"y\" } }",
+                                 "{ \"_key\": \"v3\", \"name\": \"a\", \"properties\": { \"kind\": \"y\" } }" } )
+        client.create_record( "vertex", second, json::loads( jsondata ) );
+    EXPECT_THROW( client.create_record( "vertex", second, json::loads( "{ \"_key\": \"v1\" }" ) ), jsonio_exception );
+    for( const auto& jsondata: { "{ \"_from\": \"vertex/v1\", \"_to\": \"vertex/v2\" }",
+                                 "{ \"_from\": \"vertex/v2\", \"_to\": \"vertex/v3\" }",
+                                 "{ \"_from\": \"vertex/v2\", \"_to\": \"vertex/v2\" }" } )
+        client.create_record( "edge", second, json::loads( jsondata ) );
+    EXPECT_EQ( client.documents_count( "edge" ), 3u );
+
+    EXPECT_EQ( select_ids( client, "vertex", DBQueryBase( "{ \"properties\": { \"kind\": \"y\" }, \"name\": \"a\" }",
+                                                          DBQueryBase::qTemplate ) ),
+               std::set<std::string>( { "vertex/v3" } ) );
+    EXPECT_EQ( select_ids( client, "vertex", DBQueryBase( "FOR u IN vertex FILTER u.properties.kind == 'y' RETURN u",
+                                                          DBQueryBase::qAQL ) ),
+               std::set<std::string>( { "vertex/v2", "vertex/v3" } ) );
+    EXPECT_EQ( select_ids( client, "vertex", DBQueryBase( DBQueryBase::qAll ) ).size(), 3u );
+    EXPECT_EQ( select_ids( client, "vertex", DBQueryBase( "{ \"startVertex\": \"vertex/v2\", \"edgeCollections\": \"edge\" }",
+                                                          DBQueryBase::qEdgesAll ) ).size(), 3u );
+    EXPECT_EQ( select_ids( client, "vertex", DBQueryBase( "{ \"startVertex\": \"vertex/v2\", \"edgeCollections\": \"\" }",
+                                                          DBQueryBase::qEdgesTo ) ).size(), 2u );
+
+    // indexes follow the updated documents
+    keysmap_t keys{ { "vertex/v2", "vertex/v2" } };
+    auto itr = keys.begin();
+    client.update_record( "vertex", itr, json::loads( "{ \"name\": \"b\", \"properties\": { \"kind\": \"x\" } }" ) );
+    EXPECT_EQ( select_ids( client, "vertex", DBQueryBase( "{ \"properties.kind\": \"x\" }", DBQueryBase::qTemplate ) ),
+               std::set<std::string>( { "vertex/v1", "vertex/v2" } ) );
+
+    client.delete_edges( "edge", "vertex/v2" );
+    EXPECT_EQ( client.documents_count( "edge" ), 0u );
+    client.remove_by_ids( "vertex", { "v1", "vertex/v3" } );
+    std::vector<std::string> names;
+    client.fpath_collect( "vertex", "name", names );
+    EXPECT_EQ( names, std::vector<std::string>( { "b" } ) );
+}
+
+TEST( JsonioMemoryDBClient, DataBaseDriver )
+{
+    DataBase db( std::make_shared<MemoryDBClient>() );
+    auto coll = db.collection( "test", "vertex" );
+    for( int ii=0; ii<10; ii++ )
+    {
+        auto data = JsonFree::object();
+        data["name"] = ( ii%2 ? "a" : "b" );
+        data["index"] = ii;
+        coll->createDocument( data );
+    }
+    EXPECT_EQ( coll->documentsCount(), 10u );
+
+    std::vector<std::string> results;
+    coll->selectQuery( DBQueryBase( "{ \"name\" : \"a\" }", DBQueryBase::qTemplate ),
+                       [&results]( const std::string& jsondata ) { results.push_back( jsondata ); } );
+    EXPECT_EQ( results.size(), 5u );
+
+    auto data = json::loads( "{ \"_key\": \"k1\", \"name\": \"c\" }" );
+    auto key = coll->createDocument( data );
+    auto readed = JsonFree::object();
+    EXPECT_TRUE( coll->readDocument( readed, key ) );
+    EXPECT_EQ( readed["name"].toString(), "c" );
+    EXPECT_TRUE( coll->deleteDocument( key ) );
+    EXPECT_FALSE( coll->existsDocument( key ) );
+
+    // bulk remove updates keys of collection
+    std::vector<std::string> keys;
+    coll->allQuery( { "_id" }, [&keys]( const std::string&, const std::string& id ) { keys.push_back( id ); } );
+    ASSERT_EQ( keys.size(), 10u );
+    std::vector<std::string> removed_keys( keys.begin(), keys.begin()+4 );
+    coll->removeByKeys( removed_keys );
+    EXPECT_EQ( coll->documentsCount(), 6u );
+    for( const auto& removed_key: removed_keys )
+        EXPECT_FALSE( coll->existsDocument( removed_key ) );
+    for( auto itkey = keys.begin()+4; itkey != keys.end(); ++itkey )
+        EXPECT_TRUE( coll->existsDocument( *itkey ) );
+}
+
+TEST( JsonioMemoryDBClient, DeleteVertexEdges )
+{
+    ioSettings().addSchemaFormat( schema_thrift, graph_schema_str );
+    DataBase::update_from_schema( ioSettings().Schema().allStructs() );
+
+    auto client = std::make_shared<MemoryDBClient>();
+    DataBase db( client );
+    auto points = db.collection( "points", "vertex" );
+    auto links = db.collection( "links", "edge" );
+    auto follows = db.collection( "follows", "edge" );
+    for( const auto& jsondata: { "{ \"_key\": \"p0\", \"_type\": \"vertex\", \"_label\": \"point\" }",
+                                 "{ \"_key\": \"p1\", \"_type\": \"vertex\", \"_label\": \"point\" }",
+                                 "{ \"_key\": \"p2\", \"_type\": \"vertex\", \"_label\": \"point\" }" } )
+    {
+        auto data = json::loads( jsondata );
+        points->createDocument( data );
+    }
+    for( const auto& jsondata: { "{ \"_key\": \"l01\", \"_from\": \"points/p0\", \"_to\": \"points/p1\" }",
+                                 "{ \"_key\": \"l12\", \"_from\": \"points/p1\", \"_to\": \"points/p2\" }" } )
+    {
+        auto data = json::loads( jsondata );
+        links->createDocument( data );
+    }
+    for( const auto& jsondata: { "{ \"_key\": \"f20\", \"_from\": \"points/p2\", \"_to\": \"points/p0\" }",
+                                 "{ \"_key\": \"f00\", \"_from\": \"points/p0\", \"_to\": \"points/p0\" }",
+                                 "{ \"_key\": \"f21\", \"_from\": \"points/p2\", \"_to\": \"points/p1\" }" } )
+    {
+        auto data = json::loads( jsondata );
+        follows->createDocument( data );
+    }
+
+    {
+        DBVertexDocument vertex( "GraphPoint", db );
+        vertex.deleteDocument( "points/p0" );
+    }
+    DataBase::update_from_schema( {} );
+
+    // edges of the vertex are removed from both edge collections, other edges are kept
+    EXPECT_FALSE( points->existsDocument( "points/p0" ) );
+    EXPECT_EQ( client->documents_count( "points" ), 2u );
+    EXPECT_EQ( client->documents_count( "links" ), 1u );
+    EXPECT_EQ( client->documents_count( "follows" ), 1u );
+    EXPECT_FALSE( links->existsDocument( "links/l01" ) );
+    EXPECT_TRUE( links->existsDocument( "links/l12" ) );
+    EXPECT_FALSE( follows->existsDocument( "follows/f20" ) );
+    EXPECT_FALSE( follows->existsDocument( "follows/f00" ) );
+    EXPECT_TRUE( follows->existsDocument( "follows/f21" ) );
+    EXPECT_EQ( links->documentsCount(), 1u );
+    EXPECT_EQ( follows->documentsCount(), 1u );
+}
+
+TEST( JsonioMemoryDBClient, DocumentAsyncRequests )
+{
+    DataBase db( std::make_shared<MemoryDBClient>() );
+    {
+        DBJsonDocument document( db, "async" );
+        std::vector<std::future<std::string>> created;
+        for( int ii=0; ii<50; ii++ )
+        {
+            // the data is copied when the request is submitted
+            document.setJson( "{ \"index\": " + std::to_string(ii) + " }" );
+            created.push_back( document.createDocumentAsync( "async/k" + std::to_string(ii) ) );
+        }
+        for( int ii=0; ii<50; ii++ )
+            EXPECT_EQ( created[ii].get(), "async/k" + std::to_string(ii) );
+
+        auto readed = document.readDocumentAsync( "async/k7" );
+        document.setJson( "{ \"_key\": \"k8\", \"index\": 100 }" );
+        auto updated = document.updateDocumentAsync( "async/k8" );
+        auto deleted = document.deleteDocumentAsync( "async/k9" );
+        document.setJson( "{ \"_key\": \"k10\", \"index\": 200 }" );
+        EXPECT_EQ( json::loads( readed.get() )["index"].toInt(), 7 );
+        EXPECT_EQ( updated.get(), "async/k8" );
+        EXPECT_NO_THROW( deleted.get() );
+        EXPECT_THROW( document.deleteDocumentAsync( "async/k9" ).get(), jsonio_exception );
+
+        // the destructor waits for the pending request
+        document.setJson( "{ \"index\": 300 }" );
+        document.createDocumentAsync( "async/last" );
+    }
+    auto coll = db.collection( "async", "document" );
+    EXPECT_EQ( coll->documentsCount(), 50u );
+    auto data = JsonFree::object();
+    EXPECT_TRUE( coll->readDocument( data, "async/k8" ) );
+    EXPECT_EQ( data["index"].toInt(), 100 );
+    EXPECT_TRUE( coll->readDocument( data, "async/k10" ) );
+    EXPECT_EQ( data["index"].toInt(), 10 );
+    EXPECT_FALSE( coll->existsDocument( "async/k9" ) );
+    EXPECT_TRUE( coll->existsDocument( "async/last" ) );
+}
+
+TEST( JsonioMemoryDBClient, DocumentsCacheConcurrentUpdate )
+{
+    DataBase db( std::make_shared<MemoryDBClient>() );
+    auto coll = db.collection( "cached", "document" );
+    coll->setDocumentsCache( 16 );
+    auto data = json::loads( "{ \"_key\": \"k1\", \"value\": 0 }" );
+    auto key = coll->createDocument( data );
+
+    std::atomic<bool> stop = false;
+    std::thread reader( [&]() {
+        auto readed = JsonFree::object();
+        while( !stop )
+            coll->readDocument( readed, key );
+    });
+    auto readed = JsonFree::object();
+    for( int ii=1; ii<=300; ii++ )
+    {
+        data["value"] = ii;
+        coll->updateDocument( data );
+        // the old version read concurrently must not be cached after the update
+        EXPECT_TRUE( coll->readDocument( readed, key ) );
+        EXPECT_EQ( readed["value"].toInt(), ii );
+    }
+    stop = true;
+    reader.join();
+    // once the writes stop the cached document is served
+    EXPECT_TRUE( coll->readDocument( readed, key ) );
+    auto hits = coll->cacheStatistics().hits;
+    EXPECT_TRUE( coll->readDocument( readed, key ) );
+    EXPECT_EQ( coll->cacheStatistics().hits, hits+1 );
+    EXPECT_EQ( readed["value"].toInt(), 300 );
+}
+
+TEST( JsonioMemoryDBClient, CollectionLoader )
+{
+    auto client = std::make_shared<SlowKeysDBClient>();
+    client->create_collection( "loaded", "document" );
+    std::string second;
+    for( int ii=0; ii<40; ii++ )
+        client->create_record( "loaded", second, json::loads( "{ \"_key\": \"k" + std::to_string(ii) + "\" }" ) );
+
+    auto batch_size = DBCollection::load_batch_size;
+    DBCollection::load_batch_size = 5;
+    client->delay_ms = 5;
+    DataBase db( client );
+    auto coll = db.collection( "loaded", "document" );
+
+    // the keys are added by batches while loading
+    while( coll->loadedCount() == 0 )
+        std::this_thread::sleep_for( std::chrono::milliseconds(1) );
+    EXPECT_TRUE( coll->isLoading() );
+    EXPECT_EQ( coll->loadedCount() % 5, 0u );
+    coll->waitLoaded();
+    EXPECT_FALSE( coll->isLoading() );
+    EXPECT_EQ( coll->loadedCount(), 40u );
+    EXPECT_EQ( coll->documentsCount(), 40u );
+
+    // the keys loaded before cancel are kept
+    coll->load();
+    while( coll->loadedCount() < 10 )
+        std::this_thread::sleep_for( std::chrono::milliseconds(1) );
+    coll->cancelLoading();
+    EXPECT_FALSE( coll->isLoading() );
+    EXPECT_LT( coll->loadedCount(), 40u );
+    EXPECT_EQ( coll->documentsCount(), coll->loadedCount() );
+
+    // close stops and joins the loader
+    coll->load();
+    EXPECT_TRUE( coll->isLoading() );
+    coll->close();
+    EXPECT_FALSE( coll->isLoading() );
+    EXPECT_EQ( coll->documentsCount(), 0u );
+
+    client->delay_ms = 0;
+    DBCollection::load_batch_size = batch_size;
+}
+
+TEST( JsonioMemoryDBClient, CursorConnection )
+{
+    auto client = std::make_shared<PooledDBClient>();
+    DataBase db( client );
+    auto coll = db.collection( "cursored", "document" );
+    for( int ii=0; ii<20; ii++ )
+    {
+        auto data = json::loads( "{ \"_key\": \"k"+std::to_string(ii)+"\", \"value\": "+std::to_string(ii)+" }" );
+        coll->createDocument( data );
+    }
+
+    auto cursor = coll->selectQueryCursor( DBQueryBase( DBQueryBase::qAll ), 2, 1 );
+    auto batch = cursor->nextBatch();
+    ASSERT_EQ( batch.size(), 2u );
+    // the query waits for the consumer holding the cursor connection,
+    // the requests of the consumer use the other connections
+    auto data = JsonFree::object();
+    EXPECT_TRUE( coll->readDocument( data, "cursored/k5" ) );
+    EXPECT_EQ( data["value"].toInt(), 5 );
+    EXPECT_EQ( client->cursor_connections.statistics().in_use, 1u );
+    EXPECT_EQ( client->connections.statistics().in_use, 0u );
+
+    std::size_t count = batch.size();
+    while( !( batch = cursor->nextBatch() ).empty() )
+        count += batch.size();
+    EXPECT_EQ( count, 20u );
+    EXPECT_EQ( client->cursor_connections.statistics().acquired, 1u );
+
+    // more cursors than connections read by one thread: the extra cursor fails, not waits for ever
+    auto first = coll->selectQueryCursor( DBQueryBase( DBQueryBase::qAll ), 2, 1 );
+    EXPECT_EQ( first->nextBatch().size(), 2u );
+    auto second = coll->selectQueryCursor( DBQueryBase( DBQueryBase::qAll ), 2, 1 );
+    EXPECT_THROW( second->nextBatch(), jsonio_exception );
+    count = 2;
+    while( !( batch = first->nextBatch() ).empty() )
+        count += batch.size();
+    EXPECT_EQ( count, 20u );
+}
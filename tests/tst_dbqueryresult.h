@@ -0,0 +1,345 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include "jsonio/dbdrivermemory.h"
+#include "jsonio/dbconnect.h"
+#include "jsonio/dbcollection.h"
+#include "jsonio/dbjsondoc.h"
+#include "jsonio/jsonfree.h"
+
+using namespace testing;
+using namespace jsonio;
+
+namespace {
+
+void create_result_record( const std::shared_ptr<DBCollection>& coll, const std::string& key, const std::string& name, int value )
+{
+    auto data = json::loads( "{ \"_key\": \""+key+"\", \"name\": \""+name+"\", \"value\": "+std::to_string(value)+" }" );
+    coll->createDocument( data );
+}
+
+void save_result_record( const std::shared_ptr<DBCollection>& coll, const std::string& key, const std::string& name, int value )
+{
+    auto id = coll->name()+"/"+key;
+    auto data = json::loads( "{ \"_id\": \""+id+"\", \"_key\": \""+key+"\", \"name\": \""+name+"\", \"value\": "+std::to_string(value)+" }" );
+    coll->saveDocument( data, id );
+}
+
+/// Wait the query result table is rebuilt by the thread of updateQuery()
+bool wait_result_size( const DBDocumentBase& document, std::size_t size )
+{
+    for( int ii=0; ii<500; ii++ )
+    {
+        if( document.currentQueryResult().size() == size )
+            return true;
+        std::this_thread::sleep_for( std::chrono::milliseconds(2) );
+    }
+    return false;
+}
+
+/// Document counting the executions of the query
+class CountedQueryDocument : public DBJsonDocument
+{
+public:
+    using DBJsonDocument::DBJsonDocument;
+
+    ~CountedQueryDocument()
+    {
+        waitAsyncRequests();
+        stop_query_refresh();
+    }
+
+    std::atomic<int> queries{0};
+
+protected:
+    void update_query() override
+    {
+        ++queries;
+        std::this_thread::sleep_for( std::chrono::milliseconds(20) );
+        DBJsonDocument::update_query();
+    }
+};
+
+std::vector<std::string> keys_by_values( const DBQueryResult& result, const std::vector<std::string>& fieldnames,
+                                         const std::vector<std::string>& fieldvalues )
+{
+    std::vector<std::string> keys;
+    std::vector<values_t> values;
+    result.getKeysValues( keys, values, fieldnames, fieldvalues );
+    return keys;
+}
+
+} // namespace
+
+TEST( JsonioDBQueryResult, AddUpdateDeleteLines )
+{
+    DataBase db( std::make_shared<MemoryDBClient>() );
+    auto coll = db.collection( "results", "document" );
+    create_result_record( coll, "k1", "a", 1 );
+    create_result_record( coll, "k2", "b", 2 );
+
+    DBJsonDocument document( db, "results" );
+    document.setQuery( DBQueryBase( DBQueryBase::qAll ), { "_id", "name", "value" } );
+    ASSERT_TRUE( wait_result_size( document, 2u ) );
+
+    // add_line
+    create_result_record( coll, "k3", "a", 3 );
+    const auto& result = document.currentQueryResult();
+    auto table = result.queryResult();
+    ASSERT_EQ( table.size(), 3u );
+    EXPECT_EQ( table["results/k3"], values_t( { "results/k3", "a", "3" } ) );
+    EXPECT_EQ( result.getFirstKey(), "results/k1" );
+
+    // update_line
+    auto data = JsonFree::object();
+    ASSERT_TRUE( coll->readDocument( data, "results/k2" ) );
+    data["name"] = "c";
+    data["value"] = 20;
+    coll->updateDocument( data );
+    table = result.queryResult();
+    ASSERT_EQ( table.size(), 3u );
+    EXPECT_EQ( table["results/k2"], values_t( { "results/k2", "c", "20" } ) );
+
+    // delete_line
+    coll->deleteDocument( "results/k1" );
+    table = result.queryResult();
+    EXPECT_EQ( table.size(), 2u );
+    EXPECT_EQ( table.count( "results/k1" ), 0u );
+    EXPECT_EQ( result.getFirstKey(), "results/k2" );
+
+    std::vector<std::string> keys;
+    std::vector<values_t> values;
+    EXPECT_EQ( result.getKeysValues( keys, values ), 2u );
+    EXPECT_EQ( keys, std::vector<std::string>( { "results/k2", "results/k3" } ) );
+    EXPECT_EQ( values[1], values_t( { "results/k3", "a", "3" } ) );
+}
+
+TEST( JsonioDBQueryResult, IndexedFields )
+{
+    DataBase db( std::make_shared<MemoryDBClient>() );
+    auto coll = db.collection( "indexed", "document" );
+    for( int ii=0; ii<10; ii++ )
+        create_result_record( coll, "k"+std::to_string(ii), ii%2 ? "odd" : "even", ii%3 );
+
+    DBJsonDocument document( db, "indexed" );
+    document.setQuery( DBQueryBase( DBQueryBase::qAll ), { "_id", "name", "value" } );
+    ASSERT_TRUE( wait_result_size( document, 10u ) );
+    const auto& result = document.currentQueryResult();
+
+    auto scan_odd = keys_by_values( result, { "name" }, { "odd" } );
+    auto scan_odd_zero = keys_by_values( result, { "name", "value" }, { "odd", "0" } );
+    EXPECT_EQ( scan_odd.size(), 5u );
+    EXPECT_EQ( scan_odd_zero, std::vector<std::string>( { "indexed/k3", "indexed/k9" } ) );
+
+    document.setQueryIndexes( { "name", "value" } );
+    EXPECT_EQ( result.indexedFields(), std::set<std::string>( { "name", "value" } ) );
+    // the hash indexes return the same lines sorted by keys as the full scan
+    EXPECT_EQ( keys_by_values( result, { "name" }, { "odd" } ), scan_odd );
+    EXPECT_EQ( keys_by_values( result, { "name", "value" }, { "odd", "0" } ), scan_odd_zero );
+    EXPECT_TRUE( keys_by_values( result, { "name" }, { "none" } ).empty() );
+    EXPECT_TRUE( keys_by_values( result, { "unknown" }, { "odd" } ).empty() );
+
+    // the indexes follow the changes of lines
+    auto data = JsonFree::object();
+    ASSERT_TRUE( coll->readDocument( data, "indexed/k3" ) );
+    data["value"] = 2;
+    coll->updateDocument( data );
+    coll->deleteDocument( "indexed/k9" );
+    create_result_record( coll, "k10", "odd", 0 );
+    EXPECT_EQ( keys_by_values( result, { "name", "value" }, { "odd", "0" } ),
+               std::vector<std::string>( { "indexed/k10" } ) );
+    EXPECT_EQ( keys_by_values( result, { "name", "value" }, { "odd", "2" } ),
+               std::vector<std::string>( { "indexed/k3", "indexed/k5" } ) );
+    EXPECT_EQ( keys_by_values( result, { "name" }, { "odd" } ).size(), 5u );
+
+    auto key_data = json::loads( "{ \"name\": \"odd\", \"value\": 2 }" );
+    EXPECT_EQ( result.getKeyFromValue( key_data ), "indexed/k3" );
+}
+
+TEST( JsonioDBQueryResult, DictionaryAfterDelete )
+{
+    DataBase db( std::make_shared<MemoryDBClient>() );
+    auto coll = db.collection( "dictionary", "document" );
+    for( int ii=0; ii<6; ii++ )
+        create_result_record( coll, "k"+std::to_string(ii), "name"+std::to_string(ii%3), ii );
+
+    DBJsonDocument document( db, "dictionary" );
+    document.setQuery( DBQueryBase( DBQueryBase::qAll ), { "_id", "name", "value" } );
+    ASSERT_TRUE( wait_result_size( document, 6u ) );
+    document.setQueryIndexes( { "name" } );
+    const auto& result = document.currentQueryResult();
+
+    // all lines with the value are deleted, the value is removed from dictionary
+    coll->deleteDocument( "dictionary/k1" );
+    coll->deleteDocument( "dictionary/k4" );
+    EXPECT_EQ( result.size(), 4u );
+    EXPECT_EQ( result.fieldValuesCount( "name" ), 2u );
+    EXPECT_EQ( result.fieldValuesCount( "value" ), 4u );
+    EXPECT_TRUE( keys_by_values( result, { "name" }, { "name1" } ).empty() );
+    EXPECT_TRUE( keys_by_values( result, { "value" }, { "4" } ).empty() );
+
+    // the free lines are reused by new documents
+    create_result_record( coll, "k6", "name1", 4 );
+    create_result_record( coll, "k7", "name7", 7 );
+    auto table = result.queryResult();
+    ASSERT_EQ( table.size(), 6u );
+    EXPECT_EQ( table["dictionary/k6"], values_t( { "dictionary/k6", "name1", "4" } ) );
+    EXPECT_EQ( table["dictionary/k7"], values_t( { "dictionary/k7", "name7", "7" } ) );
+    EXPECT_EQ( table["dictionary/k0"], values_t( { "dictionary/k0", "name0", "0" } ) );
+    EXPECT_EQ( keys_by_values( result, { "name" }, { "name1" } ), std::vector<std::string>( { "dictionary/k6" } ) );
+    EXPECT_EQ( keys_by_values( result, { "value" }, { "4" } ), std::vector<std::string>( { "dictionary/k6" } ) );
+    EXPECT_EQ( keys_by_values( result, { "name" }, { "name2" } ),
+               std::vector<std::string>( { "dictionary/k2", "dictionary/k5" } ) );
+
+    // deleting all lines keeps the table usable
+    for( const auto& key: { "dictionary/k0", "dictionary/k2", "dictionary/k3",
+                            "dictionary/k5", "dictionary/k6", "dictionary/k7" } )
+        coll->deleteDocument( key );
+    EXPECT_EQ( result.size(), 0u );
+    EXPECT_EQ( result.fieldValuesCount( "name" ), 0u );
+    EXPECT_EQ( result.getFirstKey(), "" );
+    EXPECT_TRUE( keys_by_values( result, { "name" }, { "name0" } ).empty() );
+    create_result_record( coll, "k8", "name0", 8 );
+    EXPECT_EQ( keys_by_values( result, { "name" }, { "name0" } ), std::vector<std::string>( { "dictionary/k8" } ) );
+}
+
+TEST( JsonioDBQueryResult, DictionaryAfterUpdate )
+{
+    DataBase db( std::make_shared<MemoryDBClient>() );
+    auto coll = db.collection( "updated", "document" );
+    create_result_record( coll, "k1", "name", 0 );
+    create_result_record( coll, "k2", "name", 0 );
+
+    DBJsonDocument document( db, "updated" );
+    document.setQuery( DBQueryBase( DBQueryBase::qAll ), { "_id", "name", "value" } );
+    ASSERT_TRUE( wait_result_size( document, 2u ) );
+    document.setQueryIndexes( { "value" } );
+    const auto& result = document.currentQueryResult();
+
+    // each update replaces the value, the old values are not kept into dictionary
+    for( int ii=1; ii<100; ii++ )
+        save_result_record( coll, "k1", "name", ii );
+    EXPECT_EQ( result.size(), 2u );
+    EXPECT_EQ( result.fieldValuesCount( "name" ), 1u );
+    EXPECT_EQ( result.fieldValuesCount( "value" ), 2u );
+    EXPECT_EQ( keys_by_values( result, { "value" }, { "99" } ), std::vector<std::string>( { "updated/k1" } ) );
+    EXPECT_EQ( keys_by_values( result, { "value" }, { "0" } ), std::vector<std::string>( { "updated/k2" } ) );
+    EXPECT_TRUE( keys_by_values( result, { "value" }, { "50" } ).empty() );
+
+    // the released code is reused by a new value
+    save_result_record( coll, "k2", "name", 99 );
+    EXPECT_EQ( result.fieldValuesCount( "value" ), 1u );
+    create_result_record( coll, "k3", "other", 7 );
+    EXPECT_EQ( result.fieldValuesCount( "value" ), 2u );
+    EXPECT_EQ( result.queryResult()["updated/k3"], values_t( { "updated/k3", "other", "7" } ) );
+    EXPECT_EQ( keys_by_values( result, { "value" }, { "99" } ),
+               std::vector<std::string>( { "updated/k1", "updated/k2" } ) );
+}
+
+TEST( JsonioDBQueryResult, ConditionLines )
+{
+    DataBase db( std::make_shared<MemoryDBClient>() );
+    auto coll = db.collection( "filtered", "document" );
+    create_result_record( coll, "k1", "a", 1 );
+    create_result_record( coll, "k2", "b", 2 );
+
+    DBJsonDocument document( db, "filtered" );
+    document.setQuery( DBQueryBase( "{ \"name\": \"a\" }", DBQueryBase::qTemplate ), { "_id", "name", "value" } );
+    ASSERT_TRUE( wait_result_size( document, 1u ) );
+    const auto& result = document.currentQueryResult();
+
+    // only the matched documents are added
+    create_result_record( coll, "k3", "a", 3 );
+    create_result_record( coll, "k4", "b", 4 );
+    auto table = result.queryResult();
+    ASSERT_EQ( table.size(), 2u );
+    EXPECT_EQ( table.count( "filtered/k3" ), 1u );
+
+    // the updated document stops matching
+    auto data = JsonFree::object();
+    ASSERT_TRUE( coll->readDocument( data, "filtered/k1" ) );
+    data["name"] = "b";
+    coll->updateDocument( data );
+    // the updated document starts matching
+    ASSERT_TRUE( coll->readDocument( data, "filtered/k2" ) );
+    data["name"] = "a";
+    coll->updateDocument( data );
+    // the matched document is updated
+    ASSERT_TRUE( coll->readDocument( data, "filtered/k3" ) );
+    data["value"] = 30;
+    coll->updateDocument( data );
+    table = result.queryResult();
+    ASSERT_EQ( table.size(), 2u );
+    EXPECT_EQ( table.count( "filtered/k1" ), 0u );
+    EXPECT_EQ( table["filtered/k2"], values_t( { "filtered/k2", "a", "2" } ) );
+    EXPECT_EQ( table["filtered/k3"], values_t( { "filtered/k3", "a", "30" } ) );
+
+    coll->deleteDocument( "filtered/k2" );
+    coll->deleteDocument( "filtered/k4" );
+    EXPECT_EQ( result.size(), 1u );
+    EXPECT_EQ( result.getFirstKey(), "filtered/k3" );
+}
+
+TEST( JsonioDBQueryResult, ConditionExecutedAgain )
+{
+    DataBase db( std::make_shared<MemoryDBClient>() );
+    auto coll = db.collection( "limited", "document" );
+    for( int ii=0; ii<3; ii++ )
+        create_result_record( coll, "k"+std::to_string(ii), "a", ii );
+
+    // LIMIT could not be tested by the changed document, the query is executed again
+    DBJsonDocument document( db, "limited" );
+    document.setQuery( DBQueryBase( "FOR u IN limited FILTER u.value >= 1 LIMIT 10", DBQueryBase::qAQL ),
+                       { "_id", "name", "value" } );
+    ASSERT_TRUE( wait_result_size( document, 2u ) );
+    create_result_record( coll, "k3", "b", 3 );
+    create_result_record( coll, "k4", "b", 4 );
+    ASSERT_TRUE( wait_result_size( document, 4u ) );
+    auto table = document.currentQueryResult().queryResult();
+    EXPECT_EQ( table.count( "limited/k0" ), 0u );
+    EXPECT_EQ( table["limited/k4"], values_t( { "limited/k4", "b", "4" } ) );
+
+    auto data = JsonFree::object();
+    ASSERT_TRUE( coll->readDocument( data, "limited/k1" ) );
+    data["value"] = 0;
+    coll->updateDocument( data );
+    coll->deleteDocument( "limited/k2" );
+    ASSERT_TRUE( wait_result_size( document, 2u ) );
+    table = document.currentQueryResult().queryResult();
+    EXPECT_EQ( table.count( "limited/k1" ), 0u );
+    EXPECT_EQ( table.count( "limited/k3" ), 1u );
+    EXPECT_EQ( table.count( "limited/k4" ), 1u );
+}
+
+TEST( JsonioDBQueryResult, ConditionRefreshCoalesced )
+{
+    DataBase db( std::make_shared<MemoryDBClient>() );
+    auto coll = db.collection( "refreshed", "document" );
+    create_result_record( coll, "k0", "a", 0 );
+    DBQueryBase query( "FOR u IN refreshed FILTER u.value >= 1 LIMIT 100", DBQueryBase::qAQL );
+
+    {
+        CountedQueryDocument document( db, "refreshed" );
+        document.setQuery( query, { "_id", "name", "value" } );
+        ASSERT_TRUE( wait_result_size( document, 0u ) );
+
+        // the changes while the query is running make one more execution
+        for( int ii=1; ii<=30; ii++ )
+            create_result_record( coll, "k"+std::to_string(ii), "a", ii );
+        ASSERT_TRUE( wait_result_size( document, 30u ) );
+        EXPECT_LT( document.queries.load(), 10 );
+    }
+
+    // the destructor waits the refresh started by the last change
+    {
+        CountedQueryDocument document( db, "refreshed" );
+        document.setQuery( query, { "_id", "name", "value" } );
+        create_result_record( coll, "k31", "a", 31 );
+    }
+    create_result_record( coll, "k32", "a", 32 );
+    EXPECT_EQ( coll->documentsCount(), 33u );
+}
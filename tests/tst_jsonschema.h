@@ -2,6 +2,8 @@
 
 #include <gtest/gtest.h>
 
+#include <filesystem>
+#include <fstream>
 #include <list>
 #include <map>
 #include <unordered_map>
@@ -27,6 +29,22 @@ TEST( JsonioSchemaJson, ObjectLoads)
     EXPECT_EQ( obj["values"].dump(true), "[[1,2,3],[11,12,13]]" );
 }
 
+TEST( JsonioSchemaJson, SchemaFile)
+{
+    std::string fpath = "test_schema_file.schema.json";
+    {
+        std::ofstream fout( fpath );
+        fout << schema_str;
+    }
+    // the file is parsed straight from the mapped data
+    SchemasData schema;
+    schema.addSchemaMethod( schema_thrift, ThriftSchemaRead );
+    schema.addSchemaFile( schema_thrift, fpath );
+    ASSERT_NE( schema.getStruct( "SimpleSchemaTest" ), nullptr );
+    EXPECT_NE( schema.getStruct( "ComplexSchemaTest" ), nullptr );
+    EXPECT_EQ( schema.getStruct( "SimpleSchemaTest" )->name(), "SimpleSchemaTest" );
+    std::filesystem::remove( fpath );
+}
 
 TEST( JsonioSchemaJson, ObjectSimple)
 {
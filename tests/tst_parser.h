@@ -6,6 +6,7 @@
 #include "jsonio/service.h"
 #include "jsonio/txt2file.h"
 #include "jsonio/jsondump.h"
+#include "jsonio/jsonparser.h"
 
 using namespace testing;
 using namespace jsonio;
@@ -247,3 +248,33 @@ TEST( JsonioParser, ObjectFree)
 {
     auto json_obj = json::loads( test_free_str );
 }
+
+TEST( JsonioParser, Projection )
+{
+    std::string jsondata = R"({ "_id":"test/1", "a": {"b":[1, {"c":"x\"y"}, 2.50]}, "n":null,
+                                "o":{"z":1}, "skip":[{"a":"]"}], "t":true, "d":1e3 })";
+    std::vector<std::string> paths = { "_id", "a.b.0", "a.b[1].c", "a.b.2", "n", "o", "o.z", "miss", "t", "d" };
+    JsonProjection projection( paths );
+    EXPECT_EQ( projection.size(), paths.size() );
+
+    std::vector<std::string> values;
+    std::vector<JsonProjection::State> states;
+    EXPECT_TRUE( projection.extract( jsondata, values, states ) );
+
+    auto json_free = json::loads( jsondata );
+    std::string value;
+    for( std::size_t ii=0; ii<paths.size(); ++ii )
+    {
+        if( paths[ii] == "miss" )
+            EXPECT_EQ( states[ii], JsonProjection::Missing );
+        else if( paths[ii] == "o" )
+            EXPECT_EQ( states[ii], JsonProjection::Structured );
+        else
+        {
+            EXPECT_EQ( states[ii], JsonProjection::Scalar );
+            json_free.get_value_via_path( paths[ii], value, std::string("") );
+            EXPECT_EQ( values[ii], value );
+        }
+    }
+    EXPECT_FALSE( projection.extract( "{\"_id\":", values, states ) );
+}
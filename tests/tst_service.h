@@ -2,7 +2,12 @@
 
 #include <gtest/gtest.h>
 #include <fstream>
+#include <sstream>
 #include <filesystem>
+#include <thread>
+#include <type_traits>
+#include <spdlog/async.h>
+#include <spdlog/sinks/base_sink.h>
 namespace fs = std::filesystem;
 
 #include "jsonio/service.h"
@@ -307,6 +312,111 @@ TEST( Jsoniofilesystem, TestJsonArrayFileSaveSimple )
 }
 
 
+TEST( Jsoniofilesystem, TestJsonArrayFileStreamWrite )
+{
+    std::string fpath = "test_array_write3.json";
+
+    JsonArrayFile fjson(fpath);
+    fjson.setCheckpoint( 3 );
+    EXPECT_NO_THROW( fjson.Open(TxtFile::WriteOnly) );
+    auto obj = JsonFree::object();
+    for( size_t ii=0; ii<7; ii++)
+    {
+        obj["key"] = ii;
+        EXPECT_TRUE( fjson.saveNext( obj ) );
+    }
+    // the file has the array of elements saved before the last checkpoint
+    EXPECT_EQ( json::loads( read_ascii_file( fpath ) ).size(), 6u );
+    EXPECT_TRUE( fjson.saveNext( std::string("{ \"key\" : \"a b\" }") ) );
+    EXPECT_NO_THROW( fjson.Close() );
+    auto arr = json::loads( fjson.load_json() );
+    EXPECT_EQ( arr.size(), 8u );
+    EXPECT_EQ( arr[7].dump(true), "{\"key\":\"a b\"}" );
+    EXPECT_EQ( fjson.getString(), "" );
+
+    JsonArrayFile fmemory(fpath);
+    fmemory.setStreamWrite( false );
+    EXPECT_NO_THROW( fmemory.Open(TxtFile::WriteOnly) );
+    EXPECT_TRUE( fmemory.saveNext( std::string("1") ) );
+    EXPECT_EQ( json::loads( fmemory.getString() ).dump( true ), "[1]" );
+    EXPECT_NO_THROW( fmemory.Close() );
+    EXPECT_EQ( fmemory.load_json(), "[1]" );
+    fs::remove( fpath );
+}
+
+TEST( Jsoniofilesystem, TestJsonArrayFileRecover )
+{
+    std::string fpath = "test_array_recover.json";
+    std::string copy_path = "test_array_recover_copy.json";
+
+    JsonArrayFile fjson(fpath);
+    EXPECT_NO_THROW( fjson.Open(TxtFile::WriteOnly) );
+    auto obj = JsonFree::object();
+    obj["name"] = std::string( 1000, 'a' );
+    for( size_t ii=0; ii<10; ii++)
+    {
+        obj["key"] = ii;
+        EXPECT_TRUE( fjson.saveNext( obj ) );
+    }
+    fjson.checkpoint();
+    EXPECT_EQ( json::loads( read_ascii_file( fpath ) ).size(), 10u );
+
+    // the buffer of writer is written over the closing bracket of the checkpoint
+    for( size_t ii=10; ii<400; ii++)
+    {
+        obj["key"] = ii;
+        EXPECT_TRUE( fjson.saveNext( obj ) );
+    }
+    fs::copy_file( fpath, copy_path, fs::copy_options::overwrite_existing );
+    EXPECT_GT( fs::file_size( copy_path ), 10*1000u );
+    EXPECT_THROW( json::loads( read_ascii_file( copy_path ) ), jsonio_exception );
+
+    // the interrupted file keeps the elements saved before the last checkpoint
+    JsonArrayFile frecover(copy_path);
+    auto count = frecover.recover();
+    EXPECT_GE( count, 10u );
+    EXPECT_LT( count, 400u );
+    EXPECT_EQ( json::loads( read_ascii_file( copy_path ) ).size(), count );
+    EXPECT_NO_THROW( frecover.Open(TxtFile::ReadOnly) );
+    size_t readed = 0;
+    while( frecover.loadNext( obj ) )
+        EXPECT_EQ( obj["key"].toInt(), static_cast<long>( readed++ ) );
+    EXPECT_NO_THROW( frecover.Close() );
+    EXPECT_EQ( readed, count );
+    // the well-formed file is not changed
+    auto recovered_size = fs::file_size( copy_path );
+    EXPECT_EQ( frecover.recover(), count );
+    EXPECT_EQ( fs::file_size( copy_path ), recovered_size );
+
+    EXPECT_NO_THROW( fjson.Close() );
+    EXPECT_EQ( json::loads( fjson.load_json() ).size(), 400u );
+    fs::remove( fpath );
+    fs::remove( copy_path );
+}
+
+TEST( Jsoniofilesystem, TestJsonArrayFileMove )
+{
+    static_assert( !std::is_copy_constructible_v<JsonArrayFile> );
+    std::string fpath = "test_array_move.json";
+
+    JsonArrayFile fjson(fpath);
+    EXPECT_NO_THROW( fjson.Open(TxtFile::WriteOnly) );
+    EXPECT_TRUE( fjson.saveNext( std::string("1") ) );
+    {
+        // the moved file is closed, its destructor does not finish the array
+        JsonArrayFile fmoved( std::move(fjson) );
+        EXPECT_FALSE( fjson.isOpened() );
+        EXPECT_TRUE( fmoved.isOpened() );
+        EXPECT_TRUE( fmoved.saveNext( std::string("2") ) );
+        JsonArrayFile fassigned(fpath);
+        fassigned = std::move(fmoved);
+        EXPECT_FALSE( fmoved.isOpened() );
+        EXPECT_TRUE( fassigned.saveNext( std::string("3") ) );
+    }
+    EXPECT_EQ( json::loads( read_ascii_file( fpath ) ).dump( true ), "[1,2,3]" );
+    fs::remove( fpath );
+}
+
 TEST( Jsoniofilesystem, TestJsonArrayFileLoad )
 {
     std::string fpath = "test_array_load.json";
@@ -359,6 +469,198 @@ TEST( Jsoniofilesystem, TestJsonArrayFileLoadSimple )
     EXPECT_EQ( fjson.load_json(), fdata );
 }
 
+TEST( Jsoniofilesystem, TestJsonArrayFileLoadLazy )
+{
+    std::string fpath = "test_array_load3.json";
+    std::ofstream stream;
+    stream.open(fpath);
+    stream << "\xef\xbb\xbf[\n";
+    for( size_t ii=0; ii<100; ii++)
+        stream << ( ii ? ",\n" : "" ) << "{ \"key\": " << ii << ", \"value\": [ \"a]\", { \"b\": \"}\" } ] }";
+    stream << "\n]\n";
+    stream.close();
+
+    auto block_size = JsonArrayReader::block_size;
+    JsonArrayReader::block_size = 16;
+    JsonArrayFile fjson(fpath);
+    EXPECT_NO_THROW( fjson.Open(TxtFile::ReadOnly) );
+    auto obj = JsonFree::object();
+    size_t count = 0;
+    while( fjson.loadNext( obj ) )
+    {
+        EXPECT_EQ( obj.toString(true), std::string("{\"key\":")+std::to_string(count)+",\"value\":[\"a]\",{\"b\":\"}\"}]}" );
+        count++;
+    }
+    JsonArrayReader::block_size = block_size;
+    EXPECT_EQ( count, 100u );
+    EXPECT_NO_THROW( fjson.Close() );
+    fs::remove( fpath );
+
+    EXPECT_THROW( fjson.Open(TxtFile::ReadOnly), jsonio_exception );
+}
+
+TEST( Jsoniofilesystem, TestJsonLinesFile )
+{
+    std::string fpath = "test_lines.jsonl";
+
+    JsonLinesFile fjson(fpath);
+    EXPECT_EQ( fjson.type(), TxtFile::JsonLines );
+    EXPECT_NO_THROW( fjson.Open(TxtFile::WriteOnly) );
+    auto obj = JsonFree::object();
+    for( size_t ii=0; ii<500; ii++)
+    {
+        obj["key"] = ii;
+        obj["text"] = "line\n" + std::to_string(ii);
+        EXPECT_TRUE( fjson.saveNext( obj ) );
+    }
+    EXPECT_TRUE( fjson.saveNext( std::string("{\n  \"key\": 500\n}") ) );
+    EXPECT_NO_THROW( fjson.Close() );
+
+    EXPECT_NO_THROW( fjson.Open(TxtFile::ReadOnly) );
+    size_t count = 0;
+    while( fjson.loadNext( obj ) )
+        EXPECT_EQ( obj["key"].toInt(), static_cast<long>( count++ ) );
+    EXPECT_NO_THROW( fjson.Close() );
+    EXPECT_EQ( count, 501u );
+
+    auto chunk_size = JsonLinesFile::chunk_size;
+    JsonLinesFile::chunk_size = 100;
+    std::vector<long> keys;
+    EXPECT_EQ( fjson.loadAll( [&keys]( const JsonFree& record ) { keys.push_back( record["key"].toInt() ); }, true, 4 ), 501u );
+    ASSERT_EQ( keys.size(), 501u );
+    for( size_t ii=0; ii<keys.size(); ii++)
+        EXPECT_EQ( keys[ii], static_cast<long>( ii ) );
+
+    std::set<long> unordered_keys;
+    EXPECT_EQ( fjson.loadAll( [&unordered_keys]( const JsonFree& record ) {
+        unordered_keys.insert( record["key"].toInt() ); }, false, 4 ), 501u );
+    EXPECT_EQ( unordered_keys.size(), 501u );
+    JsonLinesFile::chunk_size = chunk_size;
+    fs::remove( fpath );
+}
+
+TEST( Jsoniofilesystem, TestCompressedFiles )
+{
+    if( !compression_supported( Compression::Gzip ) )
+    {
+        JsonArrayFile fgzip( "test_array.json.gz" );
+        EXPECT_THROW( fgzip.Open(TxtFile::WriteOnly), jsonio_exception );
+        return;
+    }
+
+    std::string fpath = "test_array.json.gz";
+    JsonArrayFile fjson(fpath);
+    EXPECT_EQ( fjson.compression(), Compression::Gzip );
+    fjson.setCheckpoint( 100 );
+    EXPECT_NO_THROW( fjson.Open(TxtFile::WriteOnly) );
+    auto obj = JsonFree::object();
+    for( size_t ii=0; ii<1000; ii++)
+    {
+        obj["key"] = ii;
+        obj["name"] = "compressed record";
+        EXPECT_TRUE( fjson.saveNext( obj ) );
+    }
+    EXPECT_NO_THROW( fjson.Close() );
+    EXPECT_GT( fjson.statistics().ratio(), 2. );
+    EXPECT_EQ( fjson.statistics().file_bytes, fs::file_size( fpath ) );
+
+    EXPECT_NO_THROW( fjson.Open(TxtFile::ReadOnly) );
+    size_t count = 0;
+    while( fjson.loadNext( obj ) )
+        EXPECT_EQ( obj["key"].toInt(), static_cast<long>( count++ ) );
+    EXPECT_NO_THROW( fjson.Close() );
+    EXPECT_EQ( count, 1000u );
+    EXPECT_EQ( json::loads( fjson.load_all() ).size(), 1000u );
+    fs::remove( fpath );
+
+    JsonFile fobject( "test_object.json.gz" );
+    fobject.save( obj );
+    EXPECT_EQ( fobject.load_json(), obj.dump( true ) );
+    fs::remove( fobject.path() );
+
+    // appended data is the next gzip member
+    JsonLinesFile flines( "test_lines.jsonl.gz" );
+    for( auto mode: { TxtFile::WriteOnly, TxtFile::Append } )
+    {
+        EXPECT_NO_THROW( flines.Open( mode ) );
+        for( size_t ii=0; ii<100; ii++)
+        {
+            obj["key"] = ii;
+            EXPECT_TRUE( flines.saveNext( obj ) );
+        }
+        EXPECT_NO_THROW( flines.Close() );
+    }
+    auto chunk_size = JsonLinesFile::chunk_size;
+    JsonLinesFile::chunk_size = 1000;
+    count = 0;
+    EXPECT_EQ( flines.loadAll( [&count]( const JsonFree& record ) {
+        EXPECT_EQ( record["key"].toInt(), static_cast<long>( count++%100 ) ); }, true, 3 ), 200u );
+    JsonLinesFile::chunk_size = chunk_size;
+    fs::remove( flines.path() );
+}
+
+TEST( Jsoniofilesystem, TestMappedFile )
+{
+    std::string fpath = "test_mapped.json";
+    std::ofstream stream;
+    stream.open(fpath);
+    stream << "\xef\xbb\xbf{ \"key\": [ 1, 2, 3 ] }";
+    stream.close();
+
+    {
+        MappedFile file( fpath );
+        EXPECT_TRUE( file.isMapped() );
+        EXPECT_EQ( file.view(), "{ \"key\": [ 1, 2, 3 ] }" );
+    }
+    MappedFile::use_mmap = false;
+    {
+        MappedFile file( fpath );
+        EXPECT_FALSE( file.isMapped() );
+        EXPECT_EQ( file.view(), "{ \"key\": [ 1, 2, 3 ] }" );
+    }
+    MappedFile::use_mmap = true;
+
+    JsonFile fjson( fpath );
+    EXPECT_EQ( fjson.load_json(), "{\"key\":[1,2,3]}" );
+    EXPECT_EQ( read_ascii_file( fpath ), "{ \"key\": [ 1, 2, 3 ] }" );
+
+    stream.open(fpath);
+    stream.close();
+    MappedFile empty_file( fpath );
+    EXPECT_TRUE( empty_file.view().empty() );
+    fs::remove( fpath );
+    EXPECT_THROW( MappedFile( "test_not_exist.json" ), jsonio_exception );
+}
+
+TEST( Jsoniofilesystem, TestJsonArrayReader )
+{
+    std::string fdata = " [ {\"key\":\"a,]}\\\"\"}, [1,[2]] ,\n3,\"s\" ] ";
+    auto block_size = JsonArrayReader::block_size;
+    // elements are split between blocks
+    JsonArrayReader::block_size = 3;
+    std::istringstream stream( fdata );
+    JsonArrayReader reader( stream );
+    std::vector<std::string> elements;
+    std::string element;
+    while( reader.next( element ) )
+        elements.push_back( element );
+    JsonArrayReader::block_size = block_size;
+    EXPECT_EQ( elements, std::vector<std::string>( { "{\"key\":\"a,]}\\\"\"}", "[1,[2]]", "3", "\"s\"" } ) );
+    EXPECT_EQ( reader.bytesRead(), fdata.size() );
+
+    std::istringstream empty_stream( "[]" );
+    JsonArrayReader empty_reader( empty_stream );
+    EXPECT_FALSE( empty_reader.next( element ) );
+
+    std::istringstream bad_stream( "{ \"key\": 1 }" );
+    JsonArrayReader bad_reader( bad_stream );
+    EXPECT_THROW( bad_reader.next( element ), jsonio_exception );
+    std::istringstream open_stream( "[1, {" );
+    JsonArrayReader open_reader( open_stream );
+    EXPECT_TRUE( open_reader.next( element ) );
+    EXPECT_THROW( open_reader.next( element ), jsonio_exception );
+}
+
 
 //---------------------------------------------------------------------
 
@@ -444,3 +746,191 @@ TEST( JsonioSettings, TestSettingsPath )
     if(path_exist( fpath ) )
         fs::remove_all(fpath);
 }
+
+TEST( JsonioSettings, TestSettingsSnapshot )
+{
+    std::string fpath = "test4.cfg.json";
+    if(path_exist( fpath ) )
+        fs::remove_all(fpath);
+
+    JsonioSettings  tst_settings( fpath );
+    auto first = tst_settings.snapshot();
+    EXPECT_FALSE( first->async_threads.has_value() );
+    EXPECT_FALSE( first->documents_cache_validate );
+    EXPECT_EQ( tst_settings.snapshot(), first );
+
+    tst_settings.setValue("jsonio.AsyncThreads", 3 );
+    tst_settings.section("jsonio").setValue("DocumentsCacheValidate", true );
+    auto second = tst_settings.snapshot();
+    EXPECT_NE( second, first );
+    EXPECT_EQ( second->async_threads.value_or(0), 3u );
+    EXPECT_TRUE( second->documents_cache_validate );
+    EXPECT_EQ( second->settings_json, tst_settings.dump() );
+    // the old snapshot is not changed
+    EXPECT_FALSE( first->async_threads.has_value() );
+    EXPECT_EQ( tst_settings.snapshot(), second );
+
+    if(path_exist( fpath ) )
+        fs::remove_all(fpath);
+}
+
+TEST( JsonioSettings, TestSettingsConcurrentAccess )
+{
+    std::string fpath = "test7.cfg.json";
+    if(path_exist( fpath ) )
+        fs::remove_all(fpath);
+
+    JsonioSettings  tst_settings( fpath );
+    tst_settings.setSyncDelay( std::chrono::milliseconds(10000) );
+    std::thread writer( [&tst_settings]()
+    {
+        for( int ii=1; ii<=200; ii++ )
+            tst_settings.setValue("jsonio.AsyncThreads", ii );
+    });
+    // values of snapshot are read from the same settings as its json
+    for( int ii=0; ii<200; ii++ )
+    {
+        auto data = tst_settings.snapshot();
+        std::size_t threads = 0;
+        json::loads( data->settings_json ).get_value_via_path<std::size_t>( "jsonio.AsyncThreads", threads, 0 );
+        EXPECT_EQ( data->async_threads.value_or(0), threads );
+        EXPECT_LE( tst_settings.value<std::size_t>( "jsonio.AsyncThreads", 0 ), 200u );
+        EXPECT_FALSE( tst_settings.section("jsonio").dump().empty() );
+    }
+    writer.join();
+    EXPECT_EQ( tst_settings.snapshot()->async_threads.value_or(0), 200u );
+    tst_settings.setSyncDelay( std::chrono::milliseconds(0) );
+
+    if(path_exist( fpath ) )
+        fs::remove_all(fpath);
+}
+
+TEST( JsonioSettings, TestSettingsBatchUpdate )
+{
+    std::string fpath = "test5.cfg.json";
+    if(path_exist( fpath ) )
+        fs::remove_all(fpath);
+
+    JsonioSettings  tst_settings( fpath );
+    JsonFile ftxt(fpath);
+    auto saved = ftxt.load_json();
+    {
+        SettingsUpdate update( tst_settings );
+        tst_settings.setValue("common.test.UseInt", 1 );
+        {
+            SettingsUpdate nested( tst_settings );
+            tst_settings.setValue("common.test.UseBool", true );
+        }
+        tst_settings.setValue("common.test.UseDouble", 2.5 );
+        EXPECT_TRUE( tst_settings.hasPendingChanges() );
+        EXPECT_EQ( ftxt.load_json(), saved );
+    }
+    EXPECT_FALSE( tst_settings.hasPendingChanges() );
+    EXPECT_FALSE( path_exist( ".~"+fpath ) );
+    EXPECT_EQ( ftxt.load_json(), tst_settings.dump() );
+
+    tst_settings.setSyncDelay( std::chrono::milliseconds(20) );
+    for( int ii=0; ii<10; ii++ )
+        tst_settings.setValue("common.test.UseInt", ii );
+    EXPECT_TRUE( tst_settings.hasPendingChanges() );
+    for( int ii=0; ii<500 && tst_settings.hasPendingChanges(); ii++ )
+        std::this_thread::sleep_for( std::chrono::milliseconds(10) );
+    EXPECT_FALSE( tst_settings.hasPendingChanges() );
+    EXPECT_EQ( ftxt.load_json(), tst_settings.dump() );
+
+    // pending changes are written when the delay is switched off
+    tst_settings.setSyncDelay( std::chrono::milliseconds(10000) );
+    tst_settings.setValue("common.test.UseInt", 20 );
+    tst_settings.setSyncDelay( std::chrono::milliseconds(0) );
+    EXPECT_FALSE( tst_settings.hasPendingChanges() );
+    EXPECT_EQ( ftxt.load_json(), tst_settings.dump() );
+
+    if(path_exist( fpath ) )
+        fs::remove_all(fpath);
+}
+
+namespace {
+
+/// Sink saving the threads writing messages
+class ThreadsSink : public spdlog::sinks::base_sink<std::mutex>
+{
+public:
+    std::vector<std::thread::id> threads_ids()
+    {
+        std::lock_guard<std::mutex> lock( mutex_ );
+        return threads;
+    }
+
+protected:
+    std::vector<std::thread::id> threads;
+
+    void sink_it_( const spdlog::details::log_msg& ) override
+    {
+        threads.push_back( std::this_thread::get_id() );
+    }
+    void flush_() override {}
+};
+
+std::vector<std::thread::id> wait_messages( ThreadsSink& sink, std::size_t count )
+{
+    for( int ii=0; ii<500 && sink.threads_ids().size() < count; ii++ )
+        std::this_thread::sleep_for( std::chrono::milliseconds(2) );
+    return sink.threads_ids();
+}
+
+} // namespace
+
+TEST( JsonioSettings, TestAsyncLogging )
+{
+    std::string fpath = "test6.cfg.json";
+    if(path_exist( fpath ) )
+        fs::remove_all(fpath);
+
+    JsonioSettings  tst_settings( fpath );
+    auto threads_sink = std::make_shared<ThreadsSink>();
+    auto module_logger = std::make_shared<spdlog::logger>( "test-async-module", threads_sink );
+    spdlog::register_logger( module_logger );
+    auto sync_logger = io_logger;
+    EXPECT_EQ( tst_settings.get_logger("test-async-module"), module_logger );
+
+    // loggers are not replaced, their messages are written by the logging threads
+    tst_settings.set_async_logging( true, 256, 1 );
+    EXPECT_TRUE( tst_settings.contains("log.async.enabled") );
+    EXPECT_EQ( io_logger, sync_logger );
+    EXPECT_EQ( spdlog::get("jsonio"), io_logger );
+    EXPECT_EQ( tst_settings.get_logger("test-async-module"), module_logger );
+    io_logger->debug("async logger message");
+    module_logger->info("async module message");
+    auto threads = wait_messages( *threads_sink, 1 );
+    ASSERT_EQ( threads.size(), 1u );
+    EXPECT_NE( threads[0], std::this_thread::get_id() );
+
+    // the level and pattern are changed for loggers got before
+    tst_settings.set_levels( "warn" );
+    EXPECT_EQ( module_logger->level(), spdlog::level::warn );
+    EXPECT_EQ( io_logger->level(), spdlog::level::warn );
+    tst_settings.set_levels( "info" );
+
+    tst_settings.set_async_logging( false );
+    EXPECT_EQ( io_logger, sync_logger );
+    module_logger->info("sync module message");
+    threads = wait_messages( *threads_sink, 2 );
+    ASSERT_EQ( threads.size(), 2u );
+    EXPECT_EQ( threads[1], std::this_thread::get_id() );
+    spdlog::drop( "test-async-module" );
+
+    if(path_exist( fpath ) )
+        fs::remove_all(fpath);
+}
+
+//  Convert array indexes into field path to brackets
+TEST( JsonioService, bracketsFieldPath )
+{
+    EXPECT_EQ( brackets_field_path( "a.b.c" ), "a.b.c" );
+    EXPECT_EQ( brackets_field_path( "a.0.b" ), "a[0].b" );
+    EXPECT_EQ( brackets_field_path( "a.12.3" ), "a[12][3]" );
+    EXPECT_EQ( brackets_field_path( "a.1b.c" ), "a.1b.c" );
+    // the compiled regex is reused
+    EXPECT_EQ( regexp_replace( "a.0.b", "\\.([0-9])", "[$1]" ), "a[0].b" );
+    EXPECT_EQ( regexp_replace( "c.5", "\\.([0-9])", "[$1]" ), "c[5]" );
+}
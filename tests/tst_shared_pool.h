@@ -0,0 +1,139 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+
+#include "jsonio/shared_pool.h"
+#include "jsonio/thread_pool.h"
+
+using namespace testing;
+using namespace jsonio;
+
+TEST( JsonioSharedPool, ReuseItems )
+{
+    int created = 0;
+    SharedPool<int> pool( 2, [&created]() { return std::make_unique<int>(created++); } );
+
+    EXPECT_TRUE( pool.empty() );
+    EXPECT_EQ( pool.max_size(), 2u );
+    {
+        auto item1 = pool.get();
+        auto item2 = pool.get();
+        EXPECT_EQ( *item1, 0 );
+        EXPECT_EQ( *item2, 1 );
+        EXPECT_EQ( pool.statistics().in_use, 2u );
+    }
+    EXPECT_EQ( pool.size(), 2u );
+    {
+        auto item = pool.get();
+        EXPECT_EQ( pool.size(), 1u );
+    }
+    auto stat = pool.statistics();
+    EXPECT_EQ( created, 2 );
+    EXPECT_EQ( stat.created, 2u );
+    EXPECT_EQ( stat.acquired, 3u );
+    EXPECT_EQ( stat.in_use, 0u );
+    EXPECT_EQ( stat.waited, 0u );
+}
+
+TEST( JsonioSharedPool, WaitFreeItem )
+{
+    SharedPool<int> pool( 1 );
+    pool.reserve( 3 );
+    EXPECT_EQ( pool.size(), 1u );
+
+    auto item = pool.get();
+    std::thread th( [&pool]() {
+        auto other = pool.get();
+        *other = 10;
+    });
+    std::this_thread::sleep_for( std::chrono::milliseconds(20) );
+    *item = 5;
+    item.reset();
+    th.join();
+
+    auto stat = pool.statistics();
+    EXPECT_EQ( *pool.get(), 10 );
+    EXPECT_EQ( stat.created, 1u );
+    EXPECT_EQ( stat.waited, 1u );
+    EXPECT_GT( stat.max_wait.count(), 0 );
+    EXPECT_EQ( stat.total_wait, stat.max_wait );
+
+    pool.reset_statistics();
+    EXPECT_EQ( pool.statistics().waited, 0u );
+}
+
+TEST( JsonioSharedPool, WaitTimeout )
+{
+    SharedPool<int> pool( 1 );
+    auto item = pool.try_get( std::chrono::milliseconds(10) );
+    ASSERT_NE( item, nullptr );
+    EXPECT_EQ( pool.try_get( std::chrono::milliseconds(10) ), nullptr );
+    EXPECT_EQ( pool.statistics().acquired, 1u );
+    EXPECT_EQ( pool.statistics().in_use, 1u );
+
+    std::thread th( [&item]() {
+        std::this_thread::sleep_for( std::chrono::milliseconds(20) );
+        item.reset();
+    });
+    EXPECT_NE( pool.try_get( std::chrono::seconds(10) ), nullptr );
+    th.join();
+}
+
+TEST( JsonioSharedPool, FactoryError )
+{
+    bool fail = true;
+    SharedPool<int> pool( 1, [&fail]() {
+        if( fail )
+            throw std::runtime_error("no connection");
+        return std::make_unique<int>(1);
+    });
+
+    EXPECT_THROW( pool.get(), std::runtime_error );
+    EXPECT_EQ( pool.statistics().created, 0u );
+    fail = false;
+    EXPECT_EQ( *pool.get(), 1 );
+}
+
+TEST( JsonioThreadPool, SubmitTasks )
+{
+    ThreadPool executor( 3, 2 );
+    EXPECT_EQ( executor.size(), 3u );
+
+    std::atomic<int> counter = 0;
+    std::vector<std::future<int>> results;
+    for( int ii=0; ii<20; ++ii )
+        results.push_back( executor.submit( [&counter, ii]() {
+            counter++;
+            return ii*ii;
+        }));
+
+    for( int ii=0; ii<20; ++ii )
+        EXPECT_EQ( results[ii].get(), ii*ii );
+    executor.wait_all();
+    EXPECT_EQ( counter, 20 );
+    EXPECT_EQ( executor.pending(), 0u );
+}
+
+TEST( JsonioThreadPool, TaskException )
+{
+    ThreadPool executor( 1 );
+    auto result = executor.submit( []() -> std::string {
+        throw std::runtime_error("request error");
+    });
+    EXPECT_THROW( result.get(), std::runtime_error );
+    EXPECT_EQ( executor.submit( [](){ return std::string("next"); } ).get(), "next" );
+}
+
+TEST( JsonioThreadPool, SubmitFromWorker )
+{
+    ThreadPool executor( 1, 1 );
+    auto outer = executor.submit( [&executor]() {
+        // the queue is full after the first inner task, the second one is executed into the worker
+        auto inner1 = executor.submit( [](){ return 1; } );
+        auto inner2 = executor.submit( [](){ return 2; } );
+        return inner2.get();
+    });
+    EXPECT_EQ( outer.get(), 2 );
+}
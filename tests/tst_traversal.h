@@ -0,0 +1,349 @@
+#pragma once
+
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+
+#include "jsonio/traversal.h"
+#include "jsonio/dbdrivermemory.h"
+#include "jsonio/dbconnect.h"
+#include "jsonio/io_settings.h"
+#include "jsonio/schema_thrift.h"
+#include "example_schema.h"
+
+using namespace testing;
+using namespace jsonio;
+
+namespace {
+
+/// Graph  v0 -> v1 -> v2 -> v3,  v1 -> v4,  v5 -> v0
+std::shared_ptr<MemoryDBClient> traversal_graph()
+{
+    auto client = std::make_shared<MemoryDBClient>();
+    client->create_collection( "vertex", "vertex" );
+    client->create_collection( "edge", "edge" );
+    std::string second;
+    for( int ii=0; ii<6; ii++ )
+        client->create_record( "vertex", second, json::loads( "{ \"_key\": \"v" + std::to_string(ii) + "\" }" ) );
+    for( const auto& link: std::vector<std::pair<int,int>>{ {0,1}, {1,2}, {2,3}, {1,4}, {5,0} } )
+        client->create_record( "edge", second, json::loads( "{ \"_key\": \"e" + std::to_string(link.first) +
+                                                            std::to_string(link.second) + "\", \"_from\": \"vertex/v" +
+                                                            std::to_string(link.first) + "\", \"_to\": \"vertex/v" +
+                                                            std::to_string(link.second) + "\" }" ) );
+    return client;
+}
+
+/// Memory driver running the function after the first all_query ( changes done while a snapshot is read )
+class ChangingDBClient: public MemoryDBClient
+{
+public:
+    std::function<void()> after_read;
+
+    void all_query( const std::string& collname, const std::set<std::string>& query_fields, SetReadedKey_f setfnc ) override
+    {
+        MemoryDBClient::all_query( collname, query_fields, setfnc );
+        if( after_read )
+        {
+            auto changes = std::move( after_read );
+            after_read = nullptr;
+            changes();
+        }
+    }
+};
+
+struct TraversalResult
+{
+    std::vector<std::string> vertexes;
+    std::set<std::string> edges;
+};
+
+TraversalResult run_traversal( const DataBase& db, bool from_vertex, const std::vector<std::string>& ids,
+                               int trav_type, int max_depth )
+{
+    TraversalResult result;
+    GraphTraversal traversal( db );
+    traversal.Traversal( from_vertex, ids, [&result]( bool is_vertex, const std::string& data )
+    {
+        auto id = extract_string_json( "_id", data );
+        if( is_vertex )
+            result.vertexes.push_back( id );
+        else
+            result.edges.insert( id );
+    }, trav_type, max_depth );
+    return result;
+}
+
+} // namespace
+
+TEST( JsonioGraphTraversal, Levels )
+{
+    DataBase db( traversal_graph() );
+
+    auto result = run_traversal( db, true, { "vertex/v1" }, GraphTraversal::trOut, -1 );
+    ASSERT_EQ( result.vertexes.size(), 4u );
+    EXPECT_EQ( result.vertexes[0], "vertex/v1" );
+    EXPECT_EQ( std::set<std::string>( result.vertexes.begin()+1, result.vertexes.begin()+3 ),
+               std::set<std::string>( { "vertex/v2", "vertex/v4" } ) );
+    EXPECT_EQ( result.vertexes[3], "vertex/v3" );
+    EXPECT_EQ( result.edges, std::set<std::string>( { "edge/e12", "edge/e14", "edge/e23" } ) );
+
+    result = run_traversal( db, true, { "vertex/v1" }, GraphTraversal::trIn, -1 );
+    EXPECT_EQ( result.vertexes, std::vector<std::string>( { "vertex/v1", "vertex/v0", "vertex/v5" } ) );
+
+    result = run_traversal( db, true, { "vertex/v1" }, GraphTraversal::trAll, -1 );
+    EXPECT_EQ( result.vertexes.size(), 6u );
+    EXPECT_EQ( result.edges.size(), 5u );
+}
+
+TEST( JsonioGraphTraversal, DepthAndEdgesStart )
+{
+    DataBase db( traversal_graph() );
+
+    auto result = run_traversal( db, true, { "vertex/v1" }, GraphTraversal::trAll, 1 );
+    EXPECT_EQ( std::set<std::string>( result.vertexes.begin(), result.vertexes.end() ),
+               std::set<std::string>( { "vertex/v0", "vertex/v1", "vertex/v2", "vertex/v4" } ) );
+    EXPECT_EQ( result.edges, std::set<std::string>( { "edge/e01", "edge/e12", "edge/e14" } ) );
+
+    result = run_traversal( db, true, { "vertex/v1", "vertex/v3" }, GraphTraversal::trAll, 0 );
+    EXPECT_EQ( result.vertexes, std::vector<std::string>( { "vertex/v1", "vertex/v3" } ) );
+    EXPECT_TRUE( result.edges.empty() );
+
+    result = run_traversal( db, false, { "edge/e23" }, GraphTraversal::trOut, -1 );
+    EXPECT_EQ( result.vertexes, std::vector<std::string>( { "vertex/v3" } ) );
+    EXPECT_EQ( result.edges, std::set<std::string>( { "edge/e23" } ) );
+}
+
+TEST( JsonioGraphTraversal, SchemaDocuments )
+{
+    ioSettings().addSchemaFormat( schema_thrift, graph_schema_str );
+    DataBase::update_from_schema( ioSettings().Schema().allStructs() );
+
+    auto client = std::make_shared<MemoryDBClient>();
+    client->create_collection( "points", "vertex" );
+    client->create_collection( "links", "edge" );
+    client->create_collection( "vertex", "vertex" );
+    std::string second;
+    client->create_record( "points", second, json::loads(
+                               "{ \"_key\": \"p0\", \"_type\": \"vertex\", \"_label\": \"point\", \"name\": \"p0\", \"weight\": 2 }" ) );
+    client->create_record( "points", second, json::loads(
+                               "{ \"_key\": \"p1\", \"_type\": \"vertex\", \"_label\": \"point\", \"name\": \"p1\" }" ) );
+    client->create_record( "vertex", second, json::loads(
+                               "{ \"_key\": \"u2\", \"_type\": \"vertex\", \"_label\": \"unknown\", \"other\": 5 }" ) );
+    client->create_record( "links", second, json::loads(
+                               "{ \"_key\": \"l01\", \"_type\": \"edge\", \"_label\": \"links\", "
+                               "\"_from\": \"points/p0\", \"_to\": \"points/p1\" }" ) );
+    client->create_record( "links", second, json::loads(
+                               "{ \"_key\": \"l12\", \"_type\": \"edge\", \"_label\": \"links\", "
+                               "\"_from\": \"points/p1\", \"_to\": \"vertex/u2\", \"length\": 7 }" ) );
+
+    DataBase db( client );
+    std::map<std::string, JsonFree> documents;
+    GraphTraversal traversal( db );
+    traversal.traversal( true, "points/p0", [&documents]( bool, const std::string& data )
+    {
+        documents.emplace( extract_string_json( "_id", data ), json::loads( data ) );
+    }, GraphTraversal::trOut );
+    DataBase::update_from_schema( {} );
+
+    ASSERT_EQ( documents.size(), 5u );
+    // documents are normalized by schemas: default values of not defined fields are added
+    EXPECT_EQ( documents.at( "points/p0" )["weight"].toDouble(), 2. );
+    EXPECT_EQ( documents.at( "points/p1" )["weight"].toDouble(), 1.5 );
+    EXPECT_EQ( documents.at( "links/l01" )["length"].toInt(), 3 );
+    EXPECT_EQ( documents.at( "links/l12" )["length"].toInt(), 7 );
+    // documents without loaded schema are passed as read
+    EXPECT_EQ( documents.at( "vertex/u2" )["other"].toInt(), 5 );
+    EXPECT_FALSE( documents.at( "vertex/u2" ).path_if_exists( "weight" ) );
+}
+
+TEST( JsonioGraphTraversal, Snapshot )
+{
+    DataBase db( traversal_graph() );
+    auto snapshot = std::make_shared<GraphSnapshot>( db );
+    EXPECT_EQ( snapshot->verticesCount(), 6u );
+    EXPECT_EQ( snapshot->edgesCount(), 5u );
+    auto neighbors = snapshot->neighbors( "vertex/v1", GraphTraversal::trOut );
+    EXPECT_EQ( std::set<std::string>( neighbors.begin(), neighbors.end() ),
+               std::set<std::string>( { "vertex/v2", "vertex/v4" } ) );
+    EXPECT_EQ( snapshot->edges( "vertex/v1", GraphTraversal::trIn ), std::vector<std::string>( { "edge/e01" } ) );
+
+    std::map<std::string, int> depths;
+    snapshot->traverse( { "vertex/v0" }, GraphTraversal::trOut, 2, [&depths]( const std::string& id, int depth ) {
+        depths[id] = depth;
+    });
+    EXPECT_EQ( depths, ( std::map<std::string, int>( { { "vertex/v0", 0 }, { "vertex/v1", 1 },
+                                                       { "vertex/v2", 2 }, { "vertex/v4", 2 } } ) ) );
+
+    // the snapshot follows changes of edges done through collections
+    auto edges = db.collection( "edge", "edge" );
+    auto data = json::loads( "{ \"_key\": \"e43\", \"_from\": \"vertex/v4\", \"_to\": \"vertex/v3\" }" );
+    edges->createDocument( data );
+    EXPECT_TRUE( edges->deleteDocument( "edge/e23" ) );
+    EXPECT_EQ( snapshot->edgesCount(), 5u );
+    EXPECT_TRUE( snapshot->containsEdge( "edge/e43" ) );
+    EXPECT_EQ( snapshot->neighbors( "vertex/v3", GraphTraversal::trIn ), std::vector<std::string>( { "vertex/v4" } ) );
+
+    GraphTraversal traversal( db );
+    traversal.setSnapshot( snapshot );
+    std::set<std::string> edges_ids;
+    traversal.traversal( true, "vertex/v1", [&edges_ids]( bool is_vertex, const std::string& data ) {
+        if( !is_vertex )
+            edges_ids.insert( extract_string_json( "_id", data ) );
+    }, GraphTraversal::trOut );
+    EXPECT_EQ( edges_ids, std::set<std::string>( { "edge/e12", "edge/e14", "edge/e43" } ) );
+
+    edges->removeByKeys( { "edge/e43", "edge/e14" } );
+    EXPECT_EQ( snapshot->edges( "vertex/v4", GraphTraversal::trAll ), std::vector<std::string>() );
+}
+
+TEST( JsonioGraphTraversal, SnapshotChangesWhileRead )
+{
+    auto client = std::make_shared<ChangingDBClient>();
+    auto graph = traversal_graph();
+    client->create_collection( "vertex", "vertex" );
+    client->create_collection( "edge", "edge" );
+    std::string second;
+    graph->all_query( "edge", {}, [&]( const std::string& jsondata, const std::string& )
+    {
+        client->create_record( "edge", second, json::loads( jsondata ) );
+    });
+    DataBase db( client );
+
+    // edges changed after the snapshot read the collection, before it was built
+    client->after_read = [&db]()
+    {
+        auto edges = db.collection( "edge", "edge" );
+        auto data = json::loads( "{ \"_key\": \"e43\", \"_from\": \"vertex/v4\", \"_to\": \"vertex/v3\" }" );
+        edges->createDocument( data );
+        EXPECT_TRUE( edges->deleteDocument( "edge/e23" ) );
+    };
+    GraphSnapshot snapshot( db, { "edge" } );
+    EXPECT_FALSE( client->after_read );
+    EXPECT_EQ( snapshot.edgesCount(), 5u );
+    EXPECT_TRUE( snapshot.containsEdge( "edge/e43" ) );
+    EXPECT_FALSE( snapshot.containsEdge( "edge/e23" ) );
+    EXPECT_EQ( snapshot.neighbors( "vertex/v3", GraphTraversal::trIn ), std::vector<std::string>( { "vertex/v4" } ) );
+
+    client->after_read = [&db]()
+    {
+        EXPECT_TRUE( db.collection( "edge", "edge" )->deleteDocument( "edge/e43" ) );
+    };
+    snapshot.rebuild();
+    EXPECT_EQ( snapshot.edgesCount(), 4u );
+    EXPECT_FALSE( snapshot.containsEdge( "edge/e43" ) );
+    EXPECT_TRUE( snapshot.edges( "vertex/v3", GraphTraversal::trIn ).empty() );
+}
+
+TEST( JsonioGraphTraversal, RestoreFromFile )
+{
+    auto file_path = ( std::filesystem::temp_directory_path() / "jsonio_test_graph.json" ).string();
+    std::ofstream stream( file_path );
+    stream << "[\n";
+    for( int ii=0; ii<25; ii++ )
+        stream << "{ \"_id\": \"vertex/v" << ii << "\", \"_type\": \"vertex\", \"_label\": \"unknown\", \"name\": \"[v]\" },\n";
+    for( int ii=1; ii<25; ii++ )
+        stream << "{ \"_id\": \"edge/e" << ii << "\", \"_type\": \"edge\", \"_label\": \"unknown\", "
+               << "\"_from\": \"vertex/v" << ii-1 << "\", \"_to\": \"vertex/v" << ii << "\" },\n";
+    stream << "{ \"_id\": \"other/o1\" }\n]";
+    stream.close();
+
+    auto client = std::make_shared<MemoryDBClient>();
+    DataBase db( client );
+    auto batch_size = GraphTraversal::batch_size;
+    GraphTraversal::batch_size = 4;
+    GraphTraversal traversal( db );
+    traversal.restoreGraphFromFile( file_path );
+    GraphTraversal::batch_size = batch_size;
+    std::filesystem::remove( file_path );
+
+    EXPECT_EQ( client->documents_count( "vertex" ), 25u );
+    EXPECT_EQ( client->documents_count( "edge" ), 24u );
+    EXPECT_EQ( client->get_collections_names( AbstractDBDriver::clEdge ), std::set<std::string>( { "edge" } ) );
+    auto result = run_traversal( db, true, { "vertex/v0" }, GraphTraversal::trOut, -1 );
+    EXPECT_EQ( result.vertexes.size(), 25u );
+    EXPECT_EQ( result.vertexes.back(), "vertex/v24" );
+
+    EXPECT_THROW( traversal.restoreGraphFromFile( file_path ), jsonio_exception );
+}
+
+TEST( JsonioGraphTraversal, RestoreSchemaRecords )
+{
+    auto file_path = ( std::filesystem::temp_directory_path() / "jsonio_test_schema_graph.json" ).string();
+    std::ofstream stream( file_path );
+    stream << "[\n";
+    for( int ii=0; ii<10; ii++ )
+        stream << "{ \"_id\": \"points/p" << ii << "\", \"_type\": \"vertex\", \"_label\": \"point\", \"name\": \"p" << ii << "\" },\n";
+    for( int ii=1; ii<10; ii++ )
+        stream << "{ \"_id\": \"links/l" << ii << "\", \"_type\": \"edge\", \"_label\": \"links\", "
+               << "\"_from\": \"points/p" << ii-1 << "\", \"_to\": \"points/p" << ii << "\" },\n";
+    // saved again by the next batch of the collection
+    stream << "{ \"_id\": \"points/p0\", \"_type\": \"vertex\", \"_label\": \"point\", \"name\": \"first\", \"weight\": 4 },\n";
+    stream << "{ \"_id\": \"vertex/u0\", \"_type\": \"vertex\", \"_label\": \"unknown\", \"other\": 5 }\n]";
+    stream.close();
+
+    ioSettings().addSchemaFormat( schema_thrift, graph_schema_str );
+    DataBase::update_from_schema( ioSettings().Schema().allStructs() );
+    auto client = std::make_shared<MemoryDBClient>();
+    DataBase db( client );
+    auto batch_size = GraphTraversal::batch_size;
+    GraphTraversal::batch_size = 2;
+    GraphTraversal traversal( db );
+    traversal.restoreGraphFromFile( file_path );
+    GraphTraversal::batch_size = batch_size;
+    DataBase::update_from_schema( {} );
+    std::filesystem::remove( file_path );
+
+    EXPECT_EQ( client->documents_count( "points" ), 10u );
+    EXPECT_EQ( client->documents_count( "links" ), 9u );
+    EXPECT_EQ( client->documents_count( "vertex" ), 1u );
+
+    // records of schemas get default values
+    auto points = db.collection( "points", "vertex" );
+    auto readed = JsonFree::object();
+    ASSERT_TRUE( points->readDocument( readed, "points/p0" ) );
+    EXPECT_EQ( readed["name"].toString(), "first" );
+    EXPECT_EQ( readed["weight"].toDouble(), 4. );
+    ASSERT_TRUE( points->readDocument( readed, "points/p5" ) );
+    EXPECT_EQ( readed["weight"].toDouble(), 1.5 );
+    ASSERT_TRUE( db.collection( "links", "edge" )->readDocument( readed, "links/l3" ) );
+    EXPECT_EQ( readed["length"].toInt(), 3 );
+    EXPECT_EQ( readed["_from"].toString(), "points/p2" );
+    // records without schema are saved as read
+    ASSERT_TRUE( db.collection( "vertex", "vertex" )->readDocument( readed, "vertex/u0" ) );
+    EXPECT_EQ( readed["other"].toInt(), 5 );
+    EXPECT_FALSE( readed.path_if_exists( "weight" ) );
+}
+
+TEST( JsonioGraphTraversal, ExportToFile )
+{
+    DataBase db( traversal_graph() );
+    GraphTraversal traversal( db );
+    auto file_path = ( std::filesystem::temp_directory_path() / "jsonio_test_export.json" ).string();
+
+    EXPECT_EQ( traversal.exportGraph( file_path, true, { "vertex/v1" }, GraphTraversal::exJsonArray,
+                                      GraphTraversal::trOut ), 7u );
+    std::ifstream input( file_path );
+    JsonArrayReader reader( input );
+    std::set<std::string> ids;
+    std::string element;
+    while( reader.next( element ) )
+    {
+        EXPECT_EQ( element.find( ' ' ), std::string::npos );
+        ids.insert( extract_string_json( "_id", element ) );
+    }
+    input.close();
+    EXPECT_EQ( ids, std::set<std::string>( { "vertex/v1", "vertex/v2", "vertex/v3", "vertex/v4",
+                                             "edge/e12", "edge/e14", "edge/e23" } ) );
+
+    EXPECT_EQ( traversal.exportGraph( file_path, true, { "vertex/v1" }, GraphTraversal::exJsonLines,
+                                      GraphTraversal::trAll ), 11u );
+    input.open( file_path );
+    std::size_t lines_count = 0;
+    while( std::getline( input, element ) )
+    {
+        EXPECT_TRUE( json::loads( element ).isObject() );
+        lines_count++;
+    }
+    EXPECT_EQ( lines_count, 11u );
+    std::filesystem::remove( file_path );
+}